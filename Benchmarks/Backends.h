@@ -0,0 +1,45 @@
+#pragma once
+
+// Smart pointers for the backends
+#include <memory>
+
+// Shapes & colors, in the same form for every backend
+#include "../Source/Canvas.h"
+
+// Something that can draw the scene benchmark's workloads, so the same workload can be timed on each renderer
+// Colors are premultiplied 0xAARRGGBB, the same as the software renderer
+class BenchmarkBackend {
+
+	// Usable by anyone
+	public:
+
+		// Destructor
+		virtual ~BenchmarkBackend() {}
+
+		// Setup, resizing also recreates anything that depends on the size (as resizing a window would)
+		virtual const char *getName() = 0;
+		virtual bool resize( unsigned int, unsigned int ) = 0;
+
+		// A frame is only finished once endFrame() returns, everything before it may just be recorded
+		virtual void beginFrame() = 0;
+		virtual void endFrame() = 0;
+
+		// Drawing
+		virtual void clear( uint32_t ) = 0;
+		virtual void fillRectangle( const Rect &, uint32_t ) = 0;
+		virtual void fillGradientRectangle( const Rect &, Point, Point ) = 0; // The demo scene's yellow to green, between two points
+		virtual void drawRectangle( const Rect &, uint32_t, float ) = 0;
+		virtual void fillEllipse( Point, float, float, uint32_t ) = 0;
+		virtual void drawEllipse( Point, float, float, uint32_t, float ) = 0;
+
+		// Text is the demo scene's "Hello World!" centered in a rectangle, only some backends can draw it
+		virtual bool canDrawText() = 0;
+		virtual void drawText( const Rect &, uint32_t ) = 0;
+
+};
+
+// The software renderer, drawing the frame as a number of bands in parallel
+std::unique_ptr<BenchmarkBackend> backendCreateSoftware( unsigned int );
+
+// Direct2D drawing into a bitmap in memory, NULL where Direct2D is not available
+std::unique_ptr<BenchmarkBackend> backendCreateDirect2D();
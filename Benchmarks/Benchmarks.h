@@ -0,0 +1,69 @@
+#pragma once
+
+// Strings
+#include <string>
+
+// Lists of timings
+#include <vector>
+
+// Sorting
+#include <algorithm>
+
+// The same random numbers in every build, for generating benchmark data
+#include "../Source/Random.h"
+
+// The median of some timings, sorting them so other percentiles can be read from them too
+inline double benchmarkMedian( std::vector<double> &times ) {
+
+	std::sort( times.begin(), times.end() );
+	size_t count = times.size();
+	if ( count == 0 ) return 0.0;
+
+	return count % 2 == 1 ? times[ count / 2 ] : ( times[ count / 2 - 1 ] + times[ count / 2 ] ) * 0.5;
+
+}
+
+// Path engine benchmarks
+bool benchmarkPaths( unsigned int, unsigned int, unsigned int );
+
+// Filling shapes that cross the sides of the target, with the float or fixed-point rasterizer
+bool checkClipping( bool );
+
+// Headless startup timeline
+void benchmarkStartup( unsigned int, unsigned int );
+
+// Handing frames to other processes through shared memory
+void benchmarkSharedFramebuffer( unsigned int, unsigned int, unsigned int, const std::string & );
+
+// Recording frames to disk while drawing
+void benchmarkRecording( unsigned int, unsigned int, unsigned int );
+
+// How the scene benchmark suite is run
+struct SceneBenchmarkOptions {
+	std::string backend = "software"; // software or direct2d
+	unsigned int width = 800;
+	unsigned int height = 600;
+	unsigned int threads = 1; // Bands drawn in parallel by the software backend
+	unsigned int warmup = 5; // Untimed frames before each workload
+	unsigned int trials = 20; // Timed frames of each workload
+	std::string resultsPath; // JSON file to write the results to, empty to not write them
+};
+
+// Compositing cached layers against drawing everything
+void benchmarkCompositor( unsigned int, unsigned int, unsigned int );
+
+// Timing common workloads on each renderer, and comparing the results with an earlier run
+bool benchmarkScenes( const SceneBenchmarkOptions & );
+bool compareSceneBenchmarks( const std::string &, const std::string &, double );
+
+// Primitive storage layouts at growing scene sizes
+void benchmarkPrimitives( unsigned int, size_t );
+
+// Drawing with the fixed-point rasterizer against the float one, and checking its frames are the same in any number of bands
+bool benchmarkFixedPoint( unsigned int, unsigned int, unsigned int );
+
+// Painting the window while resizing & restoring it, with & without caching whole frames
+void benchmarkFrameCache( unsigned int, unsigned int, unsigned int );
+
+// Every version of each software kernel this CPU can run, checked against the plain versions & timed against each other
+bool benchmarkKernels( unsigned int, unsigned int, unsigned int );
@@ -0,0 +1,169 @@
+#include "Benchmarks.h"
+
+// The demo scene drawn in software
+#include "../Source/Scene.h"
+
+// Cached layers
+#include "../Source/Compositor.h"
+
+// Formatted output
+#include <cstdio>
+
+// Differences between pixels
+#include <cstdlib>
+
+// Min & max
+#include <algorithm>
+
+// Timing
+#include <chrono>
+
+// The size of the animated overlay, like a tooltip or a frame rate counter
+const int COMPOSITOR_BENCHMARK_OVERLAY_WIDTH = 160;
+const int COMPOSITOR_BENCHMARK_OVERLAY_HEIGHT = 100;
+
+// How many buffers the frames are composited into in turn, the same as the application's shared framebuffer ring
+const unsigned int COMPOSITOR_BENCHMARK_BUFFER_COUNT = 3;
+
+// Where the overlay is on a frame, bouncing around the window
+static PixelRect getOverlayBounds( unsigned int width, unsigned int height, unsigned int frame ) {
+
+	int rangeX = std::max( ( int ) width - COMPOSITOR_BENCHMARK_OVERLAY_WIDTH, 1 );
+	int rangeY = std::max( ( int ) height - COMPOSITOR_BENCHMARK_OVERLAY_HEIGHT, 1 );
+	int x = ( int ) ( frame * 7 ) % ( rangeX * 2 );
+	int y = ( int ) ( frame * 5 ) % ( rangeY * 2 );
+	if ( x >= rangeX ) x = rangeX * 2 - x;
+	if ( y >= rangeY ) y = rangeY * 2 - y;
+
+	return { x, y, x + COMPOSITOR_BENCHMARK_OVERLAY_WIDTH, y + COMPOSITOR_BENCHMARK_OVERLAY_HEIGHT };
+
+}
+
+// Draws the overlay with its top-left at a position: a translucent panel with a gauge that changes every frame
+static void drawOverlay( Canvas &canvas, float left, float top, unsigned int frame ) {
+
+	Paint panelPaint;
+	panelPaint.color = colorFromBytes( 30, 30, 60, 192 );
+	canvas.fillRectangle( { left + 4.0f, top + 4.0f, left + COMPOSITOR_BENCHMARK_OVERLAY_WIDTH - 4.0f, top + COMPOSITOR_BENCHMARK_OVERLAY_HEIGHT - 4.0f }, panelPaint );
+
+	Paint gaugePaint;
+	gaugePaint.color = colorFromBytes( 255, ( uint8_t ) ( frame * 3 ), 0, 255 );
+	float gaugeWidth = ( float ) ( frame % 120 );
+	canvas.fillRectangle( { left + 16.0f, top + 60.0f, left + 16.0f + gaugeWidth, top + 76.0f }, gaugePaint );
+	canvas.drawEllipse( { left + 40.0f, top + 32.0f }, 16.0f, 16.0f, gaugePaint, 2.0f );
+
+}
+
+// The largest difference in any channel between two frames
+static unsigned int getMaximumDifference( const Framebuffer &first, const Framebuffer &second ) {
+
+	unsigned int maximumDifference = 0;
+	for ( unsigned int y = 0; y < first.height; y++ ) {
+		for ( unsigned int x = 0; x < first.width; x++ ) {
+			uint32_t firstPixel = first.pixels[ ( size_t ) y * first.stride + x ];
+			uint32_t secondPixel = second.pixels[ ( size_t ) y * second.stride + x ];
+
+			for ( unsigned int shift = 0; shift < 32; shift += 8 ) {
+				unsigned int difference = ( unsigned int ) std::abs( ( int ) ( ( firstPixel >> shift ) & 0xFF ) - ( int ) ( ( secondPixel >> shift ) & 0xFF ) );
+				maximumDifference = std::max( maximumDifference, difference );
+			}
+		}
+	}
+
+	return maximumDifference;
+
+}
+
+// Compares drawing the whole scene & an animated overlay every frame against compositing cached layers, where only the overlay is drawn again
+// Frames go into a ring of buffers like the shared framebuffer, so each buffer is a few frames behind when it is composited into
+void benchmarkCompositor( unsigned int width, unsigned int height, unsigned int iterations ) {
+
+	unsigned int frameCount = iterations * 10;
+	unsigned long long overlayArea = ( unsigned long long ) COMPOSITOR_BENCHMARK_OVERLAY_WIDTH * COMPOSITOR_BENCHMARK_OVERLAY_HEIGHT;
+
+	std::printf( "Compositing at %u x %u with a %d x %d overlay changing every frame, %u frames into %u buffers in turn\n",
+		width, height, COMPOSITOR_BENCHMARK_OVERLAY_WIDTH, COMPOSITOR_BENCHMARK_OVERLAY_HEIGHT, frameCount, COMPOSITOR_BENCHMARK_BUFFER_COUNT );
+
+	SceneResources resources;
+	scenePrepare( resources );
+
+	Framebuffer buffers[ COMPOSITOR_BENCHMARK_BUFFER_COUNT ];
+	for ( Framebuffer &buffer : buffers ) framebufferAllocate( buffer, width, height );
+
+	// Drawing everything, every frame
+	Canvas canvas( buffers[ 0 ] );
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	for ( unsigned int frame = 0; frame < frameCount; frame++ ) {
+		canvas.setTarget( buffers[ frame % COMPOSITOR_BENCHMARK_BUFFER_COUNT ] );
+		sceneDraw( canvas, resources );
+
+		PixelRect overlayBounds = getOverlayBounds( width, height, frame );
+		drawOverlay( canvas, ( float ) overlayBounds.left, ( float ) overlayBounds.top, frame );
+	}
+
+	double redrawTime = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count() / frameCount;
+
+	// Keep a copy of the last frame to compare with, pointing at the copy's own pixels
+	Framebuffer redrawnFrame = buffers[ ( frameCount - 1 ) % COMPOSITOR_BENCHMARK_BUFFER_COUNT ];
+	redrawnFrame.pixels = redrawnFrame.storage.data();
+
+	std::printf( "  %-28s %8.3f ms per frame, %llu pixels drawn per frame\n", "redraw everything", redrawTime, ( unsigned long long ) width * height + overlayArea );
+
+	// Compositing cached layers, the overlay's content changes every frame so it is drawn again, the scene never is
+	for ( Framebuffer &buffer : buffers ) framebufferAllocate( buffer, width, height );
+
+	Compositor compositor;
+	unsigned int currentFrame = 0;
+	unsigned int sceneLayer = compositor.addLayer( "Scene", [ &resources ]( Canvas &layerCanvas ) {
+		sceneDraw( layerCanvas, resources );
+	}, true );
+	unsigned int overlayLayer = compositor.addLayer( "Overlay", [ &currentFrame ]( Canvas &layerCanvas ) {
+		drawOverlay( layerCanvas, 0.0f, 0.0f, currentFrame );
+	}, false );
+
+	compositor.setLayerBounds( sceneLayer, { 0, 0, ( int ) width, ( int ) height } );
+
+	// Only time the steady state, after every buffer has had its first (full) frame
+	CompositorStatistics startStatistics;
+	for ( unsigned int frame = 0; frame < frameCount + COMPOSITOR_BENCHMARK_BUFFER_COUNT; frame++ ) {
+		if ( frame == COMPOSITOR_BENCHMARK_BUFFER_COUNT ) {
+			startStatistics = compositor.getStatistics();
+			startTime = std::chrono::steady_clock::now();
+		}
+
+		currentFrame = frame >= COMPOSITOR_BENCHMARK_BUFFER_COUNT ? frame - COMPOSITOR_BENCHMARK_BUFFER_COUNT : 0;
+		compositor.setLayerBounds( overlayLayer, getOverlayBounds( width, height, currentFrame ) );
+		compositor.invalidateLayer( overlayLayer );
+		compositor.compose( buffers[ frame % COMPOSITOR_BENCHMARK_BUFFER_COUNT ] );
+	}
+
+	double composeTime = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count() / frameCount;
+	CompositorStatistics statistics = compositor.getStatistics();
+	const Framebuffer &composedFrame = buffers[ ( frameCount + COMPOSITOR_BENCHMARK_BUFFER_COUNT - 1 ) % COMPOSITOR_BENCHMARK_BUFFER_COUNT ];
+
+	std::printf( "  %-28s %8.3f ms per frame (%.1fx faster), %llu pixels drawn & %llu composited per frame (%.1fx the overlay), %llu cache hits & %llu misses, %.1f MB cached\n",
+		"composite cached layers",
+		composeTime,
+		redrawTime / composeTime,
+		( statistics.rasterizedPixelCount - startStatistics.rasterizedPixelCount ) / frameCount,
+		( statistics.composedPixelCount - startStatistics.composedPixelCount ) / frameCount,
+		( double ) ( statistics.composedPixelCount - startStatistics.composedPixelCount ) / frameCount / overlayArea,
+		statistics.cacheHitCount - startStatistics.cacheHitCount,
+		statistics.cacheMissCount - startStatistics.cacheMissCount,
+		( double ) statistics.cacheBytes / ( 1024.0 * 1024.0 )
+	);
+
+	// Compositing only the damage must give exactly the same frame as compositing all of it (into a new target, which has no previous frame)
+	Framebuffer fullFrame;
+	framebufferAllocate( fullFrame, width, height );
+	compositor.compose( fullFrame );
+	unsigned int damageDifference = getMaximumDifference( composedFrame, fullFrame );
+
+	// Drawing the overlay into its own layer rounds differently to drawing it straight onto the scene, but only by a little
+	unsigned int redrawDifference = getMaximumDifference( composedFrame, redrawnFrame );
+
+	std::printf( "  Last frame differs from a full composite by %u & from redrawing everything by %u (of 255)%s\n",
+		damageDifference, redrawDifference, damageDifference != 0 ? ", damage tracking is broken!" : "" );
+
+}
@@ -0,0 +1,251 @@
+#include "Backends.h"
+
+#ifdef _WIN32
+
+// Windows API
+#include <Windows.h>
+
+// Direct2D, DirectWrite & the Windows Imaging Component for a bitmap to draw into without a window
+#include <d2d1.h>
+#include <dwrite.h>
+#include <wincodec.h>
+
+// The text the application draws
+const WCHAR BENCHMARK_TEXT[] = L"Hello World!";
+
+// Converts a premultiplied 0xAARRGGBB color to a Direct2D color, which has straight alpha
+static D2D1_COLOR_F toColor( uint32_t color ) {
+
+	float alpha = ( float ) ( color >> 24 ) / 255.0f;
+	if ( alpha <= 0.0f ) return D2D1::ColorF( 0.0f, 0.0f, 0.0f, 0.0f );
+
+	float scale = 1.0f / ( 255.0f * alpha );
+	return D2D1::ColorF( ( float ) ( ( color >> 16 ) & 0xFF ) * scale, ( float ) ( ( color >> 8 ) & 0xFF ) * scale, ( float ) ( color & 0xFF ) * scale, alpha );
+
+}
+
+// Releases a COM object if it exists
+template <typename Interface>
+static void safeRelease( Interface *&object ) {
+
+	if ( object != NULL ) {
+		object->Release();
+		object = NULL;
+	}
+
+}
+
+// Draws with Direct2D into a WIC bitmap, the same way the application draws into its window but without presenting
+// https://docs.microsoft.com/en-us/windows/win32/direct2d/supported-pixel-formats-and-alpha-modes#supported-formats-for-wic-bitmap-render-target
+class Direct2DBackend : public BenchmarkBackend {
+
+	// Only usable by this class
+	private:
+
+		// Device-independent
+		bool isComInitialized = false;
+		IWICImagingFactory *imagingFactory = NULL;
+		ID2D1Factory *d2dFactory = NULL;
+		IDWriteFactory *writeFactory = NULL;
+		IDWriteTextFormat *writeTextFormat = NULL;
+
+		// Recreated on every resize
+		IWICBitmap *bitmap = NULL;
+		ID2D1RenderTarget *renderTarget = NULL;
+		ID2D1SolidColorBrush *solidBrush = NULL;
+		ID2D1LinearGradientBrush *gradientBrush = NULL;
+
+		// Discards everything that depends on the size
+		void releaseTarget();
+
+	// Usable by anyone
+	public:
+
+		// Destructor
+		~Direct2DBackend();
+
+		// Setup
+		bool setup();
+		const char *getName() override;
+		bool resize( unsigned int, unsigned int ) override;
+
+		// Frames
+		void beginFrame() override;
+		void endFrame() override;
+
+		// Drawing
+		void clear( uint32_t ) override;
+		void fillRectangle( const Rect &, uint32_t ) override;
+		void fillGradientRectangle( const Rect &, Point, Point ) override;
+		void drawRectangle( const Rect &, uint32_t, float ) override;
+		void fillEllipse( Point, float, float, uint32_t ) override;
+		void drawEllipse( Point, float, float, uint32_t, float ) override;
+		bool canDrawText() override;
+		void drawText( const Rect &, uint32_t ) override;
+
+};
+
+// Releases everything when this class is destroyed
+Direct2DBackend::~Direct2DBackend() {
+
+	this->releaseTarget();
+	safeRelease( this->writeTextFormat );
+	safeRelease( this->writeFactory );
+	safeRelease( this->d2dFactory );
+	safeRelease( this->imagingFactory );
+
+	if ( this->isComInitialized ) CoUninitialize();
+
+}
+
+// Creates the factories & the text format, fails if any of them are not available
+bool Direct2DBackend::setup() {
+
+	// WIC is a COM library
+	this->isComInitialized = SUCCEEDED( CoInitializeEx( NULL, COINIT_MULTITHREADED ) );
+	if ( !this->isComInitialized ) return false;
+
+	if ( FAILED( CoCreateInstance( CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER, IID_PPV_ARGS( &this->imagingFactory ) ) ) ) return false;
+	if ( FAILED( D2D1CreateFactory( D2D1_FACTORY_TYPE_SINGLE_THREADED, &this->d2dFactory ) ) ) return false;
+	if ( FAILED( DWriteCreateFactory( DWRITE_FACTORY_TYPE_SHARED, __uuidof( IDWriteFactory ), ( IUnknown ** ) &this->writeFactory ) ) ) return false;
+
+	// The same font as the application
+	if ( FAILED( this->writeFactory->CreateTextFormat( L"Arial", NULL, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, 22.0f, L"", &this->writeTextFormat ) ) ) return false;
+	this->writeTextFormat->SetTextAlignment( DWRITE_TEXT_ALIGNMENT_CENTER );
+	this->writeTextFormat->SetParagraphAlignment( DWRITE_PARAGRAPH_ALIGNMENT_CENTER );
+
+	return true;
+
+}
+
+// The name used in results
+const char *Direct2DBackend::getName() {
+	return "direct2d";
+}
+
+// Discards the bitmap, render target & brushes
+void Direct2DBackend::releaseTarget() {
+
+	safeRelease( this->gradientBrush );
+	safeRelease( this->solidBrush );
+	safeRelease( this->renderTarget );
+	safeRelease( this->bitmap );
+
+}
+
+// Recreates the bitmap, render target & brushes at a new size
+bool Direct2DBackend::resize( unsigned int width, unsigned int height ) {
+
+	this->releaseTarget();
+
+	if ( FAILED( this->imagingFactory->CreateBitmap( width, height, GUID_WICPixelFormat32bppPBGRA, WICBitmapCacheOnLoad, &this->bitmap ) ) ) return false;
+	if ( FAILED( this->d2dFactory->CreateWicBitmapRenderTarget( this->bitmap, D2D1::RenderTargetProperties(), &this->renderTarget ) ) ) return false;
+	if ( FAILED( this->renderTarget->CreateSolidColorBrush( D2D1::ColorF( D2D1::ColorF::Black, 1.0f ), &this->solidBrush ) ) ) return false;
+
+	// The same yellow to green as the application's gradient brush
+	D2D1_GRADIENT_STOP gradientStops[ 2 ] = {
+		{ 0.0f, D2D1::ColorF( D2D1::ColorF::Yellow, 1.0f ) },
+		{ 1.0f, D2D1::ColorF( D2D1::ColorF::Green, 1.0f ) }
+	};
+
+	ID2D1GradientStopCollection *gradientStopCollection = NULL;
+	if ( FAILED( this->renderTarget->CreateGradientStopCollection( gradientStops, 2, D2D1_GAMMA_2_2, D2D1_EXTEND_MODE_CLAMP, &gradientStopCollection ) ) ) return false;
+
+	HRESULT gradientBrushResult = this->renderTarget->CreateLinearGradientBrush(
+		D2D1::LinearGradientBrushProperties( D2D1::Point2F( 0.0f, 0.0f ), D2D1::Point2F( ( FLOAT ) width, ( FLOAT ) height ) ),
+		gradientStopCollection,
+		&this->gradientBrush
+	);
+
+	gradientStopCollection->Release();
+	return SUCCEEDED( gradientBrushResult );
+
+}
+
+// Starts the drawing code
+void Direct2DBackend::beginFrame() {
+	this->renderTarget->BeginDraw();
+}
+
+// Ends the drawing code, which is when Direct2D actually draws everything
+void Direct2DBackend::endFrame() {
+	this->renderTarget->EndDraw();
+}
+
+// Drawing with the same calls the application uses
+void Direct2DBackend::clear( uint32_t color ) {
+	this->renderTarget->Clear( toColor( color ) );
+}
+
+void Direct2DBackend::fillRectangle( const Rect &rectangle, uint32_t color ) {
+
+	this->solidBrush->SetColor( toColor( color ) );
+	this->renderTarget->FillRectangle( D2D1::RectF( rectangle.left, rectangle.top, rectangle.right, rectangle.bottom ), this->solidBrush );
+
+}
+
+void Direct2DBackend::fillGradientRectangle( const Rect &rectangle, Point start, Point end ) {
+
+	this->gradientBrush->SetStartPoint( D2D1::Point2F( start.x, start.y ) );
+	this->gradientBrush->SetEndPoint( D2D1::Point2F( end.x, end.y ) );
+	this->renderTarget->FillRectangle( D2D1::RectF( rectangle.left, rectangle.top, rectangle.right, rectangle.bottom ), this->gradientBrush );
+
+}
+
+void Direct2DBackend::drawRectangle( const Rect &rectangle, uint32_t color, float strokeWidth ) {
+
+	this->solidBrush->SetColor( toColor( color ) );
+	this->renderTarget->DrawRectangle( D2D1::RectF( rectangle.left, rectangle.top, rectangle.right, rectangle.bottom ), this->solidBrush, strokeWidth );
+
+}
+
+void Direct2DBackend::fillEllipse( Point center, float radiusX, float radiusY, uint32_t color ) {
+
+	this->solidBrush->SetColor( toColor( color ) );
+	this->renderTarget->FillEllipse( D2D1::Ellipse( D2D1::Point2F( center.x, center.y ), radiusX, radiusY ), this->solidBrush );
+
+}
+
+void Direct2DBackend::drawEllipse( Point center, float radiusX, float radiusY, uint32_t color, float strokeWidth ) {
+
+	this->solidBrush->SetColor( toColor( color ) );
+	this->renderTarget->DrawEllipse( D2D1::Ellipse( D2D1::Point2F( center.x, center.y ), radiusX, radiusY ), this->solidBrush, strokeWidth );
+
+}
+
+// DirectWrite lays out & draws the text
+bool Direct2DBackend::canDrawText() {
+	return true;
+}
+
+void Direct2DBackend::drawText( const Rect &rectangle, uint32_t color ) {
+
+	this->solidBrush->SetColor( toColor( color ) );
+	this->renderTarget->DrawText(
+		BENCHMARK_TEXT,
+		( UINT32 ) wcslen( BENCHMARK_TEXT ),
+		this->writeTextFormat,
+		D2D1::RectF( rectangle.left, rectangle.top, rectangle.right, rectangle.bottom ),
+		this->solidBrush
+	);
+
+}
+
+// Creates the Direct2D backend, NULL if any of the factories could not be created
+std::unique_ptr<BenchmarkBackend> backendCreateDirect2D() {
+
+	std::unique_ptr<Direct2DBackend> backend = std::make_unique<Direct2DBackend>();
+	if ( !backend->setup() ) return NULL;
+
+	return backend;
+
+}
+
+#else
+
+// Direct2D only exists on Windows
+std::unique_ptr<BenchmarkBackend> backendCreateDirect2D() {
+	return NULL;
+}
+
+#endif
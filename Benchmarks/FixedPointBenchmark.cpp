@@ -0,0 +1,151 @@
+#include "Benchmarks.h"
+
+// The demo scene drawn in software
+#include "../Source/Scene.h"
+
+// Drawing in parallel bands
+#include "../Source/Tiles.h"
+
+// Job system, for the bands
+#include "../Source/Thread.h"
+
+// Formatted output
+#include <cstdio>
+
+// Differences between pixels
+#include <cstdlib>
+
+// Min & max
+#include <algorithm>
+
+// Timing
+#include <chrono>
+
+// The number of shapes drawn on top of the scene each frame
+const unsigned int FIXED_POINT_BENCHMARK_SHAPE_COUNT = 400;
+
+// The numbers of bands each frame is split into, every one must give exactly the same pixels in fixed point
+const unsigned int FIXED_POINT_BENCHMARK_BAND_COUNTS[] = { 1, 2, 3, 7 };
+
+// Draws the scene, then rectangles & ellipses on fractional positions, solid & translucent, filled with colors & the gradient, and outlined
+// The shapes come from a simple generator seeded by the frame, so every run & every band draws the same ones
+static void drawShapes( Canvas &canvas, SceneResources &resources, unsigned int frame ) {
+
+	sceneDraw( canvas, resources );
+
+	float width = ( float ) canvas.getWidth();
+	float height = ( float ) canvas.getHeight();
+	uint32_t state = 12345u + frame * 7919u;
+	auto next = [ &state ]() -> float {
+		return randomUnit( state );
+	};
+
+	Paint gradientPaint;
+	gradientPaint.gradient = &resources.fillGradient;
+
+	for ( unsigned int index = 0; index < FIXED_POINT_BENCHMARK_SHAPE_COUNT; index++ ) {
+		float x = next() * width;
+		float y = next() * height;
+		float sizeX = 4.0f + next() * 60.0f;
+		float sizeY = 4.0f + next() * 60.0f;
+
+		Paint paint;
+		paint.color = colorFromBytes( ( uint8_t ) ( next() * 255.0f ), ( uint8_t ) ( next() * 255.0f ), ( uint8_t ) ( next() * 255.0f ), index % 3 == 0 ? 128 : 255 );
+
+		switch ( index % 5 ) {
+			case 0: canvas.fillRectangle( { x, y, x + sizeX, y + sizeY }, paint ); break;
+			case 1: canvas.fillRectangle( { x, y, x + sizeX, y + sizeY }, gradientPaint ); break;
+			case 2: canvas.drawRectangle( { x, y, x + sizeX, y + sizeY }, paint, 1.5f ); break;
+			case 3: canvas.fillEllipse( { x, y }, sizeX * 0.5f, sizeY * 0.5f, index % 2 == 0 ? gradientPaint : paint ); break;
+			case 4: canvas.drawEllipse( { x, y }, sizeX * 0.5f, sizeX * 0.5f, paint, 2.5f ); break;
+		}
+	}
+
+}
+
+// The largest difference in any channel between two frames
+static unsigned int getMaximumDifference( const Framebuffer &first, const Framebuffer &second ) {
+
+	unsigned int maximumDifference = 0;
+	for ( unsigned int y = 0; y < first.height; y++ ) {
+		for ( unsigned int x = 0; x < first.width; x++ ) {
+			uint32_t firstPixel = first.pixels[ ( size_t ) y * first.stride + x ];
+			uint32_t secondPixel = second.pixels[ ( size_t ) y * second.stride + x ];
+
+			for ( unsigned int shift = 0; shift < 32; shift += 8 ) {
+				unsigned int difference = ( unsigned int ) std::abs( ( int ) ( ( firstPixel >> shift ) & 0xFF ) - ( int ) ( ( secondPixel >> shift ) & 0xFF ) );
+				maximumDifference = std::max( maximumDifference, difference );
+			}
+		}
+	}
+
+	return maximumDifference;
+
+}
+
+// Compares the float & fixed-point rasterizers: the time to draw a frame of shapes, and whether splitting it into bands changes any pixels
+// Returns false if fixed point clips shapes wrongly or gives different pixels in bands, as the hashes would only show the same wrong frame every time
+bool benchmarkFixedPoint( unsigned int width, unsigned int height, unsigned int iterations ) {
+
+	std::printf( "Drawing the scene & %u shapes at %u x %u with floats & fixed point, %u frames each\n", FIXED_POINT_BENCHMARK_SHAPE_COUNT, width, height, iterations );
+
+	bool isClippingCorrect = checkClipping( true );
+	if ( isClippingCorrect ) std::printf( "  Shapes crossing the sides of the target cover the right area of every row in fixed point\n" );
+
+	SceneResources resources;
+	scenePrepare( resources );
+
+	Framebuffer floatFrame;
+	Framebuffer fixedFrame;
+	framebufferAllocate( floatFrame, width, height );
+	framebufferAllocate( fixedFrame, width, height );
+
+	// Time both on this thread alone, each drawing the same frames
+	double times[ 2 ] = { 0.0, 0.0 };
+	Framebuffer *frames[ 2 ] = { &floatFrame, &fixedFrame };
+
+	for ( unsigned int mode = 0; mode < 2; mode++ ) {
+		Canvas canvas( *frames[ mode ] );
+		canvas.setFixedPoint( mode == 1 );
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		for ( unsigned int frame = 0; frame < iterations; frame++ ) drawShapes( canvas, resources, frame );
+		times[ mode ] = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count() / iterations;
+	}
+
+	std::printf( "  %-12s %8.3f ms per frame\n", "float", times[ 0 ] );
+	std::printf( "  %-12s %8.3f ms per frame (%.2fx the speed of float), differs from float by up to %u (of 255)\n", "fixed point", times[ 1 ], times[ 0 ] / times[ 1 ], getMaximumDifference( floatFrame, fixedFrame ) );
+
+	// Draw the last frame again in bands, the fixed-point frames must all have the same hash as the one drawn without bands
+	threadCreate();
+
+	uint64_t expectedHashes[ 2 ] = { framebufferHash( floatFrame ), framebufferHash( fixedFrame ) };
+	bool isBandExact[ 2 ] = { true, true };
+	TiledRenderer renderer;
+	Framebuffer bandedFrame;
+
+	for ( unsigned int mode = 0; mode < 2; mode++ ) {
+		std::printf( "  %-12s", mode == 0 ? "float" : "fixed point" );
+
+		for ( unsigned int bandCount : FIXED_POINT_BENCHMARK_BAND_COUNTS ) {
+			framebufferAllocate( bandedFrame, width, height );
+			renderer.render( bandedFrame, bandCount, [ &resources, iterations, mode ]( Canvas &canvas ) {
+				canvas.setFixedPoint( mode == 1 );
+				drawShapes( canvas, resources, iterations - 1 );
+			} );
+
+			uint64_t hash = framebufferHash( bandedFrame );
+			if ( hash != expectedHashes[ mode ] ) isBandExact[ mode ] = false;
+			std::printf( " %u band%s %016llx", bandCount, bandCount == 1 ? " " : "s", ( unsigned long long ) hash );
+		}
+
+		std::printf( "%s\n", isBandExact[ mode ] ? ", identical" : ", different" );
+	}
+
+	threadStop();
+
+	if ( !isBandExact[ 1 ] ) std::printf( "  Fixed-point frames changed with the number of bands, it is not deterministic!\n" );
+
+	return isClippingCorrect && isBandExact[ 1 ];
+
+}
@@ -0,0 +1,152 @@
+#include "Benchmarks.h"
+
+// The demo scene drawn in software
+#include "../Source/Scene.h"
+
+// Cached layers & frames
+#include "../Source/Compositor.h"
+#include "../Source/FrameCache.h"
+
+// Identifying frames
+#include "../Source/Hash.h"
+
+// Formatted output
+#include <cstdio>
+
+// Copying cached frames
+#include <cstring>
+
+// Lists of sizes & hashes
+#include <vector>
+
+// Timing
+#include <chrono>
+
+// The budgets compared, in frames of the benchmark's size (zero stores nothing, so every new frame is drawn)
+const unsigned int FRAME_CACHE_BENCHMARK_BUDGETS[] = { 0, 2, 4, 8 };
+
+// A size the window is painted at
+struct PaintSize {
+	unsigned int width;
+	unsigned int height;
+};
+
+// The sizes of a run of paints: dragging the window narrower & back again, then being minimized & restored a few times (which paints the same size twice)
+static std::vector<PaintSize> getPaintSizes( unsigned int width, unsigned int height, unsigned int iterations ) {
+
+	std::vector<PaintSize> sizes;
+	for ( unsigned int iteration = 0; iteration < iterations; iteration++ ) {
+		for ( unsigned int step = 0; step <= 4; step++ ) sizes.push_back( { width - step * width / 16, height } );
+		for ( unsigned int step = 4; step > 0; step-- ) sizes.push_back( { width - ( step - 1 ) * width / 16, height } );
+		for ( unsigned int restore = 0; restore < 3; restore++ ) {
+			sizes.push_back( { width, height } );
+			sizes.push_back( { width, height } );
+		}
+	}
+
+	return sizes;
+
+}
+
+// Paints every size in turn the same way as the application: recording the scene to identify the frame, then copying it from the cache or compositing it
+// Returns the milliseconds per paint, with the hash of every painted frame so the runs can be compared
+static double paintFrames( const std::vector<PaintSize> &sizes, size_t budget, std::vector<uint64_t> &frameHashes, FrameCacheStatistics &statistics ) {
+
+	SceneResources resources;
+	scenePrepare( resources );
+
+	Compositor compositor;
+	unsigned int sceneLayer = compositor.addLayer( "Scene", [ &resources ]( Canvas &canvas ) {
+		sceneDraw( canvas, resources );
+	}, true );
+
+	DisplayList sceneList;
+	FrameCache frameCache( budget );
+	uint64_t composedFrameKey = 0;
+	Framebuffer frame;
+	uint64_t frameHeldKey = 0; // The frame the framebuffer has in it, like the application's list of buffers but for one
+	frameHashes.clear();
+
+	double time = 0.0;
+	for ( const PaintSize &size : sizes ) {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+		if ( frame.width != size.width || frame.height != size.height ) {
+			framebufferAllocate( frame, size.width, size.height );
+			frameHeldKey = 0;
+		}
+
+		sceneRecord( sceneList, resources, size.width, size.height );
+		uint64_t frameKey = hashValue( hashValue( sceneList.getHash(), size.width ), size.height );
+
+		const Framebuffer *cachedFrame = NULL;
+		if ( frameKey != composedFrameKey ) cachedFrame = frameCache.find( sceneList.getHash(), size.width, size.height );
+
+		if ( cachedFrame != NULL ) {
+			if ( frameHeldKey != frameKey ) {
+				for ( unsigned int row = 0; row < cachedFrame->height; row++ ) {
+					std::memcpy( frame.pixels + ( size_t ) row * frame.stride, cachedFrame->pixels + ( size_t ) row * cachedFrame->stride, cachedFrame->width * sizeof( uint32_t ) );
+				}
+
+				compositor.forgetTargets();
+				frameHeldKey = frameKey;
+			}
+		} else {
+			compositor.setLayerBounds( sceneLayer, { 0, 0, ( int ) size.width, ( int ) size.height } );
+			compositor.compose( frame );
+			frameHeldKey = frameKey;
+
+			if ( frameKey != composedFrameKey ) {
+				frameCache.store( sceneList.getHash(), frame );
+				composedFrameKey = frameKey;
+			}
+		}
+
+		time += std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+
+		// Not timed, only to check the cached frames are the same as the drawn ones
+		frameHashes.push_back( framebufferHash( frame ) );
+	}
+
+	statistics = frameCache.getStatistics();
+	return time / sizes.size();
+
+}
+
+// Paints the window being resized back & forth and restored, with the frame cache at a few budgets, checking every frame is the same as without it
+void benchmarkFrameCache( unsigned int width, unsigned int height, unsigned int iterations ) {
+
+	std::vector<PaintSize> sizes = getPaintSizes( width, height, iterations );
+	size_t frameBytes = ( size_t ) width * height * sizeof( uint32_t );
+
+	std::printf( "Painting the scene %zu times at up to %u x %u, resizing back & forth & restoring, with the frame cache at budgets of whole frames\n", sizes.size(), width, height );
+
+	std::vector<uint64_t> expectedHashes;
+	double uncachedTime = 0.0;
+
+	for ( unsigned int budgetFrames : FRAME_CACHE_BENCHMARK_BUDGETS ) {
+		std::vector<uint64_t> frameHashes;
+		FrameCacheStatistics statistics;
+		double time = paintFrames( sizes, budgetFrames * frameBytes, frameHashes, statistics );
+
+		// The first budget caches nothing, every other must give the same frames
+		if ( expectedHashes.empty() ) {
+			expectedHashes = frameHashes;
+			uncachedTime = time;
+		}
+
+		std::printf( "  %u frames (%6.1f MB) %8.3f ms per paint (%.1fx), %llu of %llu lookups hit (%.1f%%), %llu evicted, %.1f MB at most%s\n",
+			budgetFrames,
+			( double ) ( budgetFrames * frameBytes ) / ( 1024.0 * 1024.0 ),
+			time,
+			uncachedTime / time,
+			statistics.hitCount,
+			statistics.lookupCount,
+			statistics.lookupCount > 0 ? 100.0 * statistics.hitCount / statistics.lookupCount : 0.0,
+			statistics.evictedCount,
+			( double ) statistics.peakBytes / ( 1024.0 * 1024.0 ),
+			frameHashes == expectedHashes ? "" : ", frames differ from drawing them!"
+		);
+	}
+
+}
@@ -0,0 +1,178 @@
+#include "Json.h"
+
+// Converting numbers
+#include <cstdlib>
+#include <cstring>
+
+// Prototype for reading values within arrays & objects
+static bool parseValue( const std::string &, size_t &, JsonValue & );
+
+// Moves past spaces, tabs & new lines
+static void skipWhitespace( const std::string &text, size_t &position ) {
+	while ( position < text.size() && ( text[ position ] == ' ' || text[ position ] == '\t' || text[ position ] == '\n' || text[ position ] == '\r' ) ) position++;
+}
+
+// Moves past a character if it is next
+static bool consume( const std::string &text, size_t &position, char character ) {
+
+	skipWhitespace( text, position );
+	if ( position >= text.size() || text[ position ] != character ) return false;
+
+	position++;
+	return true;
+
+}
+
+// Moves past a keyword (true, false, null) if it is next
+static bool consumeWord( const std::string &text, size_t &position, const char *word ) {
+
+	size_t length = std::strlen( word );
+	if ( text.compare( position, length, word ) != 0 ) return false;
+
+	position += length;
+	return true;
+
+}
+
+// Reads a quoted string, only escapes of single characters are supported as the benchmarks never write anything else
+static bool parseString( const std::string &text, size_t &position, std::string &result ) {
+
+	if ( !consume( text, position, '"' ) ) return false;
+
+	result.clear();
+	while ( position < text.size() ) {
+		char character = text[ position++ ];
+		if ( character == '"' ) return true;
+
+		if ( character == '\\' ) {
+			if ( position >= text.size() ) return false;
+
+			char escaped = text[ position++ ];
+			if ( escaped == 'n' ) character = '\n';
+			else if ( escaped == 't' ) character = '\t';
+			else if ( escaped == 'r' ) character = '\r';
+			else if ( escaped == '"' || escaped == '\\' || escaped == '/' ) character = escaped;
+			else return false;
+		}
+
+		result.push_back( character );
+	}
+
+	return false;
+
+}
+
+// Reads an object, after its opening brace
+static bool parseObject( const std::string &text, size_t &position, JsonValue &value ) {
+
+	value.type = JsonValue::Type::Object;
+	if ( consume( text, position, '}' ) ) return true;
+
+	do {
+		std::string name;
+		JsonValue member;
+		if ( !parseString( text, position, name ) || !consume( text, position, ':' ) || !parseValue( text, position, member ) ) return false;
+		value.members.emplace_back( name, std::move( member ) );
+	} while ( consume( text, position, ',' ) );
+
+	return consume( text, position, '}' );
+
+}
+
+// Reads an array, after its opening bracket
+static bool parseArray( const std::string &text, size_t &position, JsonValue &value ) {
+
+	value.type = JsonValue::Type::Array;
+	if ( consume( text, position, ']' ) ) return true;
+
+	do {
+		JsonValue item;
+		if ( !parseValue( text, position, item ) ) return false;
+		value.items.push_back( std::move( item ) );
+	} while ( consume( text, position, ',' ) );
+
+	return consume( text, position, ']' );
+
+}
+
+// Reads any value
+static bool parseValue( const std::string &text, size_t &position, JsonValue &value ) {
+
+	skipWhitespace( text, position );
+	if ( position >= text.size() ) return false;
+
+	if ( consume( text, position, '{' ) ) return parseObject( text, position, value );
+	if ( consume( text, position, '[' ) ) return parseArray( text, position, value );
+
+	if ( text[ position ] == '"' ) {
+		value.type = JsonValue::Type::String;
+		return parseString( text, position, value.string );
+	}
+
+	if ( consumeWord( text, position, "true" ) ) {
+		value.type = JsonValue::Type::Boolean;
+		value.boolean = true;
+		return true;
+	}
+
+	if ( consumeWord( text, position, "false" ) ) {
+		value.type = JsonValue::Type::Boolean;
+		value.boolean = false;
+		return true;
+	}
+
+	if ( consumeWord( text, position, "null" ) ) {
+		value.type = JsonValue::Type::Null;
+		return true;
+	}
+
+	// Anything else must be a number
+	const char *start = text.c_str() + position;
+	char *end = NULL;
+	value.number = std::strtod( start, &end );
+	if ( end == start ) return false;
+
+	value.type = JsonValue::Type::Number;
+	position += end - start;
+	return true;
+
+}
+
+// Finds a member of an object by name, NULL if it is not there
+const JsonValue *JsonValue::find( const std::string &name ) const {
+
+	for ( const std::pair<std::string, JsonValue> &member : this->members ) {
+		if ( member.first == name ) return &member.second;
+	}
+
+	return NULL;
+
+}
+
+// Gets a number member of an object
+double JsonValue::getNumber( const std::string &name, double fallback ) const {
+
+	const JsonValue *member = this->find( name );
+	return member != NULL && member->type == Type::Number ? member->number : fallback;
+
+}
+
+// Gets a string member of an object
+std::string JsonValue::getString( const std::string &name, const std::string &fallback ) const {
+
+	const JsonValue *member = this->find( name );
+	return member != NULL && member->type == Type::String ? member->string : fallback;
+
+}
+
+// Reads a whole document, nothing but whitespace may follow the value
+bool jsonParse( const std::string &text, JsonValue &result ) {
+
+	size_t position = 0;
+	result = JsonValue();
+	if ( !parseValue( text, position, result ) ) return false;
+
+	skipWhitespace( text, position );
+	return position == text.size();
+
+}
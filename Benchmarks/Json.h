@@ -0,0 +1,30 @@
+#pragma once
+
+// Strings & dynamic arrays
+#include <string>
+#include <vector>
+
+// Pairs of member names & values
+#include <utility>
+
+// A value read from a JSON document, just enough to read back the results the benchmarks write
+struct JsonValue {
+
+	enum class Type { Null, Boolean, Number, String, Array, Object };
+	Type type = Type::Null;
+
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> items; // Of an array
+	std::vector<std::pair<std::string, JsonValue>> members; // Of an object, in the order they were written
+
+	// Looking up members of an object, with a fallback if they are missing or the wrong type
+	const JsonValue *find( const std::string & ) const;
+	double getNumber( const std::string &, double ) const;
+	std::string getString( const std::string &, const std::string & ) const;
+
+};
+
+// Reads a whole document, fails on anything that is not valid JSON
+bool jsonParse( const std::string &, JsonValue & );
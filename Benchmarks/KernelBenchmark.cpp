@@ -0,0 +1,198 @@
+#include "Benchmarks.h"
+
+// Kernel tables & CPU features
+#include "../Source/Kernels.h"
+
+// The demo scene drawn in software
+#include "../Source/Scene.h"
+
+// Fixed-point cell areas
+#include "../Source/FixedRasterizer.h"
+
+// Formatted output
+#include <cstdio>
+
+// Timing
+#include <chrono>
+
+// Running each kernel over a frame
+#include <functional>
+
+// Buffers for the rows
+#include <vector>
+
+// One row of inputs for every kernel, made up once so each version does the same work
+struct KernelBenchmarkInputs {
+	std::vector<uint32_t> pixels; // Premultiplied, a quarter transparent & a quarter opaque
+	std::vector<uint8_t> coverage; // Runs of uncovered, fully covered & partly covered pixels, like the edges of shapes
+	std::vector<float> cells; // Cell areas that accumulate to between 0 & 1
+	std::vector<int32_t> fixedCells; // The same areas in fixed point
+	std::vector<uint32_t> gradientTable;
+};
+
+// Makes a row of inputs from a simple generator, so every run times the same ones
+static void makeInputs( KernelBenchmarkInputs &inputs, unsigned int width ) {
+
+	uint32_t state = 12345u;
+	auto next = [ &state ]() -> uint32_t {
+		return randomNext( state );
+	};
+
+	inputs.pixels.resize( width );
+	inputs.coverage.resize( width );
+	inputs.cells.assign( width, 0.0f );
+	inputs.fixedCells.assign( width, 0 );
+	inputs.gradientTable.resize( GRADIENT_TABLE_SIZE );
+
+	for ( unsigned int index = 0; index < width; index++ ) {
+		uint32_t alpha = index % 4 == 0 ? 0 : ( index % 4 == 1 ? 255 : next() & 0xFF );
+		uint32_t color = next();
+		uint32_t blue = ( ( color & 0xFF ) * alpha ) / 255;
+		uint32_t green = ( ( ( color >> 8 ) & 0xFF ) * alpha ) / 255;
+		uint32_t red = ( ( ( color >> 16 ) & 0xFF ) * alpha ) / 255;
+		inputs.pixels[ index ] = ( alpha << 24 ) | ( red << 16 ) | ( green << 8 ) | blue;
+	}
+
+	for ( unsigned int index = 0; index < width; ) {
+		unsigned int run = 1 + next() % 32;
+		uint32_t kind = next() % 3;
+		for ( ; run > 0 && index < width; run--, index++ ) inputs.coverage[ index ] = kind == 0 ? 0 : ( kind == 1 ? 255 : ( uint8_t ) next() );
+	}
+
+	// An edge every few cells, entering & leaving so the sums stay between 0 & 1
+	for ( unsigned int index = 0; index + 1 < width; index += 8 ) {
+		float area = ( float ) ( next() % 1000 ) / 1000.0f;
+		inputs.cells[ index ] += area;
+		inputs.cells[ index + 1 ] += 1.0f - area;
+		inputs.cells[ index + 4 < width ? index + 4 : index + 1 ] -= 1.0f;
+		inputs.fixedCells[ index ] += ( int32_t ) ( area * FIXED_CELL_AREA );
+		inputs.fixedCells[ index + 1 ] += FIXED_CELL_AREA - ( int32_t ) ( area * FIXED_CELL_AREA );
+		inputs.fixedCells[ index + 4 < width ? index + 4 : index + 1 ] -= FIXED_CELL_AREA;
+	}
+
+	for ( unsigned int index = 0; index < GRADIENT_TABLE_SIZE; index++ ) inputs.gradientTable[ index ] = 0xFF000000 | ( index * 0x010101 );
+
+}
+
+// Times every version of every kernel over frames of rows, checks them all against the plain versions, and times drawing the scene with each instruction set
+// Returns false if any version gives different results, so a broken kernel fails the run
+bool benchmarkKernels( unsigned int width, unsigned int height, unsigned int iterations ) {
+
+	const CpuFeatures &features = kernelsGetFeatures();
+	std::printf( "Kernels at %u x %u, %u frames each, the CPU has SSE2 %s, SSE4.1 %s, AVX2 %s, FMA %s & AVX-512 %s, the best kernels are %s\n",
+		width, height, iterations, features.hasSSE2 ? "yes" : "no", features.hasSSE41 ? "yes" : "no", features.hasAVX2 ? "yes" : "no",
+		features.hasFMA ? "yes" : "no", features.hasAVX512 ? "yes" : "no", kernelsGetLevelName( kernelsGetBestLevel() ) );
+
+	// Every version must match the plain ones before their times mean anything
+	std::vector<std::string> failures = kernelsSelfTest();
+	for ( const std::string &failure : failures ) std::printf( "  %s!\n", failure.c_str() );
+	if ( failures.empty() ) std::printf( "  Every version this CPU can run matches the plain versions\n" );
+
+	KernelBenchmarkInputs inputs;
+	makeInputs( inputs, width );
+
+	std::vector<uint32_t> destination( width );
+	std::vector<uint8_t> bytes( width );
+	std::vector<uint8_t> blue( width / 2 + 1 );
+	std::vector<uint8_t> red( width / 2 + 1 );
+	float gradientStep = ( float ) ( GRADIENT_TABLE_SIZE - 1 ) / ( float ) width;
+
+	// Each kernel run over a whole frame of rows, the chroma one over each pair of rows
+	struct KernelBenchmark {
+		const char *name;
+		std::function<bool( const KernelTable &, const KernelTable & )> isDifferent; // Whether two tables have different versions of the kernel
+		std::function<void( const KernelTable & )> run;
+	};
+
+	const KernelBenchmark benchmarks[] = {
+		{ "fill", []( const KernelTable &first, const KernelTable &second ) { return first.fill != second.fill; }, [ & ]( const KernelTable &table ) { for ( unsigned int y = 0; y < height; y++ ) table.fill( destination.data(), width, inputs.pixels[ y % width ] ); } },
+		{ "blend solid", []( const KernelTable &first, const KernelTable &second ) { return first.blendSolid != second.blendSolid; }, [ & ]( const KernelTable &table ) { for ( unsigned int y = 0; y < height; y++ ) table.blendSolid( destination.data(), inputs.coverage.data(), width, inputs.pixels[ y % width ] ); } },
+		{ "blend", []( const KernelTable &first, const KernelTable &second ) { return first.blend != second.blend; }, [ & ]( const KernelTable &table ) { for ( unsigned int y = 0; y < height; y++ ) table.blend( destination.data(), inputs.pixels.data(), inputs.coverage.data(), width ); } },
+		{ "blend over", []( const KernelTable &first, const KernelTable &second ) { return first.blendOver != second.blendOver; }, [ & ]( const KernelTable &table ) { for ( unsigned int y = 0; y < height; y++ ) table.blendOver( destination.data(), inputs.pixels.data(), width ); } },
+		{ "gradient", []( const KernelTable &first, const KernelTable &second ) { return first.gradient != second.gradient; }, [ & ]( const KernelTable &table ) { for ( unsigned int y = 0; y < height; y++ ) table.gradient( destination.data(), inputs.gradientTable.data(), ( float ) ( y % 7 ), gradientStep, width ); } },
+		{ "coverage", []( const KernelTable &first, const KernelTable &second ) { return first.coverage != second.coverage; }, [ & ]( const KernelTable &table ) { for ( unsigned int y = 0; y < height; y++ ) table.coverage( inputs.cells.data(), bytes.data(), width, y % 2 == 0 ? FillRule::NonZero : FillRule::EvenOdd ); } },
+		{ "fixed coverage", []( const KernelTable &first, const KernelTable &second ) { return first.fixedCoverage != second.fixedCoverage; }, [ & ]( const KernelTable &table ) { for ( unsigned int y = 0; y < height; y++ ) table.fixedCoverage( inputs.fixedCells.data(), bytes.data(), width, y % 2 == 0 ? FillRule::NonZero : FillRule::EvenOdd ); } },
+		{ "convert", []( const KernelTable &first, const KernelTable &second ) { return first.convert != second.convert; }, [ & ]( const KernelTable &table ) { for ( unsigned int y = 0; y < height; y++ ) table.convert( inputs.pixels.data(), bytes.data(), width ); } },
+		{ "downsample", []( const KernelTable &first, const KernelTable &second ) { return first.downsample != second.downsample; }, [ & ]( const KernelTable &table ) { for ( unsigned int y = 0; y + 1 < height; y += 2 ) table.downsample( inputs.pixels.data(), destination.data(), blue.data(), red.data(), width / 2 ); } }
+	};
+
+	// Only the levels the CPU can run, each kernel timed where it has a version of its own rather than one from an earlier level
+	KernelTable tables[ KERNEL_LEVEL_COUNT ];
+	bool isSupported[ KERNEL_LEVEL_COUNT ];
+	for ( unsigned int level = 0; level < KERNEL_LEVEL_COUNT; level++ ) {
+		isSupported[ level ] = kernelsIsSupported( ( KernelLevel ) level );
+		tables[ level ] = kernelsGetTable( ( KernelLevel ) level );
+	}
+
+	std::printf( "  %-16s", "ms per frame" );
+	for ( unsigned int level = 0; level < KERNEL_LEVEL_COUNT; level++ ) {
+		if ( isSupported[ level ] ) std::printf( " %15s", kernelsGetLevelName( ( KernelLevel ) level ) );
+	}
+	std::printf( "\n" );
+
+	for ( size_t kernel = 0; kernel < sizeof( benchmarks ) / sizeof( benchmarks[ 0 ] ); kernel++ ) {
+		std::printf( "  %-16s", benchmarks[ kernel ].name );
+		double scalarTime = 0.0;
+
+		for ( unsigned int level = 0; level < KERNEL_LEVEL_COUNT; level++ ) {
+			if ( !isSupported[ level ] ) continue;
+
+			// A level without its own version would time the same function again
+			if ( level > 0 && !benchmarks[ kernel ].isDifferent( tables[ level ], tables[ level - 1 ] ) ) {
+				std::printf( " %15s", "-" );
+				continue;
+			}
+
+			// One untimed frame first, so the rows are in the cache
+			benchmarks[ kernel ].run( tables[ level ] );
+
+			std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+			for ( unsigned int frame = 0; frame < iterations; frame++ ) benchmarks[ kernel ].run( tables[ level ] );
+			double time = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count() / iterations;
+
+			if ( level == 0 ) {
+				scalarTime = time;
+				std::printf( " %15.3f", time );
+			} else {
+				std::printf( " %7.3f (%4.1fx)", time, scalarTime / time );
+			}
+		}
+
+		std::printf( "\n" );
+	}
+
+	// The whole scene with each level's kernels, putting back whatever was chosen afterwards
+	KernelLevel chosenLevel = kernelsGetLevel();
+	SceneResources resources;
+	scenePrepare( resources );
+
+	Framebuffer frame;
+	framebufferAllocate( frame, width, height );
+	Canvas canvas( frame );
+
+	std::printf( "  %-16s", "scene" );
+	double scalarTime = 0.0;
+
+	for ( unsigned int level = 0; level < KERNEL_LEVEL_COUNT; level++ ) {
+		if ( !isSupported[ level ] ) continue;
+		kernelsSelect( ( KernelLevel ) level );
+		sceneDraw( canvas, resources );
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		for ( unsigned int index = 0; index < iterations; index++ ) sceneDraw( canvas, resources );
+		double time = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count() / iterations;
+
+		if ( level == 0 ) {
+			scalarTime = time;
+			std::printf( " %15.3f", time );
+		} else {
+			std::printf( " %7.3f (%4.1fx)", time, scalarTime / time );
+		}
+	}
+
+	std::printf( "\n" );
+	kernelsSelect( chosenLevel );
+
+	return failures.empty();
+
+}
@@ -0,0 +1,105 @@
+// Benchmark functions
+#include "Benchmarks.h"
+
+// Picking the software renderer's kernels for the CPU
+#include "../Source/Kernels.h"
+
+// Formatted output
+#include <cstdio>
+
+// String to number conversion
+#include <cstdlib>
+
+// Strings
+#include <string>
+
+// Runs the benchmarks from a console, options are given as --name value
+int main( int argumentCount, char *arguments[] ) {
+
+	// Defaults are the same size as the demo window
+	unsigned int width = 800;
+	unsigned int height = 600;
+	unsigned int iterations = 20;
+	std::string benchmark = "all";
+	std::string sharedFramebufferName; // Of another process's shared framebuffer to read from
+	SceneBenchmarkOptions sceneOptions;
+	std::string baselinePath; // Earlier scene results to compare against
+	double threshold = 5.0; // Percentage slower before a workload counts as a regression
+	size_t primitiveCount = 10000000; // The most primitives to store
+	std::string kernels; // Instruction set to force the software renderer's kernels to, empty for the best the CPU can run
+
+	for ( int index = 1; index + 1 < argumentCount; index += 2 ) {
+		std::string name = arguments[ index ];
+		unsigned int value = ( unsigned int ) std::strtoul( arguments[ index + 1 ], NULL, 10 );
+
+		if ( name == "--benchmark" ) benchmark = arguments[ index + 1 ];
+		else if ( name == "--name" ) sharedFramebufferName = arguments[ index + 1 ];
+		else if ( name == "--width" ) width = value;
+		else if ( name == "--height" ) height = value;
+		else if ( name == "--iterations" ) iterations = value;
+		else if ( name == "--threads" ) sceneOptions.threads = value;
+		else if ( name == "--warmup" ) sceneOptions.warmup = value;
+		else if ( name == "--backend" ) sceneOptions.backend = arguments[ index + 1 ];
+		else if ( name == "--results" ) sceneOptions.resultsPath = arguments[ index + 1 ];
+		else if ( name == "--baseline" ) baselinePath = arguments[ index + 1 ];
+		else if ( name == "--primitives" ) primitiveCount = std::strtoull( arguments[ index + 1 ], NULL, 10 );
+		else if ( name == "--kernels" ) kernels = arguments[ index + 1 ];
+		else if ( name == "--threshold" ) threshold = std::strtod( arguments[ index + 1 ], NULL );
+		else {
+			std::fprintf( stderr, "Unknown option '%s'\n", name.c_str() );
+			return 1;
+		}
+	}
+
+	// Do not continue with sizes that would draw nothing
+	if ( width == 0 || height == 0 || iterations == 0 || sceneOptions.threads == 0 ) {
+		std::fprintf( stderr, "Width, height, iterations & threads must be greater than zero\n" );
+		return 1;
+	}
+
+	// Draw with the fastest kernels for the CPU, or the ones forced with --kernels (or the GRAPHICS_KERNELS environment variable) so each version can be timed on the same machine
+	std::string kernelsError;
+	if ( !kernelsSetup( kernels, kernelsError ) ) {
+		std::fprintf( stderr, "%s\n", kernelsError.c_str() );
+		return 1;
+	}
+
+	// Comparing runs nothing, it reads two earlier results & fails if anything got slower
+	if ( benchmark == "compare" ) {
+		if ( baselinePath.empty() || sceneOptions.resultsPath.empty() ) {
+			std::fprintf( stderr, "Comparing needs both --baseline & --results\n" );
+			return 1;
+		}
+
+		return compareSceneBenchmarks( baselinePath, sceneOptions.resultsPath, threshold ) ? 0 : 1;
+	}
+
+	// Run the chosen benchmark, or all of them
+	if ( benchmark != "all" && benchmark != "startup" && benchmark != "paths" && benchmark != "shared-framebuffer" && benchmark != "recording" && benchmark != "scenes" && benchmark != "primitives" && benchmark != "compositor" && benchmark != "fixed-point" && benchmark != "frame-cache" && benchmark != "kernels" ) {
+		std::fprintf( stderr, "Unknown benchmark '%s', expected all, startup, paths, shared-framebuffer, recording, scenes, primitives, compositor, fixed-point, frame-cache, kernels or compare\n", benchmark.c_str() );
+		return 1;
+	}
+
+	// Startup goes first, so nothing else has warmed up the caches & allocator for it
+	if ( benchmark == "all" || benchmark == "startup" ) benchmarkStartup( width, height );
+	if ( ( benchmark == "all" || benchmark == "paths" ) && !benchmarkPaths( width, height, iterations ) ) return 1;
+	if ( benchmark == "all" || benchmark == "shared-framebuffer" ) benchmarkSharedFramebuffer( width, height, iterations * 50, sharedFramebufferName );
+	if ( benchmark == "all" || benchmark == "recording" ) benchmarkRecording( width, height, iterations );
+
+	// The scene suite shares the size, & its timed frames are the iterations
+	if ( benchmark == "all" || benchmark == "scenes" ) {
+		sceneOptions.width = width;
+		sceneOptions.height = height;
+		sceneOptions.trials = iterations;
+		if ( !benchmarkScenes( sceneOptions ) ) return 1;
+	}
+
+	if ( benchmark == "all" || benchmark == "primitives" ) benchmarkPrimitives( iterations, primitiveCount );
+	if ( benchmark == "all" || benchmark == "compositor" ) benchmarkCompositor( width, height, iterations );
+	if ( ( benchmark == "all" || benchmark == "fixed-point" ) && !benchmarkFixedPoint( width, height, iterations ) ) return 1;
+	if ( benchmark == "all" || benchmark == "frame-cache" ) benchmarkFrameCache( width, height, iterations );
+	if ( ( benchmark == "all" || benchmark == "kernels" ) && !benchmarkKernels( width, height, iterations ) ) return 1;
+
+	return 0;
+
+}
@@ -0,0 +1,262 @@
+#include "Benchmarks.h"
+
+// The software renderer being measured
+#include "../Source/Canvas.h"
+
+// Formatted output
+#include <cstdio>
+
+// Timing
+#include <chrono>
+
+// Strings
+#include <string>
+
+// Trigonometry
+#include <cmath>
+
+// Min & max
+#include <algorithm>
+
+// The area each clipped shape should cover
+#include <functional>
+
+// A named piece of test data
+struct PathWorkload {
+	std::string name;
+	Path path;
+	bool isStroked;
+	FillRule fillRule;
+};
+
+// Keeps a coordinate of a random walk within 0 & the size by reflecting it off the sides, so the walk turns back rather than jumping across the whole frame
+static float reflectWithin( float value, float size ) {
+
+	if ( value < 0.0f ) value = -value;
+	if ( value > size ) value = 2.0f * size - value;
+	return std::clamp( value, 0.0f, size );
+
+}
+
+// A random step of a walk, roughly normally distributed with a standard deviation (the sum of four uniform numbers, which only needs arithmetic so every build takes the same steps)
+static float randomStep( uint32_t &random, float deviation ) {
+
+	float sum = randomUnit( random ) + randomUnit( random ) + randomUnit( random ) + randomUnit( random );
+	return ( sum - 2.0f ) * 1.7320508f * deviation;
+
+}
+
+// Country borders on a map: large closed contours of smooth cubic curves that wander around & overlap each other
+static PathWorkload createMapWorkload( unsigned int width, unsigned int height, uint32_t &random ) {
+
+	PathWorkload workload = { "map contours (cubic, even-odd)", Path(), false, FillRule::EvenOdd };
+
+	for ( unsigned int contour = 0; contour < 200; contour++ ) {
+		float x = randomUnit( random ) * width;
+		float y = randomUnit( random ) * height;
+		workload.path.moveTo( x, y );
+
+		for ( unsigned int segment = 0; segment < 500; segment++ ) {
+			float control1X = reflectWithin( x + randomStep( random, 6.0f ), ( float ) width ), control1Y = reflectWithin( y + randomStep( random, 6.0f ), ( float ) height );
+			float control2X = reflectWithin( control1X + randomStep( random, 6.0f ), ( float ) width ), control2Y = reflectWithin( control1Y + randomStep( random, 6.0f ), ( float ) height );
+			x = reflectWithin( control2X + randomStep( random, 6.0f ), ( float ) width );
+			y = reflectWithin( control2Y + randomStep( random, 6.0f ), ( float ) height );
+			workload.path.cubicTo( control1X, control1Y, control2X, control2Y, x, y );
+		}
+
+		workload.path.close();
+	}
+
+	return workload;
+
+}
+
+// A page of text: thousands of small closed quadratic outlines, like TrueType glyphs, each with a counter (hole)
+static PathWorkload createGlyphWorkload( unsigned int width, unsigned int height, uint32_t &random ) {
+
+	PathWorkload workload = { "glyph outlines (quadratic, non-zero)", Path(), false, FillRule::NonZero };
+
+	const float GLYPH_SIZE = 14.0f;
+	unsigned int columns = ( unsigned int ) ( width / GLYPH_SIZE );
+
+	for ( unsigned int glyph = 0; glyph < 5000; glyph++ ) {
+		float centerX = ( glyph % columns ) * GLYPH_SIZE + GLYPH_SIZE * 0.5f;
+		float centerY = std::fmod( ( glyph / columns ) * GLYPH_SIZE * 1.4f, ( float ) height - GLYPH_SIZE ) + GLYPH_SIZE * 0.5f;
+
+		// Outer contour one way, inner contour the other way, 10 curves each
+		for ( int ring = 0; ring < 2; ring++ ) {
+			float radius = GLYPH_SIZE * ( ring == 0 ? 0.45f : 0.2f );
+			float direction = ring == 0 ? 1.0f : -1.0f;
+
+			workload.path.moveTo( centerX + radius, centerY );
+			for ( int segment = 1; segment <= 10; segment++ ) {
+				float angle = direction * 6.2831853f * segment / 10.0f;
+				float middleAngle = angle - direction * 6.2831853f / 20.0f;
+				float controlRadius = radius * ( 1.1f + ( randomUnit( random ) - 0.5f ) * 0.3f );
+				workload.path.quadraticTo( centerX + controlRadius * std::cos( middleAngle ), centerY + controlRadius * std::sin( middleAngle ), centerX + radius * std::cos( angle ), centerY + radius * std::sin( angle ) );
+			}
+			workload.path.close();
+		}
+	}
+
+	return workload;
+
+}
+
+// Line charts & hand-drawn scribbles: open polylines stroked with round joins & caps
+static PathWorkload createStrokeWorkload( unsigned int width, unsigned int height, uint32_t &random ) {
+
+	PathWorkload workload = { "stroked polylines (round joins)", Path(), true, FillRule::NonZero };
+
+	for ( unsigned int line = 0; line < 1000; line++ ) {
+		float x = randomUnit( random ) * width;
+		float y = randomUnit( random ) * height;
+		workload.path.moveTo( x, y );
+
+		for ( unsigned int segment = 0; segment < 100; segment++ ) {
+			x += randomStep( random, 8.0f );
+			y += randomStep( random, 8.0f );
+			workload.path.lineTo( x, y );
+		}
+	}
+
+	return workload;
+
+}
+
+// A shape crossing the sides of the target, and the area it should cover on a row within the target, given the top of the row
+struct ClippingShape {
+	const char *name;
+	std::function<void( Canvas &, const Paint & )> fill;
+	std::function<double( double )> getRowArea;
+};
+
+// The size of the target the clipped shapes are filled into
+const unsigned int CLIPPING_CHECK_WIDTH = 100;
+const unsigned int CLIPPING_CHECK_HEIGHT = 40;
+
+// The part of a rectangle within a row of the target
+static double getRectangleRowArea( double left, double top, double right, double bottom, double rowTop ) {
+
+	double width = std::max( 0.0, std::min( right, ( double ) CLIPPING_CHECK_WIDTH ) - std::max( left, 0.0 ) );
+	double height = std::max( 0.0, std::min( bottom, rowTop + 1.0 ) - std::max( top, rowTop ) );
+	return width * height;
+
+}
+
+// The part of a circle within a row of the target, adding up thin slices of the row
+static double getCircleRowArea( double centerX, double centerY, double radius, double rowTop ) {
+
+	const unsigned int SLICES = 256;
+	double area = 0.0;
+
+	for ( unsigned int slice = 0; slice < SLICES; slice++ ) {
+		double y = rowTop + ( slice + 0.5 ) / SLICES - centerY;
+		if ( std::fabs( y ) >= radius ) continue;
+
+		double halfChord = std::sqrt( radius * radius - y * y );
+		area += std::max( 0.0, std::min( centerX + halfChord, ( double ) CLIPPING_CHECK_WIDTH ) - std::max( centerX - halfChord, 0.0 ) ) / SLICES;
+	}
+
+	return area;
+
+}
+
+// Fills shapes crossing the sides of a small target, and checks every row is covered by as much as the part of the shape within it
+// Lines outside the target are clipped, so this catches a side losing the winding the pixels inside it need
+bool checkClipping( bool isFixedPoint ) {
+
+	const ClippingShape shapes[] = {
+		{ "rectangle crossing the right side", []( Canvas &canvas, const Paint &paint ) { canvas.fillRectangle( { 50.5f, 5.0f, 150.5f, 35.0f }, paint ); }, []( double rowTop ) { return getRectangleRowArea( 50.5, 5.0, 150.5, 35.0, rowTop ); } },
+		{ "rectangle crossing both sides", []( Canvas &canvas, const Paint &paint ) { canvas.fillRectangle( { -10.5f, 5.0f, 150.5f, 35.0f }, paint ); }, []( double rowTop ) { return getRectangleRowArea( -10.5, 5.0, 150.5, 35.0, rowTop ); } },
+		{ "rectangle crossing the left side", []( Canvas &canvas, const Paint &paint ) { canvas.fillRectangle( { -30.0f, 0.5f, 20.5f, 39.5f }, paint ); }, []( double rowTop ) { return getRectangleRowArea( -30.0, 0.5, 20.5, 39.5, rowTop ); } },
+		{ "ellipse crossing the right side", []( Canvas &canvas, const Paint &paint ) { canvas.fillEllipse( { 95.0f, 20.0f }, 15.0f, 15.0f, paint ); }, []( double rowTop ) { return getCircleRowArea( 95.0, 20.0, 15.0, rowTop ); } },
+		{ "ellipse larger than the target", []( Canvas &canvas, const Paint &paint ) { canvas.fillEllipse( { 50.0f, 20.0f }, 200.0f, 200.0f, paint ); }, []( double rowTop ) { return getCircleRowArea( 50.0, 20.0, 200.0, rowTop ); } }
+	};
+
+	Framebuffer framebuffer;
+	framebufferAllocate( framebuffer, CLIPPING_CHECK_WIDTH, CLIPPING_CHECK_HEIGHT );
+	Canvas canvas( framebuffer );
+	canvas.setFixedPoint( isFixedPoint );
+
+	// Opaque, so the alpha of each pixel is its coverage
+	Paint paint;
+	bool isCorrect = true;
+
+	for ( const ClippingShape &shape : shapes ) {
+		canvas.clear( 0x00000000 );
+		shape.fill( canvas, paint );
+
+		// Rounding each pixel's coverage to 8 bits & flattening the ellipses both stay well within a pixel per row
+		for ( unsigned int y = 0; y < CLIPPING_CHECK_HEIGHT; y++ ) {
+			double area = 0.0;
+			for ( unsigned int x = 0; x < CLIPPING_CHECK_WIDTH; x++ ) area += ( framebuffer.pixels[ ( size_t ) y * framebuffer.stride + x ] >> 24 ) / 255.0;
+
+			double expectedArea = shape.getRowArea( ( double ) y );
+			if ( std::fabs( area - expectedArea ) > 1.0 ) {
+				std::printf( "  The %s covers %.2f pixels of row %u with %s, it should cover %.2f!\n", shape.name, area, y, isFixedPoint ? "fixed point" : "floats", expectedArea );
+				isCorrect = false;
+				break;
+			}
+		}
+	}
+
+	return isCorrect;
+
+}
+
+// Times drawing paths with around 100,000 segments each into an offscreen framebuffer, after checking shapes are clipped correctly
+// Returns false if they are not
+bool benchmarkPaths( unsigned int width, unsigned int height, unsigned int iterations ) {
+
+	// The same data with every compiler, so the timings can be compared between builds
+	uint32_t random = 1234;
+
+	std::vector<PathWorkload> workloads;
+	workloads.push_back( createMapWorkload( width, height, random ) );
+	workloads.push_back( createGlyphWorkload( width, height, random ) );
+	workloads.push_back( createStrokeWorkload( width, height, random ) );
+
+	Framebuffer framebuffer;
+	framebufferAllocate( framebuffer, width, height );
+	Canvas canvas( framebuffer );
+
+	Paint paint;
+	paint.color = colorFromBytes( 20, 40, 160, 255 );
+
+	StrokeStyle style;
+	style.width = 2.0f;
+	style.join = LineJoin::Round;
+	style.cap = LineCap::Round;
+
+	std::printf( "Path rendering at %u x %u, %u iterations\n", width, height, iterations );
+
+	bool isClippingCorrect = checkClipping( false );
+	if ( isClippingCorrect ) std::printf( "  Shapes crossing the sides of the target cover the right area of every row\n" );
+
+	for ( PathWorkload &workload : workloads ) {
+		auto draw = [ & ]() {
+			canvas.clear( 0xFFFFFFFF );
+			if ( workload.isStroked ) {
+				canvas.drawPath( workload.path, paint, style );
+			} else {
+				canvas.fillPath( workload.path, paint, workload.fillRule );
+			}
+		};
+
+		// Warm up the caches & the canvas' reusable buffers
+		draw();
+
+		auto startTime = std::chrono::steady_clock::now();
+		for ( unsigned int iteration = 0; iteration < iterations; iteration++ ) draw();
+		auto endTime = std::chrono::steady_clock::now();
+
+		double milliseconds = std::chrono::duration<double, std::milli>( endTime - startTime ).count() / iterations;
+		double segments = ( double ) workload.path.getSegmentCount();
+
+		std::printf( "  %-40s %8.0f segments  %8.3f ms/frame  %8.2f M segments/s\n", workload.name.c_str(), segments, milliseconds, segments / milliseconds / 1000.0 );
+	}
+
+	return isClippingCorrect;
+
+}
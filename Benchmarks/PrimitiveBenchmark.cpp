@@ -0,0 +1,328 @@
+#include "Benchmarks.h"
+
+// Structure of arrays primitive storage
+#include "../Source/Primitives.h"
+
+// Formatted output
+#include <cstdio>
+
+// Sorting, min & max
+#include <algorithm>
+
+// Square roots
+#include <cmath>
+
+// Timing
+#include <chrono>
+
+// Lists of timings
+#include <vector>
+
+// The number of paints the primitives choose between
+const unsigned int PRIMITIVE_BENCHMARK_PALETTE_SIZE = 16;
+
+// The size of the view that is culled & binned, the primitives are spread so about the same number are in it at every count
+const float PRIMITIVE_BENCHMARK_VIEW_WIDTH = 1920.0f;
+const float PRIMITIVE_BENCHMARK_VIEW_HEIGHT = 1080.0f;
+const unsigned int PRIMITIVE_BENCHMARK_TILE_SIZE = 64;
+
+// The way primitives would be stored as objects: an array of structures, each with a pointer to its paint
+struct ObjectPrimitive {
+	Rect bounds;
+	PrimitiveType type;
+	const Paint *brush;
+	float strokeWidth;
+	int32_t zOrder;
+};
+
+// The same random primitives in both layouts
+struct PrimitiveBenchmarkScene {
+	std::vector<Paint> palette;
+	std::vector<ObjectPrimitive> objects;
+	PrimitiveStore store;
+	Rect view;
+};
+
+// Creates a number of random primitives in one of the layouts (the other is left empty so both never need memory at once)
+static void createPrimitives( PrimitiveBenchmarkScene &scene, size_t count, bool isStructureOfArrays ) {
+
+	// Both layouts get exactly the same primitives
+	uint32_t seed = 54321;
+	auto random = [ &seed ]() -> uint32_t {
+		return randomNext( seed );
+	};
+
+	scene.palette.resize( PRIMITIVE_BENCHMARK_PALETTE_SIZE );
+	for ( unsigned int brush = 0; brush < PRIMITIVE_BENCHMARK_PALETTE_SIZE; brush++ ) {
+		scene.palette[ brush ].color = colorFromBytes( ( uint8_t ) ( brush * 16 ), ( uint8_t ) ( 255 - brush * 16 ), 128, ( uint8_t ) ( 128 + brush * 8 ) );
+	}
+
+	// Spread the primitives over an area that grows with the count, with the view in the middle
+	float scale = std::sqrt( ( float ) count / 10000.0f );
+	unsigned int worldWidth = ( unsigned int ) ( PRIMITIVE_BENCHMARK_VIEW_WIDTH * scale );
+	unsigned int worldHeight = ( unsigned int ) ( PRIMITIVE_BENCHMARK_VIEW_HEIGHT * scale );
+	float viewLeft = ( float ) ( worldWidth / 2 ) - PRIMITIVE_BENCHMARK_VIEW_WIDTH * 0.5f;
+	float viewTop = ( float ) ( worldHeight / 2 ) - PRIMITIVE_BENCHMARK_VIEW_HEIGHT * 0.5f;
+	scene.view = { viewLeft, viewTop, viewLeft + PRIMITIVE_BENCHMARK_VIEW_WIDTH, viewTop + PRIMITIVE_BENCHMARK_VIEW_HEIGHT };
+
+	scene.objects.clear();
+	scene.objects.shrink_to_fit();
+	scene.store = PrimitiveStore();
+
+	if ( isStructureOfArrays ) scene.store.reserve( count );
+	else scene.objects.reserve( count );
+
+	for ( size_t index = 0; index < count; index++ ) {
+		float size = 4.0f + ( float ) ( random() % 61 );
+		float left = ( float ) ( random() % worldWidth );
+		float top = ( float ) ( random() % worldHeight );
+		Rect bounds = { left, top, left + size, top + size };
+
+		PrimitiveType type = ( PrimitiveType ) ( random() % 4 );
+		bool isStroked = type == PrimitiveType::DrawRectangle || type == PrimitiveType::DrawEllipse;
+		uint32_t brush = random() % PRIMITIVE_BENCHMARK_PALETTE_SIZE;
+		float strokeWidth = isStroked ? 1.0f + ( float ) ( random() % 4 ) : 0.0f;
+		int32_t zOrder = ( int32_t ) ( random() % 1000 );
+
+		if ( isStructureOfArrays ) scene.store.add( type, bounds, brush, strokeWidth, zOrder );
+		else scene.objects.push_back( { bounds, type, &scene.palette[ brush ], strokeWidth, zOrder } );
+	}
+
+}
+
+// Runs an operation a number of times, returning the median time in milliseconds
+template <typename Operation>
+static double timeMedian( unsigned int repeats, Operation &&operation ) {
+
+	std::vector<double> times;
+	for ( unsigned int repeat = 0; repeat < repeats; repeat++ ) {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		operation();
+		times.push_back( std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count() );
+	}
+
+	return benchmarkMedian( times );
+
+}
+
+// The results of each operation on one layout, along with what they produced so both layouts can be checked against each other
+struct PrimitiveTimings {
+	double iterate;
+	double cull;
+	double bin;
+	double update;
+	double inkTotal;
+	size_t visibleCount;
+	size_t binnedCount;
+};
+
+// Iterates, culls, bins & moves the primitives stored as objects
+static PrimitiveTimings measureObjects( PrimitiveBenchmarkScene &scene, unsigned int repeats ) {
+
+	PrimitiveTimings timings = {};
+	const Rect view = scene.view;
+
+	// Every field a draw pass reads: the area covered, weighted by the opacity of its paint
+	timings.iterate = timeMedian( repeats, [ & ]() {
+		double total = 0.0;
+		for ( const ObjectPrimitive &primitive : scene.objects ) {
+			float area = ( primitive.bounds.right - primitive.bounds.left + primitive.strokeWidth ) * ( primitive.bounds.bottom - primitive.bounds.top + primitive.strokeWidth );
+			total += area * ( float ) ( primitive.brush->color >> 24 );
+		}
+		timings.inkTotal = total;
+	} );
+
+	std::vector<uint32_t> visible;
+	timings.cull = timeMedian( repeats, [ & ]() {
+		visible.clear();
+		for ( size_t index = 0; index < scene.objects.size(); index++ ) {
+			const ObjectPrimitive &primitive = scene.objects[ index ];
+			float halfStroke = primitive.strokeWidth * 0.5f;
+
+			if ( primitive.bounds.left - halfStroke < view.right && primitive.bounds.right + halfStroke > view.left && primitive.bounds.top - halfStroke < view.bottom && primitive.bounds.bottom + halfStroke > view.top ) {
+				visible.push_back( ( uint32_t ) index );
+			}
+		}
+	} );
+	timings.visibleCount = visible.size();
+
+	// Binning the same way as the store, with the view's top-left as the origin
+	unsigned int columns = ( ( unsigned int ) PRIMITIVE_BENCHMARK_VIEW_WIDTH + PRIMITIVE_BENCHMARK_TILE_SIZE - 1 ) / PRIMITIVE_BENCHMARK_TILE_SIZE;
+	unsigned int rows = ( ( unsigned int ) PRIMITIVE_BENCHMARK_VIEW_HEIGHT + PRIMITIVE_BENCHMARK_TILE_SIZE - 1 ) / PRIMITIVE_BENCHMARK_TILE_SIZE;
+	std::vector<std::vector<uint32_t>> tiles( ( size_t ) columns * rows );
+
+	timings.bin = timeMedian( repeats, [ & ]() {
+		for ( std::vector<uint32_t> &tile : tiles ) tile.clear();
+
+		for ( size_t index = 0; index < scene.objects.size(); index++ ) {
+			const ObjectPrimitive &primitive = scene.objects[ index ];
+			float halfStroke = primitive.strokeWidth * 0.5f;
+			float left = primitive.bounds.left - halfStroke - view.left;
+			float top = primitive.bounds.top - halfStroke - view.top;
+			float right = primitive.bounds.right + halfStroke - view.left;
+			float bottom = primitive.bounds.bottom + halfStroke - view.top;
+
+			if ( right <= 0.0f || bottom <= 0.0f || left >= PRIMITIVE_BENCHMARK_VIEW_WIDTH || top >= PRIMITIVE_BENCHMARK_VIEW_HEIGHT ) continue;
+
+			int firstX = ( int ) ( std::max( left, 0.0f ) / PRIMITIVE_BENCHMARK_TILE_SIZE );
+			int firstY = ( int ) ( std::max( top, 0.0f ) / PRIMITIVE_BENCHMARK_TILE_SIZE );
+			int lastX = std::min( ( int ) std::ceil( std::min( right, PRIMITIVE_BENCHMARK_VIEW_WIDTH ) / PRIMITIVE_BENCHMARK_TILE_SIZE ) - 1, ( int ) columns - 1 );
+			int lastY = std::min( ( int ) std::ceil( std::min( bottom, PRIMITIVE_BENCHMARK_VIEW_HEIGHT ) / PRIMITIVE_BENCHMARK_TILE_SIZE ) - 1, ( int ) rows - 1 );
+
+			for ( int y = firstY; y <= lastY; y++ ) {
+				for ( int x = firstX; x <= lastX; x++ ) tiles[ ( size_t ) y * columns + x ].push_back( ( uint32_t ) index );
+			}
+		}
+	} );
+
+	for ( const std::vector<uint32_t> &tile : tiles ) timings.binnedCount += tile.size();
+
+	// Scrolling: move everything back & forth so the positions do not drift between repeats
+	unsigned int step = 0;
+	timings.update = timeMedian( repeats, [ & ]() {
+		float x = step % 2 == 0 ? 1.0f : -1.0f;
+		float y = step % 2 == 0 ? 0.5f : -0.5f;
+		step++;
+
+		for ( ObjectPrimitive &primitive : scene.objects ) {
+			primitive.bounds.left += x;
+			primitive.bounds.top += y;
+			primitive.bounds.right += x;
+			primitive.bounds.bottom += y;
+		}
+	} );
+
+	return timings;
+
+}
+
+// The same operations on the structure of arrays
+static PrimitiveTimings measureStore( PrimitiveBenchmarkScene &scene, unsigned int repeats ) {
+
+	PrimitiveTimings timings = {};
+	const PrimitiveStore &store = scene.store;
+
+	timings.iterate = timeMedian( repeats, [ & ]() {
+		size_t count = store.getCount();
+		const float *left = store.getLefts();
+		const float *top = store.getTops();
+		const float *right = store.getRights();
+		const float *bottom = store.getBottoms();
+		const float *strokeWidth = store.getStrokeWidths();
+		const uint32_t *brush = store.getBrushes();
+		const Paint *palette = scene.palette.data();
+
+		double total = 0.0;
+		for ( size_t index = 0; index < count; index++ ) {
+			float area = ( right[ index ] - left[ index ] + strokeWidth[ index ] ) * ( bottom[ index ] - top[ index ] + strokeWidth[ index ] );
+			total += area * ( float ) ( palette[ brush[ index ] ].color >> 24 );
+		}
+		timings.inkTotal = total;
+	} );
+
+	std::vector<uint32_t> visible;
+	timings.cull = timeMedian( repeats, [ & ]() {
+		store.cull( scene.view, visible );
+	} );
+	timings.visibleCount = visible.size();
+
+	// The store bins from the origin, so move the view there first (which is not timed)
+	scene.store.translate( -scene.view.left, -scene.view.top );
+
+	PrimitiveBins bins;
+	timings.bin = timeMedian( repeats, [ & ]() {
+		store.bin( PRIMITIVE_BENCHMARK_TILE_SIZE, ( unsigned int ) PRIMITIVE_BENCHMARK_VIEW_WIDTH, ( unsigned int ) PRIMITIVE_BENCHMARK_VIEW_HEIGHT, bins );
+	} );
+	timings.binnedCount = bins.indices.size();
+
+	unsigned int step = 0;
+	timings.update = timeMedian( repeats, [ & ]() {
+		float x = step % 2 == 0 ? 1.0f : -1.0f;
+		float y = step % 2 == 0 ? 0.5f : -0.5f;
+		step++;
+
+		scene.store.translate( x, y );
+	} );
+
+	return timings;
+
+}
+
+// Measures removing & re-adding primitives through their handles, which the object layout has no equivalent of
+// Returns the time for a thousand removals & additions, and checks that the remaining handles still find their primitives
+static double measureChurn( PrimitiveBenchmarkScene &scene, unsigned int repeats, bool &isConsistent ) {
+
+	PrimitiveStore &store = scene.store;
+	std::vector<PrimitiveHandle> handles( store.getCount() );
+	for ( uint32_t index = 0; index < handles.size(); index++ ) handles[ index ] = store.getHandle( index );
+
+	uint32_t seed = 777;
+	double time = timeMedian( repeats, [ & ]() {
+		for ( unsigned int change = 0; change < 1000; change++ ) {
+			PrimitiveHandle &handle = handles[ randomNext( seed ) % handles.size() ];
+			uint32_t index = store.getIndex( handle );
+
+			Rect bounds = store.getBounds( index );
+			PrimitiveType type = store.getTypes()[ index ];
+			uint32_t brush = store.getBrushes()[ index ];
+			float strokeWidth = store.getStrokeWidths()[ index ];
+			int32_t zOrder = store.getZOrders()[ index ];
+
+			store.remove( handle );
+			handle = store.add( type, bounds, brush, strokeWidth, zOrder );
+		}
+	} );
+
+	// Every handle should still be valid, and no two should find the same primitive
+	std::vector<uint8_t> isFound( store.getCount(), 0 );
+	isConsistent = handles.size() == store.getCount();
+	for ( const PrimitiveHandle &handle : handles ) {
+		uint32_t index = store.getIndex( handle );
+		if ( index == UINT32_MAX || isFound[ index ] ) {
+			isConsistent = false;
+			break;
+		}
+
+		isFound[ index ] = 1;
+	}
+
+	return time;
+
+}
+
+// Compares iterating, culling, binning & moving primitives stored as an array of structures against the structure of arrays, from 10 thousand up to a maximum count
+void benchmarkPrimitives( unsigned int iterations, size_t maximumCount ) {
+
+	std::printf( "Primitives as objects (AoS, %u bytes each) against a structure of arrays (SoA), %.0f x %.0f view with %u pixel tiles (median milliseconds)\n",
+		( unsigned int ) sizeof( ObjectPrimitive ), PRIMITIVE_BENCHMARK_VIEW_WIDTH, PRIMITIVE_BENCHMARK_VIEW_HEIGHT, PRIMITIVE_BENCHMARK_TILE_SIZE );
+	std::printf( "  %-10s %-6s %9s %9s %9s %9s %12s\n", "count", "layout", "iterate", "cull", "bin", "update", "churn/1000" );
+
+	PrimitiveBenchmarkScene scene;
+	for ( size_t count = 10000; count <= maximumCount; count *= 10 ) {
+
+		// Fewer repeats as the count grows, so the largest scenes do not take minutes
+		unsigned int repeats = ( unsigned int ) std::max<size_t>( 3, std::min<size_t>( iterations, 100000000 / count ) );
+
+		createPrimitives( scene, count, false );
+		PrimitiveTimings objects = measureObjects( scene, repeats );
+		std::printf( "  %-10zu %-6s %9.3f %9.3f %9.3f %9.3f %12s\n", count, "AoS", objects.iterate, objects.cull, objects.bin, objects.update, "" );
+
+		createPrimitives( scene, count, true );
+		PrimitiveTimings store = measureStore( scene, repeats );
+		bool isConsistent = false;
+		double churn = measureChurn( scene, repeats, isConsistent );
+		std::printf( "  %-10zu %-6s %9.3f %9.3f %9.3f %9.3f %12.3f  (%.2fx iterate, %.2fx cull, %.2fx bin, %.2fx update)\n",
+			count, "SoA", store.iterate, store.cull, store.bin, store.update, churn,
+			objects.iterate / store.iterate, objects.cull / store.cull, objects.bin / store.bin, objects.update / store.update );
+
+		// Both layouts must have found the same primitives, otherwise the timings mean nothing
+		bool isMatching = objects.visibleCount == store.visibleCount && objects.binnedCount == store.binnedCount && std::fabs( objects.inkTotal - store.inkTotal ) <= std::fabs( objects.inkTotal ) * 1e-9;
+		if ( !isMatching || !isConsistent ) {
+			std::printf( "  Mismatch! %zu & %zu visible, %zu & %zu binned, %s handles\n", objects.visibleCount, store.visibleCount, objects.binnedCount, store.binnedCount, isConsistent ? "consistent" : "inconsistent" );
+		}
+
+		// Do not let the last count's memory carry over
+		scene = PrimitiveBenchmarkScene();
+	}
+
+}
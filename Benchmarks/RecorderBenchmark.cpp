@@ -0,0 +1,117 @@
+#include "Benchmarks.h"
+
+// The demo scene drawn in software
+#include "../Source/Scene.h"
+
+// Recording frames to disk
+#include "../Source/Recorder.h"
+
+// Job system
+#include "../Source/Thread.h"
+
+// Formatted output
+#include <cstdio>
+
+// Timing & pacing frames
+#include <chrono>
+#include <thread>
+
+// Somewhere to put the recordings
+#include <filesystem>
+
+// Frames are drawn at this rate, as the window would with vertical sync, so the workers get the same time to keep up as they would in the application
+const unsigned int RECORDER_BENCHMARK_FRAME_RATE = 60;
+
+// Draws a number of frames at a steady rate, optionally recording them, and returns the average time the render thread spent on each one in milliseconds
+static double drawFrames( unsigned int width, unsigned int height, unsigned int frameCount, FrameRecorder *recorder ) {
+
+	SceneResources resources;
+	scenePrepare( resources );
+
+	// Frames are drawn into pixels of their own, or straight into the recorder's queue like the application does
+	Framebuffer ownFramebuffer;
+	framebufferAllocate( ownFramebuffer, width, height );
+	Framebuffer framebuffer;
+	Canvas canvas( ownFramebuffer );
+
+	std::chrono::steady_clock::duration frameInterval = std::chrono::nanoseconds( 1000000000 / RECORDER_BENCHMARK_FRAME_RATE );
+	std::chrono::steady_clock::time_point nextFrameTime = std::chrono::steady_clock::now();
+	double totalTime = 0.0;
+
+	for ( unsigned int frame = 0; frame < frameCount; frame++ ) {
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+		// A full queue drops the frame, which is then drawn into our own pixels instead
+		bool isRecorded = recorder != NULL && recorder->beginFrame( width, height, framebuffer );
+		canvas.setTarget( isRecorded ? framebuffer : ownFramebuffer );
+
+		sceneDraw( canvas, resources );
+		if ( isRecorded ) recorder->endFrame();
+
+		totalTime += std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+
+		nextFrameTime += frameInterval;
+		std::this_thread::sleep_until( nextFrameTime );
+	}
+
+	return totalTime / frameCount;
+
+}
+
+// Measures what recording adds to the time the render thread spends on each frame, and whether the workers keep up without dropping frames
+// Taking a frame from the queue & handing it back is all the render thread does, any other difference is the workers competing with it for cores
+void benchmarkRecording( unsigned int width, unsigned int height, unsigned int iterations ) {
+
+	threadCreate();
+
+	unsigned int frameCount = iterations * 5;
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "GraphicsBenchmarksRecording";
+
+	std::printf( "Recording at %u x %u, %u frames at %u per second with %u worker threads\n", width, height, frameCount, RECORDER_BENCHMARK_FRAME_RATE, threadGetWorkerCount() );
+
+	double baselineTime = drawFrames( width, height, frameCount, NULL );
+	std::printf( "  %-6s %8.3f ms per frame\n", "none", baselineTime );
+
+	const struct {
+		const char *name;
+		RecordingFormat format;
+		const char *path;
+	} formats[] = {
+		{ "qoi", RecordingFormat::QOI, "frames" },
+		{ "y4m", RecordingFormat::Y4M, "video.y4m" }
+	};
+
+	for ( const auto &format : formats ) {
+		FrameRecorder recorder;
+		if ( !recorder.start( ( directory / format.path ).string(), format.format ) ) {
+			std::fprintf( stderr, "Failed to start recording to '%s'\n", ( directory / format.path ).string().c_str() );
+			continue;
+		}
+
+		double frameTime = drawFrames( width, height, frameCount, &recorder );
+		recorder.stop();
+
+		RecorderStatistics statistics = recorder.getStatistics();
+		std::printf( "  %-6s %8.3f ms per frame (%+.1f%%, of which submitting %.3f ms), %llu written, %llu dropped, queue high water %u of %u, %.1f MB, encode %.3f ms & write %.3f ms per frame%s\n",
+			format.name,
+			frameTime,
+			( frameTime - baselineTime ) / baselineTime * 100.0,
+			statistics.submitMilliseconds / frameCount,
+			( unsigned long long ) statistics.writtenCount,
+			( unsigned long long ) statistics.droppedCount,
+			statistics.queueHighWater,
+			statistics.queueCapacity,
+			( double ) statistics.bytesWritten / ( 1024.0 * 1024.0 ),
+			statistics.writtenCount > 0 ? statistics.encodeMilliseconds / statistics.writtenCount : 0.0,
+			statistics.writtenCount > 0 ? statistics.writeMilliseconds / statistics.writtenCount : 0.0,
+			statistics.hasFailed ? ", failed to write" : ""
+		);
+	}
+
+	// Do not leave hundreds of megabytes behind
+	std::error_code error;
+	std::filesystem::remove_all( directory, error );
+
+	threadStop();
+
+}
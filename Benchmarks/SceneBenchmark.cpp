@@ -0,0 +1,443 @@
+#include "Benchmarks.h"
+
+// Renderers to draw the workloads with
+#include "Backends.h"
+
+// Reading back results to compare
+#include "Json.h"
+
+// Job system
+#include "../Source/Thread.h"
+
+// Which kernels the software backend draws with
+#include "../Source/Kernels.h"
+
+// Formatted output
+#include <cstdio>
+
+// Sorting, min & max
+#include <algorithm>
+
+// Square roots
+#include <cmath>
+
+// Timing
+#include <chrono>
+
+// Reading & writing results
+#include <fstream>
+#include <sstream>
+
+// Lists of timings & workloads
+#include <vector>
+
+// The number of shapes in the many-primitives workload
+const unsigned int SCENE_BENCHMARK_PRIMITIVE_COUNT = 10000;
+
+// The number of sizes the resize storm cycles through, each frame is drawn at the next one
+const unsigned int SCENE_BENCHMARK_RESIZE_STEPS = 16;
+
+// The version of the results file, bumped whenever what a workload measures changes
+const unsigned int SCENE_BENCHMARK_RESULTS_VERSION = 1;
+
+// Colors used by the workloads
+const uint32_t SCENE_BENCHMARK_BACKGROUND = 0xFFD3D3D3; // Light gray, the same as the application
+const uint32_t SCENE_BENCHMARK_OUTLINE = 0xFF000000;
+const uint32_t SCENE_BENCHMARK_TEXT = 0xFF0000FF;
+
+// A shape in the many-primitives workload
+struct BenchmarkPrimitive {
+	Rect bounds;
+	uint32_t color;
+	bool isEllipse;
+};
+
+// What the workloads need to draw a frame
+struct SceneBenchmarkState {
+	BenchmarkBackend *backend;
+	unsigned int width;
+	unsigned int height;
+	unsigned int frame;
+	std::vector<BenchmarkPrimitive> primitives;
+};
+
+// A workload draws one frame, returning false if the backend cannot draw it
+struct SceneWorkload {
+	const char *name;
+	const char *description;
+	bool ( *draw )( SceneBenchmarkState & );
+};
+
+// The timings of one workload
+struct WorkloadResult {
+	std::string name;
+	std::string skipReason; // Empty unless the workload could not be run
+	double mean = 0.0;
+	double median = 0.0;
+	double standardDeviation = 0.0;
+	double minimum = 0.0;
+	double maximum = 0.0;
+	double percentile90 = 0.0;
+	double percentile95 = 0.0;
+	double percentile99 = 0.0;
+};
+
+// Draws the application's scene, without text, in the current size
+static void drawDemoScene( SceneBenchmarkState &state, unsigned int width, unsigned int height ) {
+
+	float right = ( float ) width;
+	float bottom = ( float ) height;
+	Rect rectangleArea = { 50.0f, 50.0f, right - 50.0f, bottom - 50.0f };
+
+	state.backend->clear( SCENE_BENCHMARK_BACKGROUND );
+	state.backend->fillGradientRectangle( rectangleArea, { 0.0f, 0.0f }, { right, bottom } );
+	state.backend->drawRectangle( rectangleArea, SCENE_BENCHMARK_OUTLINE, 1.0f );
+	state.backend->drawEllipse( { right / 2.0f, bottom / 2.0f }, 75.0f, 75.0f, SCENE_BENCHMARK_OUTLINE, 3.0f );
+
+}
+
+// Filling every pixel with a single color, which changes every frame
+static bool drawClear( SceneBenchmarkState &state ) {
+
+	state.backend->clear( 0xFF000000 | ( state.frame * 0x00010203 & 0x00FFFFFF ) );
+	return true;
+
+}
+
+// The application's gradient rectangle, covering most of the frame
+static bool drawGradientRectangle( SceneBenchmarkState &state ) {
+
+	float right = ( float ) state.width;
+	float bottom = ( float ) state.height;
+
+	state.backend->clear( SCENE_BENCHMARK_BACKGROUND );
+	state.backend->fillGradientRectangle( { 50.0f, 50.0f, right - 50.0f, bottom - 50.0f }, { 0.0f, 0.0f }, { right, bottom } );
+	return true;
+
+}
+
+// A large, thick anti-aliased ellipse outline
+static bool drawStrokedEllipse( SceneBenchmarkState &state ) {
+
+	float right = ( float ) state.width;
+	float bottom = ( float ) state.height;
+
+	state.backend->clear( SCENE_BENCHMARK_BACKGROUND );
+	state.backend->drawEllipse( { right / 2.0f, bottom / 2.0f }, right * 0.4f, bottom * 0.4f, SCENE_BENCHMARK_OUTLINE, 3.0f );
+	return true;
+
+}
+
+// The application's text
+static bool drawText( SceneBenchmarkState &state ) {
+
+	if ( !state.backend->canDrawText() ) return false;
+
+	state.backend->clear( SCENE_BENCHMARK_BACKGROUND );
+	state.backend->drawText( { 50.0f, 50.0f, ( float ) state.width - 50.0f, ( float ) state.height - 50.0f }, SCENE_BENCHMARK_TEXT );
+	return true;
+
+}
+
+// Thousands of small, translucent rectangles & ellipses, stressing per-shape overhead rather than fill rate
+static bool drawManyPrimitives( SceneBenchmarkState &state ) {
+
+	state.backend->clear( SCENE_BENCHMARK_BACKGROUND );
+
+	for ( const BenchmarkPrimitive &primitive : state.primitives ) {
+		if ( primitive.isEllipse ) {
+			Point center = { ( primitive.bounds.left + primitive.bounds.right ) * 0.5f, ( primitive.bounds.top + primitive.bounds.bottom ) * 0.5f };
+			state.backend->fillEllipse( center, ( primitive.bounds.right - primitive.bounds.left ) * 0.5f, ( primitive.bounds.bottom - primitive.bounds.top ) * 0.5f, primitive.color );
+		} else {
+			state.backend->fillRectangle( primitive.bounds, primitive.color );
+		}
+	}
+
+	return true;
+
+}
+
+// The application's scene, with the target resized before every frame as when dragging the edge of the window
+static bool drawResizeStorm( SceneBenchmarkState &state ) {
+
+	// Cycle between half & the full size
+	unsigned int step = state.frame % SCENE_BENCHMARK_RESIZE_STEPS;
+	unsigned int width = state.width / 2 + state.width / 2 * step / ( SCENE_BENCHMARK_RESIZE_STEPS - 1 );
+	unsigned int height = state.height / 2 + state.height / 2 * step / ( SCENE_BENCHMARK_RESIZE_STEPS - 1 );
+
+	if ( !state.backend->resize( width, height ) ) return false;
+
+	state.backend->beginFrame();
+	drawDemoScene( state, width, height );
+	if ( state.backend->canDrawText() ) state.backend->drawText( { 50.0f, 50.0f, ( float ) width - 50.0f, ( float ) height - 50.0f }, SCENE_BENCHMARK_TEXT );
+	return true;
+
+}
+
+// Everything the application draws
+static bool drawApplicationScene( SceneBenchmarkState &state ) {
+
+	drawDemoScene( state, state.width, state.height );
+	if ( state.backend->canDrawText() ) state.backend->drawText( { 50.0f, 50.0f, ( float ) state.width - 50.0f, ( float ) state.height - 50.0f }, SCENE_BENCHMARK_TEXT );
+	return true;
+
+}
+
+// Every workload, in the order they run
+static const SceneWorkload SCENE_WORKLOADS[] = {
+	{ "clear", "fill every pixel with one color", drawClear },
+	{ "gradient-rectangle", "clear, then a gradient rectangle over most of the frame", drawGradientRectangle },
+	{ "stroked-ellipse", "clear, then a large 3px ellipse outline", drawStrokedEllipse },
+	{ "text", "clear, then the application's text", drawText },
+	{ "many-primitives", "clear, then 10,000 small translucent rectangles & ellipses", drawManyPrimitives },
+	{ "resize-storm", "resize the target, then draw the application's scene", drawResizeStorm },
+	{ "application-scene", "everything the application draws", drawApplicationScene }
+};
+
+// Creates the shapes for the many-primitives workload, the same every run so results can be compared
+static void createPrimitives( std::vector<BenchmarkPrimitive> &primitives, unsigned int width, unsigned int height ) {
+
+	uint32_t seed = 12345;
+	auto random = [ &seed ]() -> uint32_t {
+		return randomNext( seed );
+	};
+
+	primitives.resize( SCENE_BENCHMARK_PRIMITIVE_COUNT );
+	for ( BenchmarkPrimitive &primitive : primitives ) {
+		float size = 4.0f + ( float ) ( random() % 37 );
+		float left = ( float ) ( random() % width ) - size * 0.5f;
+		float top = ( float ) ( random() % height ) - size * 0.5f;
+
+		primitive.bounds = { left, top, left + size, top + size };
+		primitive.color = colorFromBytes( ( uint8_t ) random(), ( uint8_t ) random(), ( uint8_t ) random(), 128 );
+		primitive.isEllipse = ( random() & 1 ) != 0;
+	}
+
+}
+
+// Summarizes the time each frame took, percentiles are the nearest rank
+static void summarize( std::vector<double> &times, WorkloadResult &result ) {
+
+	result.median = benchmarkMedian( times );
+	size_t count = times.size();
+
+	double total = 0.0;
+	for ( double time : times ) total += time;
+	result.mean = total / ( double ) count;
+
+	double squaredDifferences = 0.0;
+	for ( double time : times ) squaredDifferences += ( time - result.mean ) * ( time - result.mean );
+	result.standardDeviation = count > 1 ? std::sqrt( squaredDifferences / ( double ) ( count - 1 ) ) : 0.0;
+
+	result.minimum = times.front();
+	result.maximum = times.back();
+
+	auto percentile = [ &times, count ]( double fraction ) -> double {
+		size_t rank = ( size_t ) std::ceil( fraction * ( double ) count );
+		return times[ std::clamp<size_t>( rank, 1, count ) - 1 ];
+	};
+
+	result.percentile90 = percentile( 0.90 );
+	result.percentile95 = percentile( 0.95 );
+	result.percentile99 = percentile( 0.99 );
+
+}
+
+// Writes the results as JSON, for keeping & comparing with compareSceneBenchmarks()
+static bool writeResults( const std::string &path, const char *backendName, const SceneBenchmarkOptions &options, const std::vector<WorkloadResult> &results ) {
+
+	std::ofstream file( path, std::ios::trunc );
+	if ( !file.is_open() ) return false;
+
+	char line[ 512 ];
+	file << "{\n";
+	std::snprintf( line, sizeof( line ), "\t\"version\": %u,\n\t\"backend\": \"%s\",\n\t\"width\": %u,\n\t\"height\": %u,\n\t\"threads\": %u,\n\t\"kernels\": \"%s\",\n\t\"warmup\": %u,\n\t\"trials\": %u,\n\t\"unit\": \"ms\",\n",
+		SCENE_BENCHMARK_RESULTS_VERSION, backendName, options.width, options.height, options.threads, kernelsGetLevelName( kernelsGetLevel() ), options.warmup, options.trials );
+	file << line << "\t\"workloads\": [\n";
+
+	for ( size_t index = 0; index < results.size(); index++ ) {
+		const WorkloadResult &result = results[ index ];
+		const char *separator = index + 1 < results.size() ? "," : "";
+
+		if ( !result.skipReason.empty() ) {
+			std::snprintf( line, sizeof( line ), "\t\t{ \"name\": \"%s\", \"skipped\": \"%s\" }%s\n", result.name.c_str(), result.skipReason.c_str(), separator );
+		} else {
+			std::snprintf( line, sizeof( line ), "\t\t{ \"name\": \"%s\", \"mean\": %.6f, \"median\": %.6f, \"stddev\": %.6f, \"min\": %.6f, \"max\": %.6f, \"p90\": %.6f, \"p95\": %.6f, \"p99\": %.6f }%s\n",
+				result.name.c_str(), result.mean, result.median, result.standardDeviation, result.minimum, result.maximum, result.percentile90, result.percentile95, result.percentile99, separator );
+		}
+
+		file << line;
+	}
+
+	file << "\t]\n}\n";
+	return ( bool ) file;
+
+}
+
+// Times every workload on a backend: some untimed frames to warm up caches & allocations, then a number of timed frames
+bool benchmarkScenes( const SceneBenchmarkOptions &options ) {
+
+	// Start the workers, this thread draws a band too
+	if ( options.threads > 1 ) threadCreate( options.threads - 1 );
+
+	std::unique_ptr<BenchmarkBackend> backend;
+	if ( options.backend == "software" ) backend = backendCreateSoftware( options.threads );
+	else if ( options.backend == "direct2d" ) backend = backendCreateDirect2D();
+
+	if ( backend == NULL ) {
+		std::fprintf( stderr, "The '%s' backend is not available, expected software or direct2d (Windows only)\n", options.backend.c_str() );
+		if ( options.threads > 1 ) threadStop();
+		return false;
+	}
+
+	SceneBenchmarkState state;
+	state.backend = backend.get();
+	state.width = options.width;
+	state.height = options.height;
+	createPrimitives( state.primitives, options.width, options.height );
+
+	std::printf( "Scenes on the %s backend at %u x %u with %u threads & the %s kernels, %u warmup & %u timed frames each (milliseconds per frame)\n",
+		backend->getName(), options.width, options.height, options.threads, kernelsGetLevelName( kernelsGetLevel() ), options.warmup, options.trials );
+	std::printf( "  %-20s %9s %9s %9s %9s %9s %9s\n", "workload", "mean", "median", "stddev", "p90", "p99", "max" );
+
+	std::vector<WorkloadResult> results;
+	std::vector<double> times;
+
+	for ( const SceneWorkload &workload : SCENE_WORKLOADS ) {
+		WorkloadResult result;
+		result.name = workload.name;
+		times.clear();
+
+		// Every workload starts at the full size, as the resize storm leaves it at another
+		bool isDrawn = backend->resize( options.width, options.height );
+
+		for ( unsigned int frame = 0; isDrawn && frame < options.warmup + options.trials; frame++ ) {
+			state.frame = frame;
+			std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+			// The resize storm has to resize before starting the frame
+			if ( workload.draw != drawResizeStorm ) backend->beginFrame();
+			isDrawn = workload.draw( state );
+			if ( !isDrawn ) break;
+			backend->endFrame();
+
+			if ( frame >= options.warmup ) times.push_back( std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count() );
+		}
+
+		// The frame was started, so finish it even though nothing was drawn
+		if ( !isDrawn ) {
+			if ( workload.draw != drawResizeStorm ) backend->endFrame();
+			result.skipReason = std::string( "not supported by the " ) + backend->getName() + " backend";
+			std::printf( "  %-20s %s\n", workload.name, result.skipReason.c_str() );
+			results.push_back( result );
+			continue;
+		}
+
+		summarize( times, result );
+		std::printf( "  %-20s %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n", workload.name, result.mean, result.median, result.standardDeviation, result.percentile90, result.percentile99, result.maximum );
+		results.push_back( result );
+	}
+
+	backend.reset();
+	if ( options.threads > 1 ) threadStop();
+
+	// Keep the results for comparing against later
+	if ( !options.resultsPath.empty() ) {
+		if ( !writeResults( options.resultsPath, options.backend.c_str(), options, results ) ) {
+			std::fprintf( stderr, "Failed to write the results to '%s'\n", options.resultsPath.c_str() );
+			return false;
+		}
+
+		std::printf( "Results written to '%s'\n", options.resultsPath.c_str() );
+	}
+
+	return true;
+
+}
+
+// Reads a results file written by benchmarkScenes()
+static bool readResults( const std::string &path, JsonValue &results ) {
+
+	std::ifstream file( path );
+	if ( !file.is_open() ) {
+		std::fprintf( stderr, "Failed to open the results '%s'\n", path.c_str() );
+		return false;
+	}
+
+	std::stringstream text;
+	text << file.rdbuf();
+
+	if ( !jsonParse( text.str(), results ) || results.type != JsonValue::Type::Object || results.find( "workloads" ) == NULL ) {
+		std::fprintf( stderr, "The results '%s' are not valid\n", path.c_str() );
+		return false;
+	}
+
+	return true;
+
+}
+
+// Compares two results files workload by workload, returning false if anything got slower
+// A workload has regressed when its median is slower by more than the threshold (a percentage), and by more than the noise (both standard deviations added together)
+bool compareSceneBenchmarks( const std::string &baselinePath, const std::string &resultsPath, double threshold ) {
+
+	JsonValue baseline, current;
+	if ( !readResults( baselinePath, baseline ) || !readResults( resultsPath, current ) ) return false;
+
+	// Differences in how the results were measured make the comparison meaningless, but say so rather than refusing
+	// Each setting's field in the results, and how to describe a difference in it
+	const char *const settings[][ 2 ] = {
+		{ "backend", "a different backend" },
+		{ "width", "a different width" },
+		{ "height", "a different height" },
+		{ "threads", "a different number of threads" },
+		{ "kernels", "different kernels" },
+		{ "version", "a different version of the results format" }
+	};
+
+	for ( const auto &setting : settings ) {
+		const JsonValue *baselineSetting = baseline.find( setting[ 0 ] );
+		const JsonValue *currentSetting = current.find( setting[ 0 ] );
+		bool isSame = baselineSetting != NULL && currentSetting != NULL && baselineSetting->type == currentSetting->type &&
+			baselineSetting->number == currentSetting->number && baselineSetting->string == currentSetting->string;
+
+		if ( !isSame ) std::printf( "Warning: the results were measured with %s\n", setting[ 1 ] );
+	}
+
+	std::printf( "Comparing '%s' against the baseline '%s' (median milliseconds per frame, %.1f%% threshold)\n", resultsPath.c_str(), baselinePath.c_str(), threshold );
+	std::printf( "  %-20s %9s %9s %8s\n", "workload", "baseline", "current", "change" );
+
+	unsigned int regressionCount = 0;
+	for ( const JsonValue &workload : current.find( "workloads" )->items ) {
+		std::string name = workload.getString( "name", "" );
+
+		// Find the same workload in the baseline
+		const JsonValue *baselineWorkload = NULL;
+		for ( const JsonValue &candidate : baseline.find( "workloads" )->items ) {
+			if ( candidate.getString( "name", "" ) == name ) baselineWorkload = &candidate;
+		}
+
+		if ( baselineWorkload == NULL || workload.find( "skipped" ) != NULL || baselineWorkload->find( "skipped" ) != NULL ) {
+			std::printf( "  %-20s %s\n", name.c_str(), baselineWorkload == NULL ? "not in the baseline" : "skipped" );
+			continue;
+		}
+
+		double baselineMedian = baselineWorkload->getNumber( "median", 0.0 );
+		double currentMedian = workload.getNumber( "median", 0.0 );
+		double noise = baselineWorkload->getNumber( "stddev", 0.0 ) + workload.getNumber( "stddev", 0.0 );
+		double change = baselineMedian > 0.0 ? ( currentMedian - baselineMedian ) / baselineMedian * 100.0 : 0.0;
+
+		const char *verdict = "";
+		if ( change > threshold && currentMedian - baselineMedian > noise ) {
+			verdict = "REGRESSION";
+			regressionCount++;
+		} else if ( change < -threshold && baselineMedian - currentMedian > noise ) {
+			verdict = "improvement";
+		}
+
+		std::printf( "  %-20s %9.3f %9.3f %+7.1f%% %s\n", name.c_str(), baselineMedian, currentMedian, change, verdict );
+	}
+
+	std::printf( "%u regressions\n", regressionCount );
+	return regressionCount == 0;
+
+}
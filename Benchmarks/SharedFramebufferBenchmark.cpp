@@ -0,0 +1,192 @@
+#include "Benchmarks.h"
+
+// The demo scene drawn in software
+#include "../Source/Scene.h"
+
+// The ring of framebuffers shared between processes
+#include "../Source/SharedFramebuffer.h"
+
+// Formatted output
+#include <cstdio>
+
+// Sorting latencies
+#include <algorithm>
+
+// Reader & writer threads
+#include <thread>
+#include <atomic>
+
+// Lists of latencies
+#include <vector>
+
+// The name used when the benchmark both writes & reads the frames itself
+const char SHARED_FRAMEBUFFER_BENCHMARK_NAME[] = "GraphicsBenchmarksFramebuffer";
+
+// How long to wait for another frame from another process before giving up, in nanoseconds (the application only draws when its window needs painting)
+const uint64_t SHARED_FRAMEBUFFER_ATTACH_TIMEOUT = 10000000000ull;
+
+// What a reader saw
+struct SharedFramebufferReadResults {
+	unsigned int readCount = 0; // Frames read all the way through without being overwritten
+	unsigned int skippedCount = 0; // Frames published but never seen, as a newer one was already out
+	unsigned int tornCount = 0; // Frames overwritten while being read, and correctly detected as such
+	unsigned int corruptCount = 0; // Frames that passed the validity check but had the wrong contents, should always be zero
+	std::vector<double> latencies; // Milliseconds between publishing & the reader finishing with each frame
+	uint64_t checksum = 0;
+};
+
+// Stamps the frame number into the first & last pixels, so the reader can tell if it got the pixels of the frame it was told about
+static void stampFrame( Framebuffer &framebuffer, uint64_t frameNumber ) {
+
+	framebuffer.pixels[ 0 ] = ( uint32_t ) frameNumber;
+	framebuffer.pixels[ ( size_t ) ( framebuffer.height - 1 ) * framebuffer.stride + framebuffer.width - 1 ] = ( uint32_t ) frameNumber;
+
+}
+
+// Reads frames as they are published until the writer says it has stopped (or enough frames have been seen), touching every pixel of each one
+static void readFrames( const SharedFramebuffer &reader, const std::atomic<bool> &isWriterDone, unsigned int frameCount, bool isStamped, SharedFramebufferReadResults &results ) {
+
+	uint64_t lastFrameNumber = 0;
+	uint64_t lastFrameTime = sharedFramebufferNow();
+
+	while ( results.readCount + results.skippedCount + results.tornCount < frameCount ) {
+
+		// Nothing new yet, stop if nothing more is coming
+		if ( reader.getLatestFrameNumber() == lastFrameNumber ) {
+			if ( isWriterDone.load( std::memory_order_acquire ) && reader.getLatestFrameNumber() == lastFrameNumber ) break;
+			if ( !isStamped && sharedFramebufferNow() - lastFrameTime > SHARED_FRAMEBUFFER_ATTACH_TIMEOUT ) break;
+
+			std::this_thread::yield();
+			continue;
+		}
+
+		// The writer may have started overwriting the latest buffer already, try again
+		SharedFrame frame;
+		if ( !reader.acquireLatest( frame ) || frame.frameNumber <= lastFrameNumber ) continue;
+
+		// When attached to another process, frames published before this reader started are not counted as skipped
+		if ( lastFrameNumber != 0 || isStamped ) results.skippedCount += ( unsigned int ) ( frame.frameNumber - lastFrameNumber - 1 );
+		lastFrameNumber = frame.frameNumber;
+		lastFrameTime = sharedFramebufferNow();
+
+		// Use the pixels in place, as a real consumer (encoder, network sender) would
+		uint64_t checksum = 0;
+		for ( unsigned int y = 0; y < frame.height; y++ ) {
+			const uint32_t *row = frame.pixels + ( size_t ) y * frame.stride;
+			for ( unsigned int x = 0; x < frame.width; x++ ) checksum += row[ x ];
+		}
+
+		uint32_t firstPixel = frame.pixels[ 0 ];
+		uint32_t lastPixel = frame.pixels[ ( size_t ) ( frame.height - 1 ) * frame.stride + frame.width - 1 ];
+
+		// Anything read above is unreliable if the writer reused the buffer meanwhile
+		if ( !reader.isStillValid( frame ) ) {
+			results.tornCount++;
+			continue;
+		}
+
+		if ( isStamped && ( firstPixel != ( uint32_t ) frame.frameNumber || lastPixel != ( uint32_t ) frame.frameNumber ) ) results.corruptCount++;
+
+		results.latencies.push_back( ( double ) ( sharedFramebufferNow() - frame.publishTime ) / 1000000.0 );
+		results.checksum += checksum;
+		results.readCount++;
+
+	}
+
+}
+
+// Displays what a reader saw, with latency percentiles
+static void reportReadResults( SharedFramebufferReadResults &results, double seconds ) {
+
+	std::printf( "  read %u, skipped %u, torn (detected) %u, corrupt %u\n", results.readCount, results.skippedCount, results.tornCount, results.corruptCount );
+
+	if ( results.latencies.empty() ) return;
+
+	double median = benchmarkMedian( results.latencies );
+
+	double total = 0.0;
+	for ( double latency : results.latencies ) total += latency;
+
+	size_t count = results.latencies.size();
+	std::printf( "  latency from publish to read: mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+		total / ( double ) count,
+		median,
+		results.latencies[ std::min( count - 1, count * 99 / 100 ) ],
+		results.latencies[ count - 1 ]
+	);
+
+	std::printf( "  %.1f frames read per second (checksum %llu)\n", ( double ) results.readCount / seconds, ( unsigned long long ) results.checksum );
+
+}
+
+// Measures handing frames to another reader through shared memory, with no copies on either side
+// Without a name a writer & reader thread in this process use separate mappings, the same as two processes would
+// With a name this only reads, from the application started with --shared-framebuffer <name>
+void benchmarkSharedFramebuffer( unsigned int width, unsigned int height, unsigned int iterations, const std::string &name ) {
+
+	SharedFramebufferReadResults results;
+
+	// Attach to another process, which decides the size & how often frames come
+	if ( !name.empty() ) {
+		SharedFramebuffer reader;
+		if ( !reader.open( name ) ) {
+			std::fprintf( stderr, "Failed to open the shared framebuffer '%s', is the application running with --shared-framebuffer %s?\n", name.c_str(), name.c_str() );
+			return;
+		}
+
+		std::printf( "Shared framebuffer '%s', reading %u frames\n", name.c_str(), iterations );
+
+		std::atomic<bool> isWriterDone( false );
+		uint64_t startTime = sharedFramebufferNow();
+		readFrames( reader, isWriterDone, iterations, false, results );
+		reportReadResults( results, ( double ) ( sharedFramebufferNow() - startTime ) / 1000000000.0 );
+		return;
+	}
+
+	// Create the ring, the size is fixed so it can be the exact size of the frames
+	SharedFramebuffer writer;
+	if ( !writer.create( SHARED_FRAMEBUFFER_BENCHMARK_NAME, 3, width, height ) ) {
+		std::fprintf( stderr, "Failed to create the shared framebuffer '%s'\n", SHARED_FRAMEBUFFER_BENCHMARK_NAME );
+		return;
+	}
+
+	SharedFramebuffer reader;
+	if ( !reader.open( SHARED_FRAMEBUFFER_BENCHMARK_NAME ) ) {
+		std::fprintf( stderr, "Failed to open the shared framebuffer '%s'\n", SHARED_FRAMEBUFFER_BENCHMARK_NAME );
+		return;
+	}
+
+	SceneResources resources;
+	scenePrepare( resources );
+
+	std::printf( "Shared framebuffer at %u x %u, writing %u frames\n", width, height, iterations );
+
+	// Start reading before the first frame is published
+	std::atomic<bool> isWriterDone( false );
+	std::thread readerThread( [ &reader, &isWriterDone, iterations, &results ]() {
+		readFrames( reader, isWriterDone, iterations, true, results );
+	} );
+
+	// Draw the scene straight into each buffer as fast as possible
+	uint64_t startTime = sharedFramebufferNow();
+
+	Framebuffer framebuffer;
+	Canvas canvas( framebuffer );
+	for ( unsigned int iteration = 0; iteration < iterations; iteration++ ) {
+		if ( !writer.beginFrame( width, height, framebuffer ) ) break;
+
+		canvas.setTarget( framebuffer );
+		sceneDraw( canvas, resources );
+		stampFrame( framebuffer, writer.getLatestFrameNumber() + 1 );
+
+		writer.endFrame();
+	}
+
+	isWriterDone.store( true, std::memory_order_release );
+	readerThread.join();
+
+	double seconds = ( double ) ( sharedFramebufferNow() - startTime ) / 1000000000.0;
+	std::printf( "  published %llu frames, %.1f per second\n", ( unsigned long long ) writer.getLatestFrameNumber(), ( double ) writer.getLatestFrameNumber() / seconds );
+	reportReadResults( results, seconds );
+
+}
@@ -0,0 +1,164 @@
+#include "Backends.h"
+
+// The demo scene's gradient
+#include "../Source/Scene.h"
+
+// Drawing in parallel bands
+#include "../Source/Tiles.h"
+
+// Lists of commands
+#include <vector>
+
+// A drawing call recorded during a frame, replayed for each band once the frame ends
+struct SoftwareCommand {
+	enum class Type { Clear, FillRectangle, FillGradientRectangle, DrawRectangle, FillEllipse, DrawEllipse } type;
+	Rect rectangle;
+	Point start; // Or the center of an ellipse
+	Point end; // Or the radii of an ellipse
+	uint32_t color;
+	float strokeWidth;
+};
+
+// Records each frame, then draws it with the software renderer in a number of bands in parallel
+class SoftwareBackend : public BenchmarkBackend {
+
+	// Only usable by this class
+	private:
+
+		unsigned int bandCount;
+		Framebuffer framebuffer;
+		TiledRenderer renderer;
+		SceneResources resources;
+		std::vector<SoftwareCommand> commands;
+
+		// Draws every recorded command into one band
+		void replay( Canvas & );
+
+	// Usable by anyone
+	public:
+
+		// Constructor
+		SoftwareBackend( unsigned int );
+
+		// Setup
+		const char *getName() override;
+		bool resize( unsigned int, unsigned int ) override;
+
+		// Frames
+		void beginFrame() override;
+		void endFrame() override;
+
+		// Drawing
+		void clear( uint32_t ) override;
+		void fillRectangle( const Rect &, uint32_t ) override;
+		void fillGradientRectangle( const Rect &, Point, Point ) override;
+		void drawRectangle( const Rect &, uint32_t, float ) override;
+		void fillEllipse( Point, float, float, uint32_t ) override;
+		void drawEllipse( Point, float, float, uint32_t, float ) override;
+		bool canDrawText() override;
+		void drawText( const Rect &, uint32_t ) override;
+
+};
+
+// Builds the gradient, the framebuffer is allocated by resize()
+SoftwareBackend::SoftwareBackend( unsigned int threadCount ) :
+	bandCount( threadCount ) {
+
+	scenePrepare( this->resources );
+
+}
+
+// The name used in results
+const char *SoftwareBackend::getName() {
+	return "software";
+}
+
+// Reallocates the framebuffer
+bool SoftwareBackend::resize( unsigned int width, unsigned int height ) {
+
+	if ( width == 0 || height == 0 ) return false;
+
+	framebufferAllocate( this->framebuffer, width, height );
+	return true;
+
+}
+
+// Starts recording a frame
+void SoftwareBackend::beginFrame() {
+	this->commands.clear();
+}
+
+// Draws the recorded frame, returning once every band is done
+void SoftwareBackend::endFrame() {
+
+	this->renderer.render( this->framebuffer, this->bandCount, [ this ]( Canvas &canvas ) {
+		this->replay( canvas );
+	} );
+
+}
+
+// Draws every recorded command into one band, the paints are rebuilt for each band as the bands run at the same time
+void SoftwareBackend::replay( Canvas &canvas ) {
+
+	for ( const SoftwareCommand &command : this->commands ) {
+		Paint paint;
+		paint.color = command.color;
+
+		switch ( command.type ) {
+			case SoftwareCommand::Type::Clear: canvas.clear( command.color ); break;
+			case SoftwareCommand::Type::FillRectangle: canvas.fillRectangle( command.rectangle, paint ); break;
+			case SoftwareCommand::Type::DrawRectangle: canvas.drawRectangle( command.rectangle, paint, command.strokeWidth ); break;
+			case SoftwareCommand::Type::FillEllipse: canvas.fillEllipse( command.start, command.end.x, command.end.y, paint ); break;
+			case SoftwareCommand::Type::DrawEllipse: canvas.drawEllipse( command.start, command.end.x, command.end.y, paint, command.strokeWidth ); break;
+
+			// Each band needs its own copy of the gradient, as its points are changed for every rectangle
+			case SoftwareCommand::Type::FillGradientRectangle: {
+				LinearGradient gradient = this->resources.fillGradient;
+				gradient.setPoints( command.start, command.end );
+				paint.gradient = &gradient;
+				canvas.fillRectangle( command.rectangle, paint );
+				break;
+			}
+		}
+	}
+
+}
+
+// Recording each command
+void SoftwareBackend::clear( uint32_t color ) {
+	this->commands.push_back( { SoftwareCommand::Type::Clear, {}, {}, {}, color, 0.0f } );
+}
+
+void SoftwareBackend::fillRectangle( const Rect &rectangle, uint32_t color ) {
+	this->commands.push_back( { SoftwareCommand::Type::FillRectangle, rectangle, {}, {}, color, 0.0f } );
+}
+
+void SoftwareBackend::fillGradientRectangle( const Rect &rectangle, Point start, Point end ) {
+	this->commands.push_back( { SoftwareCommand::Type::FillGradientRectangle, rectangle, start, end, 0, 0.0f } );
+}
+
+void SoftwareBackend::drawRectangle( const Rect &rectangle, uint32_t color, float strokeWidth ) {
+	this->commands.push_back( { SoftwareCommand::Type::DrawRectangle, rectangle, {}, {}, color, strokeWidth } );
+}
+
+void SoftwareBackend::fillEllipse( Point center, float radiusX, float radiusY, uint32_t color ) {
+	this->commands.push_back( { SoftwareCommand::Type::FillEllipse, {}, center, { radiusX, radiusY }, color, 0.0f } );
+}
+
+void SoftwareBackend::drawEllipse( Point center, float radiusX, float radiusY, uint32_t color, float strokeWidth ) {
+	this->commands.push_back( { SoftwareCommand::Type::DrawEllipse, {}, center, { radiusX, radiusY }, color, strokeWidth } );
+}
+
+// There is no software text renderer yet
+bool SoftwareBackend::canDrawText() {
+	return false;
+}
+
+void SoftwareBackend::drawText( const Rect &, uint32_t ) {
+
+}
+
+// Creates the software backend, drawing in as many bands as there are threads
+std::unique_ptr<BenchmarkBackend> backendCreateSoftware( unsigned int threadCount ) {
+	return std::make_unique<SoftwareBackend>( threadCount );
+}
@@ -0,0 +1,61 @@
+#include "Benchmarks.h"
+
+// The demo scene drawn in software
+#include "../Source/Scene.h"
+
+// Job system & startup timeline
+#include "../Source/Thread.h"
+#include "../Source/Timeline.h"
+
+// Formatted output
+#include <cstdio>
+
+// The headless equivalent of the application's startup, without a window or graphics device, for tracking time to first frame in CI
+// Device-independent preparation runs on a worker while the main thread does the work that stands in for creating the window
+void benchmarkStartup( unsigned int width, unsigned int height ) {
+
+	timelineStart();
+
+	// Start the worker threads, same as the application does
+	{
+		TimelineSpan timelineSpan( "Start worker threads" );
+		threadCreate();
+	}
+
+	// Build the gradient table on a worker...
+	SceneResources resources;
+	std::future<void> scenePreparation = threadSubmit( [ &resources ]() {
+		TimelineSpan timelineSpan( "Prepare scene resources" );
+		scenePrepare( resources );
+	} );
+
+	// ...while this thread allocates the pixels that stand in for the window
+	Framebuffer framebuffer;
+	{
+		TimelineSpan timelineSpan( "Create framebuffer" );
+		framebufferAllocate( framebuffer, width, height );
+	}
+
+	{
+		TimelineSpan timelineSpan( "Wait for scene preparation" );
+		scenePreparation.get();
+	}
+
+	// Draw the first frame
+	{
+		TimelineSpan timelineSpan( "Draw first frame" );
+		Canvas canvas( framebuffer );
+		sceneDraw( canvas, resources );
+	}
+
+	timelineMark( "First frame presented" );
+
+	unsigned int workerCount = threadGetWorkerCount();
+	threadStop();
+
+	// Display the timeline, then the result on a line of its own so scripts can find it
+	std::printf( "Startup at %u x %u with %u worker threads\n", width, height, workerCount );
+	for ( const std::string &line : timelineReport() ) std::printf( "  %s\n", line.c_str() );
+	std::printf( "time-to-first-frame-ms: %.3f\n", timelineFind( "First frame presented" ) );
+
+}
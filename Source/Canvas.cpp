@@ -0,0 +1,408 @@
+#include "Canvas.h"
+
+// Floor, ceiling, etc.
+#include <cmath>
+
+// Min, max & clamp
+#include <algorithm>
+
+// Hashing gradients
+#include "Hash.h"
+
+// The fastest span operations for the CPU
+#include "Kernels.h"
+
+// The furthest from the origin a gradient's points can be in fixed point (32,768 pixels), so projecting a pixel onto it fits in 64 bits
+const int32_t FIXED_GRADIENT_LIMIT = 1 << 23;
+
+// Precomputes the colors of the gradient from a list of stops sorted by position
+void LinearGradient::setStops( const GradientStop *stops, unsigned int count ) {
+
+	if ( count == 0 ) return;
+
+	for ( unsigned int index = 0; index < GRADIENT_TABLE_SIZE; index++ ) {
+		float position = ( float ) index / ( float ) ( GRADIENT_TABLE_SIZE - 1 );
+
+		// Find the pair of stops either side of this position, before the first & after the last are clamped
+		const GradientStop *before = &stops[ 0 ];
+		const GradientStop *after = &stops[ 0 ];
+		for ( unsigned int stop = 0; stop < count; stop++ ) {
+			after = &stops[ stop ];
+			if ( stops[ stop ].position >= position ) break;
+			before = after;
+		}
+
+		// Blend between the two stops (in straight alpha, then premultiply)
+		float span = after->position - before->position;
+		float weight = span > 0.0f ? std::clamp( ( position - before->position ) / span, 0.0f, 1.0f ) : 0.0f;
+
+		this->table[ index ] = colorFromFloats(
+			before->red + ( after->red - before->red ) * weight,
+			before->green + ( after->green - before->green ) * weight,
+			before->blue + ( after->blue - before->blue ) * weight,
+			before->alpha + ( after->alpha - before->alpha ) * weight
+		);
+	}
+
+}
+
+// Sets where the gradient starts & ends, in pixels
+void LinearGradient::setPoints( Point newStart, Point newEnd ) {
+
+	this->start = newStart;
+	this->end = newEnd;
+
+}
+
+// Writes the colors of a run of pixels on a single row, sampled at the center of each pixel
+void LinearGradient::fillSpan( uint32_t *destination, unsigned int x, unsigned int y, unsigned int count ) const {
+
+	// Project each pixel onto the line between the start & end, the projection only changes by a fixed step across a row
+	float deltaX = this->end.x - this->start.x;
+	float deltaY = this->end.y - this->start.y;
+	float lengthSquared = deltaX * deltaX + deltaY * deltaY;
+
+	if ( lengthSquared <= 0.0f ) {
+		kernelTable.fill( destination, count, this->table[ 0 ] );
+		return;
+	}
+
+	float scale = ( float ) ( GRADIENT_TABLE_SIZE - 1 ) / lengthSquared;
+	float position = ( ( x + 0.5f - this->start.x ) * deltaX + ( y + 0.5f - this->start.y ) * deltaY ) * scale;
+	kernelTable.gradient( destination, this->table, position, deltaX * scale, count );
+
+}
+
+// The same as fillSpan(), but with 24.8 fixed-point points & exact integer stepping, so every pixel gets the same color wherever its span starts
+// The position along the gradient is kept as a whole part & a remainder of the division by the squared length, which is the same as dividing at every pixel
+void LinearGradient::fillSpanFixed( uint32_t *destination, unsigned int x, unsigned int y, unsigned int count ) const {
+
+	int64_t startX = std::clamp( fixedFromFloat( this->start.x ), -FIXED_GRADIENT_LIMIT, FIXED_GRADIENT_LIMIT );
+	int64_t startY = std::clamp( fixedFromFloat( this->start.y ), -FIXED_GRADIENT_LIMIT, FIXED_GRADIENT_LIMIT );
+	int64_t deltaX = std::clamp( fixedFromFloat( this->end.x ), -FIXED_GRADIENT_LIMIT, FIXED_GRADIENT_LIMIT ) - startX;
+	int64_t deltaY = std::clamp( fixedFromFloat( this->end.y ), -FIXED_GRADIENT_LIMIT, FIXED_GRADIENT_LIMIT ) - startY;
+	int64_t lengthSquared = deltaX * deltaX + deltaY * deltaY;
+
+	if ( lengthSquared == 0 ) {
+		kernelTable.fill( destination, count, this->table[ 0 ] );
+		return;
+	}
+
+	// The table index of the first pixel's center, rounded to the nearest, and how much it changes for every pixel to the right
+	int64_t centerX = ( ( int64_t ) x << FIXED_SHIFT ) + FIXED_ONE / 2;
+	int64_t centerY = ( ( int64_t ) y << FIXED_SHIFT ) + FIXED_ONE / 2;
+	int64_t numerator = ( ( centerX - startX ) * deltaX + ( centerY - startY ) * deltaY ) * ( GRADIENT_TABLE_SIZE - 1 ) + lengthSquared / 2;
+	int64_t position = fixedFloorDivide( numerator, lengthSquared );
+	int64_t remainder = numerator - position * lengthSquared;
+
+	int64_t step = deltaX * FIXED_ONE * ( GRADIENT_TABLE_SIZE - 1 );
+	int64_t stepPosition = fixedFloorDivide( step, lengthSquared );
+	int64_t stepRemainder = step - stepPosition * lengthSquared;
+
+	for ( unsigned int index = 0; index < count; index++ ) {
+		destination[ index ] = this->table[ std::clamp( position, ( int64_t ) 0, ( int64_t ) ( GRADIENT_TABLE_SIZE - 1 ) ) ];
+
+		// Carrying without a branch, as it is taken at an unpredictable fraction of pixels
+		remainder += stepRemainder;
+		int64_t carry = remainder >= lengthSquared ? 1 : 0;
+		position += stepPosition + carry;
+		remainder -= lengthSquared & -carry;
+	}
+
+}
+
+// A hash of the points & every color in the table, equal gradients always have equal hashes
+uint64_t LinearGradient::getHash() const {
+
+	uint64_t hash = HASH_OFFSET_BASIS;
+	hash = hashValue( hash, this->start.x );
+	hash = hashValue( hash, this->start.y );
+	hash = hashValue( hash, this->end.x );
+	hash = hashValue( hash, this->end.y );
+	return hashBytes( hash, this->table, sizeof( this->table ) );
+
+}
+
+// Each pixel's position is worked out from the first rather than added up pixel by pixel, so versions doing several pixels at once give exactly the same colors
+void gradientFillSpan( uint32_t *destination, const uint32_t *table, float position, float step, unsigned int count ) {
+
+	for ( unsigned int index = 0; index < count; index++ ) {
+		float clamped = std::clamp( position + ( float ) index * step, 0.0f, ( float ) ( GRADIENT_TABLE_SIZE - 1 ) );
+		destination[ index ] = table[ ( unsigned int ) ( clamped + 0.5f ) ];
+	}
+
+}
+
+// Starts drawing into a framebuffer
+Canvas::Canvas( Framebuffer &framebuffer ) :
+	target( &framebuffer ) {
+
+}
+
+// Changes the framebuffer being drawn into, which is the whole picture until setTile() is called
+void Canvas::setTarget( Framebuffer &framebuffer ) {
+
+	this->target = &framebuffer;
+	this->originX = 0;
+	this->originY = 0;
+	this->width = 0;
+	this->height = 0;
+
+}
+
+// Makes the target a tile of a bigger picture, with its top-left at a position within a picture of a size
+// Shapes are drawn in the coordinates of the whole picture, and only the part within the tile is drawn
+void Canvas::setTile( unsigned int x, unsigned int y, unsigned int pictureWidth, unsigned int pictureHeight ) {
+
+	this->originX = x;
+	this->originY = y;
+	this->width = pictureWidth;
+	this->height = pictureHeight;
+
+}
+
+// Changes how closely curves are followed, smaller is smoother but slower
+void Canvas::setTolerance( float newTolerance ) {
+	this->tolerance = newTolerance;
+}
+
+// Switches rectangles, ellipses & gradients to (or back from) the fixed-point rasterizer
+// Its output only depends on the shapes, not on the compiler, instruction set or how the picture is split into tiles, so it can be compared by hash
+void Canvas::setFixedPoint( bool newIsFixedPoint ) {
+	this->isFixedPoint = newIsFixedPoint;
+}
+
+// The framebuffer being drawn into
+Framebuffer &Canvas::getTarget() {
+	return *this->target;
+}
+
+// The width of the whole picture
+unsigned int Canvas::getWidth() const {
+	return this->width != 0 ? this->width : this->target->width;
+}
+
+// The height of the whole picture
+unsigned int Canvas::getHeight() const {
+	return this->height != 0 ? this->height : this->target->height;
+}
+
+// Moves flattened points from the coordinates of the whole picture to those of the tile being drawn
+void Canvas::moveToTile() {
+
+	if ( this->originX == 0 && this->originY == 0 ) return;
+
+	float offsetX = ( float ) this->originX;
+	float offsetY = ( float ) this->originY;
+	for ( Point &point : this->flattened.points ) {
+		point.x -= offsetX;
+		point.y -= offsetY;
+	}
+
+}
+
+// Converts a point in the whole picture to fixed point in the tile being drawn
+// The tile's origin is moved in whole pixels after converting, so a point lands on the same subpixel whichever tile it is drawn in
+FixedPoint Canvas::toFixedTile( float x, float y ) const {
+	return { fixedFromFloat( x ) - ( ( int32_t ) this->originX << FIXED_SHIFT ), fixedFromFloat( y ) - ( ( int32_t ) this->originY << FIXED_SHIFT ) };
+}
+
+// Fills the entire framebuffer with a single color
+void Canvas::clear( uint32_t color ) {
+
+	for ( unsigned int row = 0; row < this->target->height; row++ ) {
+		kernelTable.fill( this->target->pixels + ( size_t ) row * this->target->stride, this->target->width, color );
+	}
+
+}
+
+// Fills whatever is in the rasterizer using a paint, then empties it
+void Canvas::fillRasterized( const Paint &paint, FillRule fillRule ) {
+
+	Framebuffer &framebuffer = *this->target;
+
+	if ( paint.gradient != NULL ) {
+		this->spanColors.resize( framebuffer.width );
+
+		this->rasterizer.render( fillRule, [ this, &framebuffer, &paint ]( unsigned int row, unsigned int x, unsigned int count, const uint8_t *coverage ) {
+			paint.gradient->fillSpan( this->spanColors.data(), x + this->originX, row + this->originY, count );
+			kernelTable.blend( framebuffer.pixels + ( size_t ) row * framebuffer.stride + x, this->spanColors.data(), coverage, count );
+		} );
+	} else {
+		this->rasterizer.render( fillRule, [ &framebuffer, &paint ]( unsigned int row, unsigned int x, unsigned int count, const uint8_t *coverage ) {
+			kernelTable.blendSolid( framebuffer.pixels + ( size_t ) row * framebuffer.stride + x, coverage, count, paint.color );
+		} );
+	}
+
+	this->rasterizer.reset( framebuffer.width, framebuffer.height );
+
+}
+
+// Fills whatever is in the fixed-point rasterizer using a paint, then empties it
+void Canvas::fillFixedRasterized( const Paint &paint, FillRule fillRule ) {
+
+	Framebuffer &framebuffer = *this->target;
+
+	if ( paint.gradient != NULL ) {
+		this->spanColors.resize( framebuffer.width );
+
+		this->fixedRasterizer.render( fillRule, [ this, &framebuffer, &paint ]( unsigned int row, unsigned int x, unsigned int count, const uint8_t *coverage ) {
+			paint.gradient->fillSpanFixed( this->spanColors.data(), x + this->originX, row + this->originY, count );
+			kernelTable.blend( framebuffer.pixels + ( size_t ) row * framebuffer.stride + x, this->spanColors.data(), coverage, count );
+		} );
+	} else {
+		this->fixedRasterizer.render( fillRule, [ &framebuffer, &paint ]( unsigned int row, unsigned int x, unsigned int count, const uint8_t *coverage ) {
+			kernelTable.blendSolid( framebuffer.pixels + ( size_t ) row * framebuffer.stride + x, coverage, count, paint.color );
+		} );
+	}
+
+	this->fixedRasterizer.reset( framebuffer.width, framebuffer.height );
+
+}
+
+// Fills whole pixels of the target with an opaque color, given in the coordinates of the tile & clipped to it
+void Canvas::fillPixels( int left, int top, int right, int bottom, uint32_t color ) {
+
+	Framebuffer &framebuffer = *this->target;
+
+	left = std::clamp( left, 0, ( int ) framebuffer.width );
+	right = std::clamp( right, 0, ( int ) framebuffer.width );
+	top = std::clamp( top, 0, ( int ) framebuffer.height );
+	bottom = std::clamp( bottom, 0, ( int ) framebuffer.height );
+
+	for ( int row = top; row < bottom && left < right; row++ ) {
+		kernelTable.fill( framebuffer.pixels + ( size_t ) row * framebuffer.stride + left, right - left, color );
+	}
+
+}
+
+// Fills the inside of a rectangle
+void Canvas::fillRectangle( const Rect &rectangle, const Paint &paint ) {
+
+	bool isOpaqueColor = paint.gradient == NULL && ( paint.color >> 24 ) == 255;
+
+	if ( this->isFixedPoint ) {
+		FixedPoint topLeft = this->toFixedTile( rectangle.left, rectangle.top );
+		FixedPoint bottomRight = this->toFixedTile( rectangle.right, rectangle.bottom );
+
+		// Rectangles on whole pixels need no anti-aliasing, so opaque colors can be written straight in
+		if ( isOpaqueColor && ( ( topLeft.x | topLeft.y | bottomRight.x | bottomRight.y ) & ( FIXED_ONE - 1 ) ) == 0 ) {
+			this->fillPixels( topLeft.x >> FIXED_SHIFT, topLeft.y >> FIXED_SHIFT, bottomRight.x >> FIXED_SHIFT, bottomRight.y >> FIXED_SHIFT, paint.color );
+			return;
+		}
+
+		this->fixedRasterizer.reset( this->target->width, this->target->height );
+		this->fixedRasterizer.addRectangle( topLeft.x, topLeft.y, bottomRight.x, bottomRight.y, false );
+		this->fillFixedRasterized( paint, FillRule::NonZero );
+		return;
+	}
+
+	// Rectangles on whole pixels need no anti-aliasing, so opaque colors can be written straight in
+	if ( isOpaqueColor &&
+		rectangle.left == std::floor( rectangle.left ) && rectangle.top == std::floor( rectangle.top ) &&
+		rectangle.right == std::floor( rectangle.right ) && rectangle.bottom == std::floor( rectangle.bottom ) ) {
+
+		this->fillPixels( ( int ) rectangle.left - ( int ) this->originX, ( int ) rectangle.top - ( int ) this->originY, ( int ) rectangle.right - ( int ) this->originX, ( int ) rectangle.bottom - ( int ) this->originY, paint.color );
+		return;
+	}
+
+	this->shapePath.clear();
+	this->shapePath.addRectangle( rectangle.left, rectangle.top, rectangle.right, rectangle.bottom );
+	this->fillPath( this->shapePath, paint, FillRule::NonZero );
+
+}
+
+// Outlines a rectangle, with the stroke centered on its edges
+void Canvas::drawRectangle( const Rect &rectangle, const Paint &paint, float strokeWidth ) {
+
+	// The stroke of a rectangle with mitered corners is the rectangle grown by half the width, with a hole of it shrunk by half the width
+	if ( this->isFixedPoint ) {
+		FixedPoint topLeft = this->toFixedTile( std::min( rectangle.left, rectangle.right ), std::min( rectangle.top, rectangle.bottom ) );
+		FixedPoint bottomRight = this->toFixedTile( std::max( rectangle.left, rectangle.right ), std::max( rectangle.top, rectangle.bottom ) );
+		int32_t halfWidth = fixedFromFloat( strokeWidth * 0.5f );
+
+		this->fixedRasterizer.reset( this->target->width, this->target->height );
+		this->fixedRasterizer.addRectangle( topLeft.x - halfWidth, topLeft.y - halfWidth, bottomRight.x + halfWidth, bottomRight.y + halfWidth, false );
+		if ( bottomRight.x - topLeft.x > halfWidth * 2 && bottomRight.y - topLeft.y > halfWidth * 2 ) {
+			this->fixedRasterizer.addRectangle( topLeft.x + halfWidth, topLeft.y + halfWidth, bottomRight.x - halfWidth, bottomRight.y - halfWidth, true );
+		}
+
+		this->fillFixedRasterized( paint, FillRule::NonZero );
+		return;
+	}
+
+	StrokeStyle style;
+	style.width = strokeWidth;
+
+	this->shapePath.clear();
+	this->shapePath.addRectangle( rectangle.left, rectangle.top, rectangle.right, rectangle.bottom );
+	this->drawPath( this->shapePath, paint, style );
+
+}
+
+// Fills the inside of an ellipse
+void Canvas::fillEllipse( Point center, float radiusX, float radiusY, const Paint &paint ) {
+
+	if ( this->isFixedPoint ) {
+		this->fixedRasterizer.reset( this->target->width, this->target->height );
+		this->fixedRasterizer.addEllipse( this->toFixedTile( center.x, center.y ), fixedFromFloat( radiusX ), fixedFromFloat( radiusY ), fixedFromFloat( this->tolerance ), false );
+		this->fillFixedRasterized( paint, FillRule::NonZero );
+		return;
+	}
+
+	this->shapePath.clear();
+	this->shapePath.addEllipse( center.x, center.y, radiusX, radiusY );
+	this->fillPath( this->shapePath, paint, FillRule::NonZero );
+
+}
+
+// Outlines an ellipse, with the stroke centered on its edge
+void Canvas::drawEllipse( Point center, float radiusX, float radiusY, const Paint &paint, float strokeWidth ) {
+
+	// The stroke is an ellipse grown by half the width, with a hole of it shrunk by half the width (exact for circles, very close for other ellipses)
+	if ( this->isFixedPoint ) {
+		FixedPoint fixedCenter = this->toFixedTile( center.x, center.y );
+		int32_t fixedRadiusX = fixedFromFloat( radiusX );
+		int32_t fixedRadiusY = fixedFromFloat( radiusY );
+		int32_t halfWidth = fixedFromFloat( strokeWidth * 0.5f );
+		int32_t fixedTolerance = fixedFromFloat( this->tolerance );
+
+		this->fixedRasterizer.reset( this->target->width, this->target->height );
+		this->fixedRasterizer.addEllipse( fixedCenter, fixedRadiusX + halfWidth, fixedRadiusY + halfWidth, fixedTolerance, false );
+		this->fixedRasterizer.addEllipse( fixedCenter, fixedRadiusX - halfWidth, fixedRadiusY - halfWidth, fixedTolerance, true );
+		this->fillFixedRasterized( paint, FillRule::NonZero );
+		return;
+	}
+
+	StrokeStyle style;
+	style.width = strokeWidth;
+
+	this->shapePath.clear();
+	this->shapePath.addEllipse( center.x, center.y, radiusX, radiusY );
+	this->drawPath( this->shapePath, paint, style );
+
+}
+
+// Fills the inside of a path
+void Canvas::fillPath( const Path &path, const Paint &paint, FillRule fillRule ) {
+
+	path.flatten( this->tolerance, this->flattened );
+	this->moveToTile();
+
+	this->rasterizer.reset( this->target->width, this->target->height );
+	pathFill( this->flattened, this->rasterizer );
+	this->fillRasterized( paint, fillRule );
+
+}
+
+// Outlines a path, stroke outlines always use the non-zero rule so overlapping pieces do not cancel out
+void Canvas::drawPath( const Path &path, const Paint &paint, const StrokeStyle &style ) {
+
+	path.flatten( this->tolerance, this->flattened );
+	this->moveToTile();
+
+	this->rasterizer.reset( this->target->width, this->target->height );
+	pathStroke( this->flattened, style, this->tolerance, this->rasterizer );
+	this->fillRasterized( paint, FillRule::NonZero );
+
+}
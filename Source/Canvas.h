@@ -0,0 +1,144 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Dynamic arrays
+#include <vector>
+
+// The pixels we draw into
+#include "Framebuffer.h"
+
+// Paths & the rasterizer that fills them
+#include "Path.h"
+#include "Rasterizer.h"
+
+// The integer rasterizer used in fixed-point mode
+#include "FixedRasterizer.h"
+
+// The number of precomputed colors in a gradient lookup table
+const unsigned int GRADIENT_TABLE_SIZE = 256;
+
+// An axis-aligned rectangle in pixels, same layout as D2D1_RECT_F
+struct Rect {
+	float left;
+	float top;
+	float right;
+	float bottom;
+};
+
+// A color at a position (between 0 and 1) along a gradient, with straight (not premultiplied) alpha
+struct GradientStop {
+	float position;
+	float red;
+	float green;
+	float blue;
+	float alpha;
+};
+
+// A linear gradient between two points, clamped at both ends like D2D1_EXTEND_MODE_CLAMP
+class LinearGradient {
+
+	// Only usable by this class
+	private:
+
+		// Where the gradient starts & ends
+		Point start = { 0.0f, 0.0f };
+		Point end = { 1.0f, 0.0f };
+
+		// The color at evenly spaced positions along the gradient, so drawing never has to interpolate between stops
+		uint32_t table[ GRADIENT_TABLE_SIZE ] = { 0 };
+
+	// Usable by anyone
+	public:
+
+		// Setup
+		void setStops( const GradientStop *, unsigned int );
+		void setPoints( Point, Point );
+
+		// Writes the colors of a run of pixels on a single row, with floats or exactly reproducible integers
+		void fillSpan( uint32_t *, unsigned int, unsigned int, unsigned int ) const;
+		void fillSpanFixed( uint32_t *, unsigned int, unsigned int, unsigned int ) const;
+
+		// Identifies the gradient by its points & colors, so display lists using it can be compared
+		uint64_t getHash() const;
+
+};
+
+// Looks up a run of colors from a gradient table, the plain version of the gradient kernel
+void gradientFillSpan( uint32_t *, const uint32_t *, float, float, unsigned int );
+
+// What to draw with: a single color, or a gradient if one is set
+struct Paint {
+	uint32_t color = 0xFF000000;
+	const LinearGradient *gradient = NULL;
+};
+
+// Draws shapes into a framebuffer without any graphics device, the software equivalent of an ID2D1RenderTarget
+class Canvas {
+
+	// Only usable by this class
+	private:
+
+		// The pixels being drawn to
+		Framebuffer *target;
+
+		// When the target is only a tile of a bigger picture: where its top-left is within the picture, and the size of the whole picture
+		unsigned int originX = 0;
+		unsigned int originY = 0;
+		unsigned int width = 0;
+		unsigned int height = 0;
+
+		// How far (in pixels) flattened curves may stray from the real curves
+		float tolerance = 0.2f;
+
+		// Whether rectangles, ellipses & gradients are drawn with integers only, so every build & tile size draws exactly the same pixels
+		bool isFixedPoint = false;
+
+		// Reused between shapes to avoid allocating
+		Rasterizer rasterizer;
+		FixedRasterizer fixedRasterizer;
+		FlattenedPath flattened;
+		Path shapePath;
+		std::vector<uint32_t> spanColors;
+
+		// Fills whatever is in the rasterizer or fixed-point rasterizer using a paint
+		void fillRasterized( const Paint &, FillRule );
+		void fillFixedRasterized( const Paint &, FillRule );
+
+		// Fills whole pixels of the target with an opaque color
+		void fillPixels( int, int, int, int, uint32_t );
+
+		// Converts a point in the whole picture to fixed point in the tile being drawn
+		FixedPoint toFixedTile( float, float ) const;
+
+		// Moves the flattened path into the tile being drawn
+		void moveToTile();
+
+	// Usable by anyone
+	public:
+
+		// Constructor
+		Canvas( Framebuffer & );
+
+		// Setup
+		void setTarget( Framebuffer & );
+		void setTile( unsigned int, unsigned int, unsigned int, unsigned int );
+		void setTolerance( float );
+		void setFixedPoint( bool );
+		Framebuffer &getTarget();
+
+		// The size of the whole picture, which is bigger than the target when drawing a tile
+		unsigned int getWidth() const;
+		unsigned int getHeight() const;
+
+		// Drawing
+		void clear( uint32_t );
+		void fillRectangle( const Rect &, const Paint & );
+		void drawRectangle( const Rect &, const Paint &, float );
+		void fillEllipse( Point, float, float, const Paint & );
+		void drawEllipse( Point, float, float, const Paint &, float );
+		void fillPath( const Path &, const Paint &, FillRule );
+		void drawPath( const Path &, const Paint &, const StrokeStyle & );
+
+};
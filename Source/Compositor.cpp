@@ -0,0 +1,269 @@
+#include "Compositor.h"
+
+// Copying rows of pixels
+#include <cstring>
+
+// Min & max
+#include <algorithm>
+
+// The fastest span operations for the CPU
+#include "Kernels.h"
+
+// Is the area empty?
+static bool pixelRectIsEmpty( const PixelRect &area ) {
+	return area.right <= area.left || area.bottom <= area.top;
+}
+
+// The overlap of two areas, which may be empty
+static PixelRect pixelRectIntersect( const PixelRect &first, const PixelRect &second ) {
+	return { std::max( first.left, second.left ), std::max( first.top, second.top ), std::min( first.right, second.right ), std::min( first.bottom, second.bottom ) };
+}
+
+// The smallest area containing both areas
+static PixelRect pixelRectUnion( const PixelRect &first, const PixelRect &second ) {
+	return { std::min( first.left, second.left ), std::min( first.top, second.top ), std::max( first.right, second.right ), std::max( first.bottom, second.bottom ) };
+}
+
+// The number of pixels in an area
+static unsigned long long pixelRectArea( const PixelRect &area ) {
+	return pixelRectIsEmpty( area ) ? 0 : ( unsigned long long ) ( area.right - area.left ) * ( unsigned long long ) ( area.bottom - area.top );
+}
+
+// Adds a layer on top of the others, drawn with a function the first time it is composited
+// Opaque layers must cover every pixel of their bounds, which lets the compositor skip everything beneath them
+unsigned int Compositor::addLayer( const std::string &name, const std::function<void( Canvas & )> &draw, bool isOpaque ) {
+
+	std::unique_ptr<Layer> layer = std::make_unique<Layer>();
+	layer->name = name;
+	layer->draw = draw;
+	layer->isOpaque = isOpaque;
+
+	this->layers.push_back( std::move( layer ) );
+	return ( unsigned int ) this->layers.size() - 1;
+
+}
+
+// Moves and/or resizes a layer, it is only drawn again if its size changes
+void Compositor::setLayerBounds( unsigned int id, const PixelRect &bounds ) {
+
+	Layer &layer = *this->layers[ id ];
+
+	// Do not continue if nothing changed
+	if ( layer.bounds.left == bounds.left && layer.bounds.top == bounds.top && layer.bounds.right == bounds.right && layer.bounds.bottom == bounds.bottom ) return;
+
+	bool isResized = layer.bounds.right - layer.bounds.left != bounds.right - bounds.left || layer.bounds.bottom - layer.bounds.top != bounds.bottom - bounds.top;
+	if ( isResized ) layer.isDirty = true;
+
+	// Both where it was & where it is now need compositing again
+	if ( layer.isVisible ) {
+		this->addDamage( layer.bounds );
+		this->addDamage( bounds );
+	}
+
+	layer.bounds = bounds;
+
+}
+
+// Shows or hides a layer, hidden layers keep their cached pixels
+void Compositor::setLayerVisible( unsigned int id, bool isVisible ) {
+
+	Layer &layer = *this->layers[ id ];
+	if ( layer.isVisible == isVisible ) return;
+
+	layer.isVisible = isVisible;
+	this->addDamage( layer.bounds );
+
+}
+
+// Marks a layer's content as changed, so it is drawn again on the next frame
+void Compositor::invalidateLayer( unsigned int id ) {
+
+	Layer &layer = *this->layers[ id ];
+	layer.isDirty = true;
+
+	if ( layer.isVisible ) this->addDamage( layer.bounds );
+
+}
+
+// Marks every layer as changed, such as when something they all depend on changes
+void Compositor::invalidateAll() {
+
+	for ( unsigned int id = 0; id < this->layers.size(); id++ ) this->invalidateLayer( id );
+
+}
+
+// Adds an area to the damage, merging it with any it overlaps so the same pixels are never composited twice
+void Compositor::addDamage( const PixelRect &area ) {
+
+	// Do not continue if there is nothing to add
+	if ( pixelRectIsEmpty( area ) ) return;
+
+	PixelRect merged = area;
+	for ( size_t index = 0; index < this->damage.size(); ) {
+		if ( pixelRectIsEmpty( pixelRectIntersect( merged, this->damage[ index ] ) ) ) {
+			index++;
+			continue;
+		}
+
+		// The merged area may now overlap ones that were already checked, so start again
+		merged = pixelRectUnion( merged, this->damage[ index ] );
+		this->damage.erase( this->damage.begin() + index );
+		index = 0;
+	}
+
+	this->damage.push_back( merged );
+
+}
+
+// Draws a layer into its cache, from fully transparent
+void Compositor::rasterize( Layer &layer ) {
+
+	unsigned int width = ( unsigned int ) std::max( layer.bounds.right - layer.bounds.left, 0 );
+	unsigned int height = ( unsigned int ) std::max( layer.bounds.bottom - layer.bounds.top, 0 );
+
+	// Allocating also clears it, otherwise clear the pixels from last time
+	if ( layer.pixels.width != width || layer.pixels.height != height ) {
+		this->statistics.cacheBytes -= layer.pixels.storage.size() * sizeof( uint32_t );
+		framebufferAllocate( layer.pixels, width, height );
+		this->statistics.cacheBytes += layer.pixels.storage.size() * sizeof( uint32_t );
+	} else {
+		std::fill( layer.pixels.storage.begin(), layer.pixels.storage.end(), 0 );
+	}
+
+	layer.isDirty = false;
+	this->statistics.cacheMissCount++;
+	this->statistics.rasterizedPixelCount += ( unsigned long long ) width * height;
+
+	// Do not continue if there is nothing to draw into
+	if ( width == 0 || height == 0 ) return;
+
+	if ( this->canvas == NULL ) this->canvas = std::make_unique<Canvas>( layer.pixels );
+	else this->canvas->setTarget( layer.pixels );
+
+	layer.draw( *this->canvas );
+
+}
+
+// Composites the layers within an area of the target, from the top-most opaque layer covering the whole area upwards
+void Compositor::composite( Framebuffer &target, const PixelRect &area ) {
+
+	// Everything beneath an opaque layer covering the whole area would be hidden
+	size_t firstLayer = 0;
+	for ( size_t index = this->layers.size(); index > 0; index-- ) {
+		const Layer &layer = *this->layers[ index - 1 ];
+		if ( !layer.isVisible || !layer.isOpaque ) continue;
+
+		if ( layer.bounds.left <= area.left && layer.bounds.top <= area.top && layer.bounds.right >= area.right && layer.bounds.bottom >= area.bottom ) {
+			firstLayer = index - 1;
+			break;
+		}
+	}
+
+	// Start from transparent, unless the first layer will cover it all anyway
+	bool isCovered = false;
+	if ( !this->layers.empty() ) {
+		const Layer &bottomLayer = *this->layers[ firstLayer ];
+		isCovered = bottomLayer.isVisible && bottomLayer.isOpaque && bottomLayer.bounds.left <= area.left && bottomLayer.bounds.top <= area.top && bottomLayer.bounds.right >= area.right && bottomLayer.bounds.bottom >= area.bottom;
+	}
+
+	if ( !isCovered ) {
+		for ( int y = area.top; y < area.bottom; y++ ) kernelTable.fill( target.pixels + ( size_t ) y * target.stride + area.left, ( unsigned int ) ( area.right - area.left ), 0 );
+	}
+
+	for ( size_t index = firstLayer; index < this->layers.size(); index++ ) {
+		const Layer &layer = *this->layers[ index ];
+		if ( !layer.isVisible ) continue;
+
+		PixelRect overlap = pixelRectIntersect( area, layer.bounds );
+		if ( pixelRectIsEmpty( overlap ) ) continue;
+
+		unsigned int width = ( unsigned int ) ( overlap.right - overlap.left );
+		for ( int y = overlap.top; y < overlap.bottom; y++ ) {
+			uint32_t *destination = target.pixels + ( size_t ) y * target.stride + overlap.left;
+			const uint32_t *source = layer.pixels.pixels + ( size_t ) ( y - layer.bounds.top ) * layer.pixels.stride + ( overlap.left - layer.bounds.left );
+
+			// Opaque layers are copied, others are blended skipping the transparent & copying the opaque pixels
+			if ( layer.isOpaque ) {
+				std::memcpy( destination, source, width * sizeof( uint32_t ) );
+				continue;
+			}
+
+			kernelTable.blendOver( destination, source, width );
+		}
+	}
+
+	this->statistics.composedPixelCount += pixelRectArea( area );
+
+}
+
+// Draws the dirty layers, then composites whatever changed since the target last had a frame composited into it
+void Compositor::compose( Framebuffer &target ) {
+
+	// Bring every visible layer's cache up to date
+	for ( const std::unique_ptr<Layer> &layer : this->layers ) {
+		if ( !layer->isVisible ) continue;
+
+		if ( layer->isDirty ) this->rasterize( *layer );
+		else this->statistics.cacheHitCount++;
+	}
+
+	// Remember this frame's damage for targets that are a few frames behind
+	this->frameNumber++;
+	this->damageHistory.push_back( this->damage );
+	while ( this->damageHistory.size() > COMPOSITOR_DAMAGE_HISTORY ) this->damageHistory.pop_front();
+	this->damage.clear();
+
+	// Find the last frame the target got, it must be the same pixels at the same size
+	Target *previous = NULL;
+	for ( Target &candidate : this->targets ) {
+		if ( candidate.pixels == target.pixels && candidate.width == target.width && candidate.height == target.height && candidate.stride == target.stride ) previous = &candidate;
+	}
+
+	// Everything in the target needs compositing if it has not had a frame, or has missed more frames than are remembered
+	PixelRect targetArea = { 0, 0, ( int ) target.width, ( int ) target.height };
+	std::vector<PixelRect> areas;
+	unsigned long long age = previous != NULL ? this->frameNumber - previous->frameNumber : 0;
+
+	if ( previous == NULL || age > this->damageHistory.size() ) {
+		areas.push_back( targetArea );
+		this->statistics.fullFrameCount++;
+	} else {
+
+		// Gather the damage of every frame the target missed, merged so overlapping areas are only composited once
+		// This frame's damage was cleared above, so the list is swapped in for addDamage() to merge into
+		std::swap( this->damage, areas );
+		for ( size_t frame = this->damageHistory.size() - ( size_t ) age; frame < this->damageHistory.size(); frame++ ) {
+			for ( const PixelRect &area : this->damageHistory[ frame ] ) this->addDamage( pixelRectIntersect( area, targetArea ) );
+		}
+		std::swap( this->damage, areas );
+
+	}
+
+	for ( const PixelRect &area : areas ) this->composite( target, area );
+
+	// Remember which frame the target now has, forgetting the targets that have not been used for longest
+	if ( previous != NULL ) {
+		previous->frameNumber = this->frameNumber;
+	} else {
+		this->targets.push_back( { target.pixels, target.width, target.height, target.stride, this->frameNumber } );
+		if ( this->targets.size() > COMPOSITOR_DAMAGE_HISTORY ) {
+			this->targets.erase( std::min_element( this->targets.begin(), this->targets.end(), []( const Target &first, const Target &second ) {
+				return first.frameNumber < second.frameNumber;
+			} ) );
+		}
+	}
+
+	this->statistics.frameCount++;
+
+}
+
+// Forgets which frames every target has, so each one gets every pixel composited next time
+// Needed when something other than the compositor (such as a cached frame) was copied into them
+void Compositor::forgetTargets() {
+	this->targets.clear();
+}
+
+// Gets a copy of the statistics so far
+CompositorStatistics Compositor::getStatistics() const {
+	return this->statistics;
+}
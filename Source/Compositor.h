@@ -0,0 +1,113 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Names of layers
+#include <string>
+
+// Lists of layers, damage & targets
+#include <vector>
+#include <deque>
+
+// Layers & their drawing functions
+#include <memory>
+#include <functional>
+
+// Software drawing
+#include "Canvas.h"
+
+// How many frames of damage are remembered, so a target that was last composited this many frames ago (such as a ring of buffers) only needs the damage since then
+const unsigned int COMPOSITOR_DAMAGE_HISTORY = 4;
+
+// An area of whole pixels, the right & bottom edges are not included
+struct PixelRect {
+	int left;
+	int top;
+	int right;
+	int bottom;
+};
+
+// How well the layer caches are working, counted since the compositor was created
+struct CompositorStatistics {
+	unsigned long long frameCount = 0;
+	unsigned long long fullFrameCount = 0; // Frames that had to composite every pixel, such as the first frame into each target
+	unsigned long long cacheHitCount = 0; // Layers composited from their cached pixels
+	unsigned long long cacheMissCount = 0; // Layers that had to be drawn again first
+	unsigned long long rasterizedPixelCount = 0; // The area of the layers drawn again
+	unsigned long long composedPixelCount = 0; // The area of the target that was composited
+	size_t cacheBytes = 0; // Memory used by the cached pixels right now
+};
+
+// Builds frames out of layers that each keep their drawn pixels, only drawing a layer again when its content or size changes
+// Only the parts of the target that changed since it was last composited into are composited again, so a frame with a small moving overlay costs about the overlay's area
+class Compositor {
+
+	// Only usable by this class
+	private:
+
+		// A layer, drawn in its own coordinates (the top-left of its bounds is the origin)
+		struct Layer {
+			std::string name;
+			std::function<void( Canvas & )> draw;
+			PixelRect bounds = { 0, 0, 0, 0 };
+			Framebuffer pixels;
+			bool isOpaque = false; // Covers every pixel of its bounds, so nothing below it needs compositing
+			bool isVisible = true;
+			bool isDirty = true;
+		};
+
+		// A target that was composited into recently, & which frame it got
+		struct Target {
+			const uint32_t *pixels;
+			unsigned int width;
+			unsigned int height;
+			unsigned int stride;
+			unsigned long long frameNumber;
+		};
+
+		// Layers from the bottom up, their index is their id
+		std::vector<std::unique_ptr<Layer>> layers;
+
+		// Draws the layers, created by the first layer drawn
+		std::unique_ptr<Canvas> canvas;
+
+		// What changed since the last frame, what changed in recent frames, and which targets have which frames in them
+		std::vector<PixelRect> damage;
+		std::deque<std::vector<PixelRect>> damageHistory;
+		std::vector<Target> targets;
+		unsigned long long frameNumber = 0;
+
+		CompositorStatistics statistics;
+
+		// Adds an area to this frame's damage
+		void addDamage( const PixelRect & );
+
+		// Draws a layer again into its cache
+		void rasterize( Layer & );
+
+		// Composites every layer within an area of the target
+		void composite( Framebuffer &, const PixelRect & );
+
+	// Usable by anyone
+	public:
+
+		// Adding layers, on top of the existing ones
+		unsigned int addLayer( const std::string &, const std::function<void( Canvas & )> &, bool );
+
+		// Changing layers, moving a layer only composites it again but resizing it also draws it again
+		void setLayerBounds( unsigned int, const PixelRect & );
+		void setLayerVisible( unsigned int, bool );
+		void invalidateLayer( unsigned int );
+		void invalidateAll();
+
+		// Draws any layers that changed, then composites what changed into the target
+		void compose( Framebuffer & );
+
+		// Forgets which frames the targets have, when something else wrote into them
+		void forgetTargets();
+
+		// Telemetry
+		CompositorStatistics getStatistics() const;
+
+};
@@ -4,12 +4,24 @@
 // Console functions
 #include "Console.h"
 
-// Creates the factories for creating other resources
+// Startup timeline
+#include "Timeline.h"
+
+// The text drawn in the middle of the window
+const WCHAR HELLO_TEXT[] = L"Hello World!";
+
+// Creates the factories for creating other resources, then starts creating the text resources on other workers
+// This does not touch the window, so it runs on a worker thread while the main thread creates the window
 void MyWindow::setupDirect2D() {
 
+	// Record how long this takes on the startup timeline
+	TimelineSpan timelineSpan( "Create Direct2D & DirectWrite factories" );
+
 	// Create a Direct2D factory, which is used to create resources, there should only be one for the lifetime of the application
+	// It is multi-threaded so brushes can be pre-warmed on a worker while the main thread draws, Direct2D serializes access to the render target itself
 	// https://docs.microsoft.com/en-us/windows/win32/direct2d/getting-started-with-direct2d#step-2-create-an-id2d1factory
-	HRESULT d2dFactoryResult = D2D1CreateFactory( D2D1_FACTORY_TYPE_SINGLE_THREADED, &this->d2dFactory );
+	// https://docs.microsoft.com/en-us/windows/win32/direct2d/multi-threaded-direct2d-apps
+	HRESULT d2dFactoryResult = D2D1CreateFactory( D2D1_FACTORY_TYPE_MULTI_THREADED, &this->d2dFactory );
 
 	// Do not continue if there was an issue creating the Direct2D factory
 	if ( FAILED( d2dFactoryResult ) || this->d2dFactory == NULL ) {
@@ -35,19 +47,76 @@ void MyWindow::setupDirect2D() {
 	// Display a message to the console
 	consoleOutput( "Created Direct2D & DirectWrite factories." );
 
-	// Create the graphics resources so they are ready for the first paint call
-	this->createGraphicsResources();
+	// Lay out the text on another worker, which loads the font & shapes its glyphs, so the first paint does not have to
+	this->writeTextLayout.prewarm();
 
 }
 
-// Creates the graphics (device-independent) resources (render target, brushes, etc.)
-void MyWindow::createGraphicsResources() {
+// Creates the text format, used by the text layout
+IDWriteTextFormat *MyWindow::createTextFormat() {
 
-	// Do not continue if any of these resources have already been created
-	if ( this->renderTarget != NULL ||
-		this->solidBrushOutline != NULL ||
-		this->gradientBrushFill != NULL ||
-		this->writeTextFormat != NULL ) return;
+	// Create DirectWrite text format
+	IDWriteTextFormat *textFormat = NULL;
+	HRESULT textFormatResult = this->writeFactory->CreateTextFormat(
+		L"Arial", // The name of the font to use
+		NULL, // No collection of fonts
+		DWRITE_FONT_WEIGHT_NORMAL, // Use standard font weight
+		DWRITE_FONT_STYLE_NORMAL, // No additional font styling
+		DWRITE_FONT_STRETCH_NORMAL, // Use standard stretching
+		22.0f, // The font size
+		L"", // The locale
+		&textFormat
+	);
+
+	// Do not continue if there was an issue creating the text format
+	if ( FAILED( textFormatResult ) || textFormat == NULL ) {
+		consoleError( "Failed to create the DirectWrite text format! (%l)", textFormatResult );
+		ExitProcess( 1 );
+		return NULL;
+	}
+
+	// Center the text horizontally & vertically
+	textFormat->SetTextAlignment( DWRITE_TEXT_ALIGNMENT_CENTER );
+	textFormat->SetParagraphAlignment( DWRITE_PARAGRAPH_ALIGNMENT_CENTER );
+
+	return textFormat;
+
+}
+
+// Creates the layout of the text drawn in the middle of the window, which creates the text format first if needed
+// The maximum size is a placeholder, the paint handler fits it to the rectangle the text is drawn in
+IDWriteTextLayout *MyWindow::createTextLayout() {
+
+	IDWriteTextLayout *textLayout = NULL;
+	HRESULT textLayoutResult = this->writeFactory->CreateTextLayout(
+		HELLO_TEXT, // The text to lay out
+		( UINT32 ) wcslen( HELLO_TEXT ), // The length of the text
+		this->writeTextFormat.get(), // The text formatter resource
+		( FLOAT ) this->WINDOW_WIDTH, // Maximum width
+		( FLOAT ) this->WINDOW_HEIGHT, // Maximum height
+		&textLayout
+	);
+
+	// Do not continue if there was an issue creating the text layout
+	if ( FAILED( textLayoutResult ) || textLayout == NULL ) {
+		consoleError( "Failed to create the DirectWrite text layout! (%l)", textLayoutResult );
+		ExitProcess( 1 );
+		return NULL;
+	}
+
+	return textLayout;
+
+}
+
+// Creates the render target for the window, must be called on the main thread before drawing
+// The brushes are not created here, they are created by their first use, or by workers straight away if they will be needed on the next paint
+void MyWindow::createRenderTarget() {
+
+	// Do not continue if the render target has already been created
+	if ( this->renderTarget != NULL ) return;
+
+	// Record how long this takes on the startup timeline (and after the graphics device is lost)
+	TimelineSpan timelineSpan( "Create Direct2D render target" );
 
 	// Get the size of the window client area for drawing on
 	RECT drawingArea;
@@ -71,24 +140,42 @@ void MyWindow::createGraphicsResources() {
 		return;
 	}
 
-	// Create a solid brush for painting (RGB values can also be given in hexadecimal notation)
-	// https://docs.microsoft.com/en-us/windows/win32/direct2d/getting-started-with-direct2d#step-4-create-a-brush
-	HRESULT solidBrushResult = this->renderTarget->CreateSolidColorBrush( D2D1::ColorF( D2D1::ColorF::Black, 1.0f ), &this->solidBrushOutline );
+	// Display a message to the console
+	consoleOutput( "Created Direct2D render target." );
+
+	// The text is always drawn with Direct2D, but the shapes are not when the scene is drawn in software
+	this->solidBrushText.prewarm();
+	if ( !this->sharedFramebuffer.isOpen() && !this->recorder.isRecording() ) {
+		this->solidBrushOutline.prewarm();
+		this->gradientBrushFill.prewarm();
+	}
+
+}
+
+// Creates a solid brush for painting (RGB values can also be given in hexadecimal notation)
+// https://docs.microsoft.com/en-us/windows/win32/direct2d/getting-started-with-direct2d#step-4-create-a-brush
+ID2D1SolidColorBrush *MyWindow::createSolidBrush( const D2D1_COLOR_F &color ) {
+
+	ID2D1SolidColorBrush *solidBrush = NULL;
+	HRESULT solidBrushResult = this->renderTarget->CreateSolidColorBrush( color, &solidBrush );
 
 	// Do not continue if there was an issue creating the solid brush
-	if ( FAILED( solidBrushResult ) || this->solidBrushOutline == NULL ) {
+	if ( FAILED( solidBrushResult ) || solidBrush == NULL ) {
 		consoleError( "Failed to create the Direct2D solid brush! (%l)", solidBrushResult );
 		ExitProcess( 1 );
-		return;
+		return NULL;
 	}
 
-	// Create a solid brush for text
-	HRESULT solidBrushTextResult = this->renderTarget->CreateSolidColorBrush( D2D1::ColorF( D2D1::ColorF::Blue, 1.0f ), &this->solidBrushText );
-	if ( FAILED( solidBrushTextResult ) || this->solidBrushText == NULL ) {
-		consoleError( "Failed to create the Direct2D solid brush for text! (%l)", solidBrushTextResult );
-		ExitProcess( 1 );
-		return;
-	}
+	return solidBrush;
+
+}
+
+// Creates the linear gradient brush the rectangle is filled with
+ID2D1LinearGradientBrush *MyWindow::createGradientBrush() {
+
+	// Get the size of the window client area, for where the gradient ends
+	RECT drawingArea;
+	GetClientRect( this->windowHandle, &drawingArea );
 
 	// Create an array to hold two gradient stop structures
 	const int GRADIENT_STOPS_COUNT = 2;
@@ -103,7 +190,7 @@ void MyWindow::createGraphicsResources() {
 	// Create a gradient stop collection using the above stops
 	// https://docs.microsoft.com/en-us/windows/win32/api/d2d1/nf-d2d1-id2d1rendertarget-creategradientstopcollection(constd2d1_gradient_stop_uint32_d2d1_gamma_d2d1_extend_mode_id2d1gradientstopcollection)
 	ID2D1GradientStopCollection *gradientStopCollection = NULL;
-	HRESULT gradientCollectionResult = renderTarget->CreateGradientStopCollection(
+	HRESULT gradientCollectionResult = this->renderTarget->CreateGradientStopCollection(
 		gradientStops, // The array of gradient stop structures
 		GRADIENT_STOPS_COUNT, // The amount of stops in the array
 		D2D1_GAMMA_2_2, // The color interpolation mode
@@ -115,101 +202,72 @@ void MyWindow::createGraphicsResources() {
 	if ( FAILED( gradientCollectionResult ) || gradientStopCollection == NULL ) {
 		consoleError( "Failed to create the Direct2D gradient stop collection! (%l)", gradientCollectionResult );
 		ExitProcess( 1 );
-		return;
+		return NULL;
 	}
 
 	// Create a linear gradient brush for painting, using the gradient stops collection
 	// https://docs.microsoft.com/en-us/windows/win32/Direct2D/how-to-create-a-linear-gradient-brush
-	HRESULT gradientBrushResult = renderTarget->CreateLinearGradientBrush(
+	ID2D1LinearGradientBrush *gradientBrush = NULL;
+	HRESULT gradientBrushResult = this->renderTarget->CreateLinearGradientBrush(
 		D2D1::LinearGradientBrushProperties( // Determines direction of gradient
 			D2D1::Point2F( 0.0f, 0.0f ), // Start at upper-left corner...
 			D2D1::Point2F( drawingArea.bottom, drawingArea.right ) // ...end at lower-right corner.
 		),
 		gradientStopCollection, // The above gradient stop collection
-		&this->gradientBrushFill // A reference to the brush
+		&gradientBrush // A reference to the brush
 	);
 
+	// The brush keeps its own reference to the stops
+	gradientStopCollection->Release();
+
 	// Do not continue if there was an issue creating the linear gradient brush
-	if ( FAILED( gradientBrushResult ) || gradientBrushFill == NULL ) {
+	if ( FAILED( gradientBrushResult ) || gradientBrush == NULL ) {
 		consoleError( "Failed to create the Direct2D linear gradient brush! (%l)", gradientBrushResult );
 		ExitProcess( 1 );
-		return;
+		return NULL;
 	}
 
-	// Create DirectWrite text format
-	HRESULT textFormatResult = this->writeFactory->CreateTextFormat(
-		L"Arial", // The name of the font to use
-		NULL, // No collection of fonts
-		DWRITE_FONT_WEIGHT_NORMAL, // Use standard font weight
-		DWRITE_FONT_STYLE_NORMAL, // No additional font styling
-		DWRITE_FONT_STRETCH_NORMAL, // Use standard stretching
-		22.0f, // The font size
-		L"", // The locale
-		&this->writeTextFormat
-	);
-
-	// Do not continue if there was an issue creating the text format
-	if ( FAILED( textFormatResult ) || writeTextFormat == NULL ) {
-		consoleError( "Failed to create the DirectWrite text format! (%l)", textFormatResult );
-		ExitProcess( 1 );
-		return;
-	}
-
-	// Center the text horizontally & vertically
-	this->writeTextFormat->SetTextAlignment( DWRITE_TEXT_ALIGNMENT_CENTER );
-	this->writeTextFormat->SetParagraphAlignment( DWRITE_PARAGRAPH_ALIGNMENT_CENTER );
-
-	// Display a message to the console
-	consoleOutput( "Created Direct2D & DirectWrite graphics resources." );
+	return gradientBrush;
 
 }
 
-// Discards the graphics (device-independent) resources (render target, brushes, etc.)
+// Discards the graphics (device-dependent) resources (render target, brushes, etc.)
 // https://docs.microsoft.com/en-us/windows/win32/direct2d/getting-started-with-direct2d#step-6-release-resources
 // https://docs.microsoft.com/en-us/windows/win32/medfound/saferelease
 void MyWindow::releaseGraphicsResources() {
 
+	// Discard the brushes first, this waits for any being pre-warmed as they use the render target
+	this->solidBrushOutline.release();
+	this->gradientBrushFill.release();
+	this->solidBrushText.release();
+
+	// Discard the bitmap the shared framebuffer is copied into
+	if ( this->frameBitmap != NULL ) {
+		this->frameBitmap->Release();
+		this->frameBitmap = NULL;
+	}
+
 	// Discard the render target
 	if ( this->renderTarget != NULL ) {
 		this->renderTarget->Release();
 		this->renderTarget = NULL;
 	}
 
-	// Discard the solid color brush
-	if ( this->solidBrushOutline != NULL ) {
-		this->solidBrushOutline->Release();
-		this->solidBrushOutline = NULL;
-	}
-
-	// Discard the linear gradient brush
-	if ( this->gradientBrushFill != NULL ) {
-		this->gradientBrushFill->Release();
-		this->gradientBrushFill = NULL;
-	}
-
-	// Discard the solid color brush for text
-	if ( this->solidBrushText != NULL ) {
-		this->solidBrushText->Release();
-		this->solidBrushText = NULL;
-	}
-
-	// Discard the text formatter
-	if ( this->writeTextFormat != NULL ) {
-		this->writeTextFormat->Release();
-		this->writeTextFormat = NULL;
-	}
-
 	// Display a message to the console
-	consoleOutput( "Released Direct2D & DirectWrite graphics resources." );
+	consoleOutput( "Released Direct2D graphics resources." );
 
 }
 
-// Discards the factories, and graphics resources
+// Discards the factories, text resources, and graphics resources
 void MyWindow::releaseDirect2D() {
 
 	// Discard all graphics resources first
 	this->releaseGraphicsResources();
 
+	// Discard the text layout & formatter
+	this->writeTextLayout.release();
+	this->writeTextFormat.release();
+
 	// Discard the Direct2D factory
 	if ( this->d2dFactory != NULL ) {
 		this->d2dFactory->Release();
@@ -226,3 +284,31 @@ void MyWindow::releaseDirect2D() {
 	consoleOutput( "Released Direct2D & DirectWrite factories." );
 
 }
+
+// Displays how long each resource took to create, and whether it was ready before it was first needed
+void MyWindow::reportResources() {
+
+	LazyResource *resources[] = { &this->writeTextFormat, &this->writeTextLayout, &this->solidBrushText, &this->solidBrushOutline, &this->gradientBrushFill };
+
+	for ( LazyResource *resource : resources ) {
+		ResourceStatistics statistics = resource->getStatistics();
+
+		// Resources that were never needed cost nothing
+		if ( statistics.createdCount == 0 && statistics.failedCount == 0 ) {
+			consoleOutput( "Resource '%s' was never created.", resource->getName().c_str() );
+			continue;
+		}
+
+		consoleOutput( "Resource '%s' created %u times (%u pre-warmed, %u on first use), %.3f ms on average & %.3f ms at most, first use waited %u times for %.3f ms.",
+			resource->getName().c_str(),
+			statistics.createdCount,
+			statistics.prewarmedCount,
+			statistics.onDemandCount,
+			statistics.createdCount > 0 ? statistics.createMilliseconds / statistics.createdCount : 0.0,
+			statistics.maximumCreateMilliseconds,
+			statistics.waitCount,
+			statistics.waitMilliseconds
+		);
+	}
+
+}
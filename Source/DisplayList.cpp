@@ -0,0 +1,123 @@
+#include "DisplayList.h"
+
+// Hashing the calls
+#include "Hash.h"
+
+// Starts empty
+DisplayList::DisplayList() :
+	hash( HASH_OFFSET_BASIS ) {
+
+}
+
+// Removes every call, keeping the memory for the next frame
+void DisplayList::reset() {
+
+	this->commands.clear();
+	this->hash = HASH_OFFSET_BASIS;
+
+}
+
+// Records a call & adds everything it draws to the hash, fields a call does not use are zero so they hash the same every time
+void DisplayList::add( const DisplayCommand &command ) {
+
+	this->commands.push_back( command );
+
+	uint64_t newHash = hashValue( this->hash, command.type );
+	newHash = hashValue( newHash, command.rectangle.left );
+	newHash = hashValue( newHash, command.rectangle.top );
+	newHash = hashValue( newHash, command.rectangle.right );
+	newHash = hashValue( newHash, command.rectangle.bottom );
+	newHash = hashValue( newHash, command.center.x );
+	newHash = hashValue( newHash, command.center.y );
+	newHash = hashValue( newHash, command.radiusX );
+	newHash = hashValue( newHash, command.radiusY );
+	newHash = hashValue( newHash, command.paint.color );
+	newHash = hashValue( newHash, command.paint.gradient != NULL ? command.paint.gradient->getHash() : 0 );
+	this->hash = hashValue( newHash, command.strokeWidth );
+
+}
+
+// Records filling the whole target with a color
+void DisplayList::clear( uint32_t color ) {
+
+	DisplayCommand command = {};
+	command.type = DisplayCommand::Type::Clear;
+	command.paint.color = color;
+	this->add( command );
+
+}
+
+// Records filling a rectangle
+void DisplayList::fillRectangle( const Rect &rectangle, const Paint &paint ) {
+
+	DisplayCommand command = {};
+	command.type = DisplayCommand::Type::FillRectangle;
+	command.rectangle = rectangle;
+	command.paint = paint;
+	this->add( command );
+
+}
+
+// Records outlining a rectangle
+void DisplayList::drawRectangle( const Rect &rectangle, const Paint &paint, float strokeWidth ) {
+
+	DisplayCommand command = {};
+	command.type = DisplayCommand::Type::DrawRectangle;
+	command.rectangle = rectangle;
+	command.paint = paint;
+	command.strokeWidth = strokeWidth;
+	this->add( command );
+
+}
+
+// Records filling an ellipse
+void DisplayList::fillEllipse( Point center, float radiusX, float radiusY, const Paint &paint ) {
+
+	DisplayCommand command = {};
+	command.type = DisplayCommand::Type::FillEllipse;
+	command.center = center;
+	command.radiusX = radiusX;
+	command.radiusY = radiusY;
+	command.paint = paint;
+	this->add( command );
+
+}
+
+// Records outlining an ellipse
+void DisplayList::drawEllipse( Point center, float radiusX, float radiusY, const Paint &paint, float strokeWidth ) {
+
+	DisplayCommand command = {};
+	command.type = DisplayCommand::Type::DrawEllipse;
+	command.center = center;
+	command.radiusX = radiusX;
+	command.radiusY = radiusY;
+	command.paint = paint;
+	command.strokeWidth = strokeWidth;
+	this->add( command );
+
+}
+
+// The hash of every call recorded since the last reset
+uint64_t DisplayList::getHash() const {
+	return this->hash;
+}
+
+// The number of calls recorded since the last reset
+size_t DisplayList::getCount() const {
+	return this->commands.size();
+}
+
+// Draws every call onto a canvas
+void DisplayList::replay( Canvas &canvas ) const {
+
+	for ( const DisplayCommand &command : this->commands ) {
+		switch ( command.type ) {
+			case DisplayCommand::Type::Clear: canvas.clear( command.paint.color ); break;
+			case DisplayCommand::Type::FillRectangle: canvas.fillRectangle( command.rectangle, command.paint ); break;
+			case DisplayCommand::Type::DrawRectangle: canvas.drawRectangle( command.rectangle, command.paint, command.strokeWidth ); break;
+			case DisplayCommand::Type::FillEllipse: canvas.fillEllipse( command.center, command.radiusX, command.radiusY, command.paint ); break;
+			case DisplayCommand::Type::DrawEllipse: canvas.drawEllipse( command.center, command.radiusX, command.radiusY, command.paint, command.strokeWidth ); break;
+		}
+	}
+
+}
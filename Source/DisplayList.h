@@ -0,0 +1,68 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Dynamic arrays
+#include <vector>
+
+// Shapes, paints & the canvas they are replayed onto
+#include "Canvas.h"
+
+// A drawing call recorded in a display list
+struct DisplayCommand {
+	enum class Type : uint8_t {
+		Clear,
+		FillRectangle,
+		DrawRectangle,
+		FillEllipse,
+		DrawEllipse
+	} type;
+
+	Rect rectangle;
+	Point center;
+	float radiusX;
+	float radiusY;
+	Paint paint; // Only the color is used when clearing
+	float strokeWidth;
+};
+
+// The drawing calls for a frame, recorded rather than drawn, with a hash of everything they draw
+// Two lists with the same hash draw the same pixels into the same size target, so the hash can identify a frame before it is drawn
+// Gradients are hashed by their content when recorded, so they must not change until the list has been replayed
+class DisplayList {
+
+	// Only usable by this class
+	private:
+
+		// Every call since the last reset, and the hash of them all
+		std::vector<DisplayCommand> commands;
+		uint64_t hash;
+
+		// Records a call & adds everything it draws to the hash
+		void add( const DisplayCommand & );
+
+	// Usable by anyone
+	public:
+
+		// Constructor
+		DisplayList();
+
+		// Empties the list
+		void reset();
+
+		// Recording, the same as drawing onto a canvas
+		void clear( uint32_t );
+		void fillRectangle( const Rect &, const Paint & );
+		void drawRectangle( const Rect &, const Paint &, float );
+		void fillEllipse( Point, float, float, const Paint & );
+		void drawEllipse( Point, float, float, const Paint &, float );
+
+		// Information
+		uint64_t getHash() const;
+		size_t getCount() const;
+
+		// Draws every call onto a canvas, in the order they were recorded
+		void replay( Canvas & ) const;
+
+};
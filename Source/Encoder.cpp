@@ -0,0 +1,223 @@
+#include "Encoder.h"
+
+// Formatting the stream header
+#include <cstdio>
+
+// The fastest pixel conversions for the CPU
+#include "Kernels.h"
+
+// The chunks of a QOI image
+const uint8_t QOI_OP_INDEX = 0x00;
+const uint8_t QOI_OP_DIFF = 0x40;
+const uint8_t QOI_OP_LUMA = 0x80;
+const uint8_t QOI_OP_RUN = 0xC0;
+const uint8_t QOI_OP_RGB = 0xFE;
+const uint8_t QOI_OP_RGBA = 0xFF;
+
+// The longest run a single chunk can hold
+const unsigned int QOI_MAXIMUM_RUN = 62;
+
+// Appends a 32-bit big-endian integer
+static void appendBigEndian( std::vector<uint8_t> &output, uint32_t value ) {
+
+	output.push_back( ( uint8_t ) ( value >> 24 ) );
+	output.push_back( ( uint8_t ) ( value >> 16 ) );
+	output.push_back( ( uint8_t ) ( value >> 8 ) );
+	output.push_back( ( uint8_t ) value );
+
+}
+
+// Converts a premultiplied BGRA pixel to the straight-alpha RGBA that QOI stores, as 0xAABBGGRR
+static uint32_t unpremultiply( uint32_t pixel ) {
+
+	uint32_t alpha = pixel >> 24;
+
+	// Opaque pixels (almost all of them) only need their red & blue swapped
+	if ( alpha == 255 ) return ( pixel & 0xFF00FF00 ) | ( ( pixel >> 16 ) & 0xFF ) | ( ( pixel & 0xFF ) << 16 );
+	if ( alpha == 0 ) return 0;
+
+	auto divide = [ alpha ]( uint32_t channel ) -> uint32_t {
+		uint32_t value = ( channel * 255 + alpha / 2 ) / alpha;
+		return value > 255 ? 255 : value;
+	};
+
+	return ( alpha << 24 ) | ( divide( pixel & 0xFF ) << 16 ) | ( divide( ( pixel >> 8 ) & 0xFF ) << 8 ) | divide( ( pixel >> 16 ) & 0xFF );
+
+}
+
+// Appends a framebuffer as a QOI image, every pixel is encoded as a reference to a recent color, a run, a small difference, or the full color
+void encodeQOI( const Framebuffer &framebuffer, std::vector<uint8_t> &output ) {
+
+	// The header: magic, size, 4 channels, sRGB with linear alpha
+	output.reserve( output.size() + 14 + ( size_t ) framebuffer.width * framebuffer.height * 2 + 8 );
+	output.insert( output.end(), { 'q', 'o', 'i', 'f' } );
+	appendBigEndian( output, framebuffer.width );
+	appendBigEndian( output, framebuffer.height );
+	output.push_back( 4 );
+	output.push_back( 0 );
+
+	// Recently seen colors, indexed by a hash of the color
+	uint32_t recentColors[ 64 ] = { 0 };
+
+	uint32_t previous = 0xFF000000;
+	unsigned int run = 0;
+
+	for ( unsigned int y = 0; y < framebuffer.height; y++ ) {
+		const uint32_t *row = framebuffer.pixels + ( size_t ) y * framebuffer.stride;
+		bool isLastRow = y + 1 == framebuffer.height;
+
+		for ( unsigned int x = 0; x < framebuffer.width; x++ ) {
+			uint32_t pixel = unpremultiply( row[ x ] );
+
+			// Extend the run of the previous color, ending it if it is full or this is the last pixel
+			if ( pixel == previous ) {
+				run++;
+				if ( run == QOI_MAXIMUM_RUN || ( isLastRow && x + 1 == framebuffer.width ) ) {
+					output.push_back( ( uint8_t ) ( QOI_OP_RUN | ( run - 1 ) ) );
+					run = 0;
+				}
+
+				continue;
+			}
+
+			if ( run > 0 ) {
+				output.push_back( ( uint8_t ) ( QOI_OP_RUN | ( run - 1 ) ) );
+				run = 0;
+			}
+
+			int red = pixel & 0xFF;
+			int green = ( pixel >> 8 ) & 0xFF;
+			int blue = ( pixel >> 16 ) & 0xFF;
+			int alpha = pixel >> 24;
+
+			// Refer to the color if it was seen recently
+			unsigned int hash = ( red * 3 + green * 5 + blue * 7 + alpha * 11 ) % 64;
+			if ( recentColors[ hash ] == pixel ) {
+				output.push_back( ( uint8_t ) ( QOI_OP_INDEX | hash ) );
+				previous = pixel;
+				continue;
+			}
+
+			recentColors[ hash ] = pixel;
+
+			// Changes in alpha need the full color
+			if ( alpha != ( int ) ( previous >> 24 ) ) {
+				output.insert( output.end(), { QOI_OP_RGBA, ( uint8_t ) red, ( uint8_t ) green, ( uint8_t ) blue, ( uint8_t ) alpha } );
+				previous = pixel;
+				continue;
+			}
+
+			// Differences from the previous color wrap around, as the decoder adds them to bytes
+			int redDifference = ( int8_t ) ( red - ( int ) ( previous & 0xFF ) );
+			int greenDifference = ( int8_t ) ( green - ( int ) ( ( previous >> 8 ) & 0xFF ) );
+			int blueDifference = ( int8_t ) ( blue - ( int ) ( ( previous >> 16 ) & 0xFF ) );
+			int redGreenDifference = redDifference - greenDifference;
+			int blueGreenDifference = blueDifference - greenDifference;
+
+			if ( redDifference >= -2 && redDifference <= 1 && greenDifference >= -2 && greenDifference <= 1 && blueDifference >= -2 && blueDifference <= 1 ) {
+				output.push_back( ( uint8_t ) ( QOI_OP_DIFF | ( ( redDifference + 2 ) << 4 ) | ( ( greenDifference + 2 ) << 2 ) | ( blueDifference + 2 ) ) );
+			} else if ( greenDifference >= -32 && greenDifference <= 31 && redGreenDifference >= -8 && redGreenDifference <= 7 && blueGreenDifference >= -8 && blueGreenDifference <= 7 ) {
+				output.push_back( ( uint8_t ) ( QOI_OP_LUMA | ( greenDifference + 32 ) ) );
+				output.push_back( ( uint8_t ) ( ( ( redGreenDifference + 8 ) << 4 ) | ( blueGreenDifference + 8 ) ) );
+			} else {
+				output.insert( output.end(), { QOI_OP_RGB, ( uint8_t ) red, ( uint8_t ) green, ( uint8_t ) blue } );
+			}
+
+			previous = pixel;
+		}
+	}
+
+	// The end marker
+	output.insert( output.end(), { 0, 0, 0, 0, 0, 0, 0, 1 } );
+
+}
+
+// Appends the header of a YUV4MPEG2 stream, full-range BT.601 with chroma centered between each 2 x 2 block of pixels (as JPEG does)
+void encodeY4MHeader( unsigned int width, unsigned int height, unsigned int frameRate, std::vector<uint8_t> &output ) {
+
+	char header[ 128 ];
+	int length = std::snprintf( header, sizeof( header ), "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", width, height, frameRate );
+	output.insert( output.end(), header, header + length );
+
+}
+
+// Appends a frame of a YUV4MPEG2 stream: a full-size luma plane, then quarter-size blue & red chroma planes
+// Premultiplied pixels are effectively composited over black, as the format has no alpha
+void encodeY4MFrame( const Framebuffer &framebuffer, std::vector<uint8_t> &output ) {
+
+	const char FRAME_HEADER[] = "FRAME\n";
+	output.insert( output.end(), FRAME_HEADER, FRAME_HEADER + sizeof( FRAME_HEADER ) - 1 );
+
+	unsigned int width = framebuffer.width;
+	unsigned int height = framebuffer.height;
+	unsigned int chromaWidth = ( width + 1 ) / 2;
+	unsigned int chromaHeight = ( height + 1 ) / 2;
+
+	// Make room for all three planes at once, then fill them in
+	size_t lumaStart = output.size();
+	size_t blueStart = lumaStart + ( size_t ) width * height;
+	size_t redStart = blueStart + ( size_t ) chromaWidth * chromaHeight;
+	output.resize( redStart + ( size_t ) chromaWidth * chromaHeight );
+
+	uint8_t *luma = output.data() + lumaStart;
+	uint8_t *blueChroma = output.data() + blueStart;
+	uint8_t *redChroma = output.data() + redStart;
+
+	// Luma for every pixel, then each chroma sample is the average of the 2 x 2 block it covers, repeating the last row & column of odd sizes
+	for ( unsigned int y = 0; y < height; y++ ) kernelTable.convert( framebuffer.pixels + ( size_t ) y * framebuffer.stride, luma + ( size_t ) y * width, width );
+
+	unsigned int wholeBlocks = width / 2;
+	for ( unsigned int chromaY = 0; chromaY < chromaHeight; chromaY++ ) {
+		unsigned int y = chromaY * 2;
+		const uint32_t *topRow = framebuffer.pixels + ( size_t ) y * framebuffer.stride;
+		const uint32_t *bottomRow = y + 1 < height ? topRow + framebuffer.stride : topRow;
+		uint8_t *blueRow = blueChroma + ( size_t ) chromaY * chromaWidth;
+		uint8_t *redRow = redChroma + ( size_t ) chromaY * chromaWidth;
+
+		kernelTable.downsample( topRow, bottomRow, blueRow, redRow, wholeBlocks );
+
+		if ( wholeBlocks < chromaWidth ) {
+			const uint32_t lastTop[ 2 ] = { topRow[ width - 1 ], topRow[ width - 1 ] };
+			const uint32_t lastBottom[ 2 ] = { bottomRow[ width - 1 ], bottomRow[ width - 1 ] };
+			kernelTable.downsample( lastTop, lastBottom, blueRow + wholeBlocks, redRow + wholeBlocks, 1 );
+		}
+	}
+
+}
+
+// Converts a row of premultiplied pixels to full-range BT.601 luma, the plain version of the convert kernel
+void encodeLuma( const uint32_t *pixels, uint8_t *luma, unsigned int count ) {
+
+	for ( unsigned int index = 0; index < count; index++ ) {
+		uint32_t red = ( pixels[ index ] >> 16 ) & 0xFF;
+		uint32_t green = ( pixels[ index ] >> 8 ) & 0xFF;
+		uint32_t blue = pixels[ index ] & 0xFF;
+		luma[ index ] = ( uint8_t ) ( ( 77 * red + 150 * green + 29 * blue + 128 ) >> 8 );
+	}
+
+}
+
+// Averages each 2 x 2 block of a pair of rows & converts it to full-range BT.601 blue & red chroma, the plain version of the downsample kernel
+void encodeChroma( const uint32_t *topRow, const uint32_t *bottomRow, uint8_t *blueChroma, uint8_t *redChroma, unsigned int count ) {
+
+	for ( unsigned int index = 0; index < count; index++ ) {
+		const uint32_t block[ 4 ] = { topRow[ index * 2 ], topRow[ index * 2 + 1 ], bottomRow[ index * 2 ], bottomRow[ index * 2 + 1 ] };
+		int redTotal = 0, greenTotal = 0, blueTotal = 0;
+
+		for ( uint32_t pixel : block ) {
+			redTotal += ( pixel >> 16 ) & 0xFF;
+			greenTotal += ( pixel >> 8 ) & 0xFF;
+			blueTotal += pixel & 0xFF;
+		}
+
+		// The weights of each chroma sum to zero, so adding 128 (plus rounding) keeps them positive before shifting, but pure blue or red would reach 256
+		int red = ( redTotal + 2 ) >> 2;
+		int green = ( greenTotal + 2 ) >> 2;
+		int blue = ( blueTotal + 2 ) >> 2;
+		int blueDifference = ( -43 * red - 85 * green + 128 * blue + 32896 ) >> 8;
+		int redDifference = ( 128 * red - 107 * green - 21 * blue + 32896 ) >> 8;
+		blueChroma[ index ] = ( uint8_t ) ( blueDifference > 255 ? 255 : blueDifference );
+		redChroma[ index ] = ( uint8_t ) ( redDifference > 255 ? 255 : redDifference );
+	}
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Dynamic arrays
+#include <vector>
+
+// The pixels being encoded
+#include "Framebuffer.h"
+
+// Appends a framebuffer as a QOI image (lossless, compresses about as well as PNG but many times faster)
+// https://qoiformat.org/qoi-specification.pdf
+void encodeQOI( const Framebuffer &, std::vector<uint8_t> & );
+
+// Appends the stream header & then each frame of a YUV4MPEG2 video (uncompressed 4:2:0, readable by FFmpeg & most players)
+// https://wiki.multimedia.cx/index.php/YUV4MPEG2
+void encodeY4MHeader( unsigned int, unsigned int, unsigned int, std::vector<uint8_t> & );
+void encodeY4MFrame( const Framebuffer &, std::vector<uint8_t> & );
+
+// Converting rows of pixels for YUV4MPEG2 frames, the plain versions of the convert & downsample kernels
+void encodeLuma( const uint32_t *, uint8_t *, unsigned int );
+void encodeChroma( const uint32_t *, const uint32_t *, uint8_t *, uint8_t *, unsigned int );
@@ -0,0 +1,410 @@
+#include "FixedRasterizer.h"
+
+// Floor, absolute values & square roots
+#include <cmath>
+
+// Min & max
+#include <algorithm>
+
+// Limits of integer types
+#include <climits>
+
+// The fastest coverage accumulation for the CPU
+#include "Kernels.h"
+
+// The furthest from the origin a coordinate can be (2,097,152 pixels), so a center plus a radius plus half a stroke still fits in 32 bits
+const int32_t FIXED_LIMIT = 1 << 29;
+
+// 4/3 * (sqrt(2) - 1) in 16.16, how far the control points of a quarter circle are from its ends as a fraction of the radius
+const int64_t FIXED_ELLIPSE_KAPPA = 36195;
+
+// The smallest whole number whose square is at least the value
+static int64_t ceilingSquareRoot( int64_t value ) {
+
+	// Square roots of doubles are correctly rounded everywhere, then any error from converting is corrected
+	int64_t root = ( int64_t ) std::sqrt( ( double ) value );
+	while ( root > 0 && ( root - 1 ) * ( root - 1 ) >= value ) root--;
+	while ( root * root < value ) root++;
+	return root;
+
+}
+
+// Converts pixels to 24.8 fixed point, rounding to the nearest subpixel
+// Multiplying by 256 is always exact, and so is adding a half below 2^23 (above it every float is already a whole number), so even x87 extended precision rounds the same
+int32_t fixedFromFloat( float value ) {
+
+	// NaNs would become whatever the conversion instruction returns for them
+	if ( std::isnan( value ) ) return 0;
+
+	float scaled = value * ( float ) FIXED_ONE;
+	if ( scaled <= ( float ) -FIXED_LIMIT ) return -FIXED_LIMIT;
+	if ( scaled >= ( float ) FIXED_LIMIT ) return FIXED_LIMIT;
+	if ( std::fabs( scaled ) >= 8388608.0f ) return ( int32_t ) scaled;
+
+	return ( int32_t ) std::floor( scaled + 0.5f );
+
+}
+
+// Clears every line & sets the drawing area size
+void FixedRasterizer::reset( unsigned int newWidth, unsigned int newHeight ) {
+
+	this->width = newWidth;
+	this->height = newHeight;
+	this->edges.clear();
+	this->minimumY = ( int32_t ) newHeight << FIXED_SHIFT;
+	this->maximumY = 0;
+
+	// The cells must always be zero between renders, so only reallocate them if the width changed
+	if ( this->cells.size() != ( size_t ) newWidth + 2 ) this->cells.assign( ( size_t ) newWidth + 2, 0 );
+	this->coverage.resize( ( size_t ) newWidth + 1 );
+
+}
+
+// Adds a line, lines crossing the left & right sides are clipped a row at a time when rendering
+void FixedRasterizer::addLine( FixedPoint start, FixedPoint end ) {
+
+	// Horizontal lines do not cross any rows, so they add no area
+	if ( start.y == end.y ) return;
+
+	// Lines entirely above or below the drawing area never cross a row
+	if ( std::max( start.y, end.y ) <= 0 || std::min( start.y, end.y ) >= ( int32_t ) this->height << FIXED_SHIFT ) return;
+
+	// Lines entirely to the left still cover everything to their right, so flatten them onto the left edge
+	if ( start.x <= 0 && end.x <= 0 ) {
+		start.x = 0;
+		end.x = 0;
+	}
+
+	// Lines entirely to the right only change the winding past the last pixel, so flatten them onto the right edge (the spare cell there is never output)
+	int32_t right = ( int32_t ) this->width << FIXED_SHIFT;
+	if ( start.x >= right && end.x >= right ) {
+		start.x = right;
+		end.x = right;
+	}
+
+	// Store every edge going downwards, remembering which way it really went
+	Edge edge;
+	if ( start.y < end.y ) {
+		edge = { start.x, start.y, end.x, end.y, 1 };
+	} else {
+		edge = { end.x, end.y, start.x, start.y, -1 };
+	}
+
+	this->edges.push_back( edge );
+	this->minimumY = std::min( this->minimumY, edge.topY );
+	this->maximumY = std::max( this->maximumY, edge.bottomY );
+
+}
+
+// Adds a closed polygon through every given point, in the opposite direction if it is reversed (to cut a hole with the non-zero rule)
+void FixedRasterizer::addPolygon( const FixedPoint *points, unsigned int count, bool isReversed ) {
+
+	if ( count < 2 ) return;
+
+	for ( unsigned int index = 0; index < count; index++ ) {
+		const FixedPoint &start = points[ index ];
+		const FixedPoint &end = points[ index + 1 < count ? index + 1 : 0 ];
+
+		if ( isReversed ) this->addLine( end, start );
+		else this->addLine( start, end );
+	}
+
+}
+
+// Adds a rectangle, clockwise unless it is reversed
+void FixedRasterizer::addRectangle( int32_t left, int32_t top, int32_t right, int32_t bottom, bool isReversed ) {
+
+	FixedPoint corners[ 4 ] = { { left, top }, { right, top }, { right, bottom }, { left, bottom } };
+	this->addPolygon( corners, 4, isReversed );
+
+}
+
+// Adds an ellipse made of four cubic Bezier curves, clockwise unless it is reversed
+// Each curve is flattened into enough lines to stay within the tolerance, and every point is the exact curve rounded to the nearest subpixel
+void FixedRasterizer::addEllipse( FixedPoint center, int32_t radiusX, int32_t radiusY, int32_t tolerance, bool isReversed ) {
+
+	if ( radiusX <= 0 || radiusY <= 0 ) return;
+
+	int64_t controlX = ( ( int64_t ) radiusX * FIXED_ELLIPSE_KAPPA + 32768 ) >> 16;
+	int64_t controlY = ( ( int64_t ) radiusY * FIXED_ELLIPSE_KAPPA + 32768 ) >> 16;
+	int64_t centerX = center.x;
+	int64_t centerY = center.y;
+
+	// Starting from the right, going through the bottom, left & top
+	const int64_t curves[ 4 ][ 8 ] = {
+		{ centerX + radiusX, centerY, centerX + radiusX, centerY + controlY, centerX + controlX, centerY + radiusY, centerX, centerY + radiusY },
+		{ centerX, centerY + radiusY, centerX - controlX, centerY + radiusY, centerX - radiusX, centerY + controlY, centerX - radiusX, centerY },
+		{ centerX - radiusX, centerY, centerX - radiusX, centerY - controlY, centerX - controlX, centerY - radiusY, centerX, centerY - radiusY },
+		{ centerX, centerY - radiusY, centerX + controlX, centerY - radiusY, centerX + radiusX, centerY - controlY, centerX + radiusX, centerY }
+	};
+
+	// Every quarter is the same shape, so the number of lines comes from the first one's second differences: lines = sqrt(3/4 * difference / tolerance)
+	int64_t difference = 0;
+	for ( unsigned int axis = 0; axis < 2; axis++ ) {
+		difference = std::max( difference, std::abs( curves[ 0 ][ axis ] - 2 * curves[ 0 ][ 2 + axis ] + curves[ 0 ][ 4 + axis ] ) );
+		difference = std::max( difference, std::abs( curves[ 0 ][ 2 + axis ] - 2 * curves[ 0 ][ 4 + axis ] + curves[ 0 ][ 6 + axis ] ) );
+	}
+
+	int64_t lineTolerance = 4 * std::max( tolerance, 1 );
+	int64_t segmentCount = std::clamp( ceilingSquareRoot( ( 3 * difference + lineTolerance - 1 ) / lineTolerance ), ( int64_t ) 1, ( int64_t ) FIXED_MAXIMUM_CURVE_SEGMENTS );
+	int64_t segmentCubed = segmentCount * segmentCount * segmentCount;
+
+	// Evaluate the Bernstein polynomials with whole-number weights, the point at the end of each curve is the start of the next
+	this->curvePoints.clear();
+	for ( const int64_t *curve : curves ) {
+		for ( int64_t step = 0; step < segmentCount; step++ ) {
+			int64_t remaining = segmentCount - step;
+			int64_t weights[ 4 ] = { remaining * remaining * remaining, 3 * remaining * remaining * step, 3 * remaining * step * step, step * step * step };
+
+			int64_t x = segmentCubed / 2;
+			int64_t y = segmentCubed / 2;
+			for ( unsigned int control = 0; control < 4; control++ ) {
+				x += weights[ control ] * curve[ control * 2 ];
+				y += weights[ control ] * curve[ control * 2 + 1 ];
+			}
+
+			this->curvePoints.push_back( { ( int32_t ) fixedFloorDivide( x, segmentCubed ), ( int32_t ) fixedFloorDivide( y, segmentCubed ) } );
+		}
+	}
+
+	this->addPolygon( this->curvePoints.data(), ( unsigned int ) this->curvePoints.size(), isReversed );
+
+}
+
+// Have any lines been added since the last reset?
+bool FixedRasterizer::isEmpty() const {
+	return this->edges.empty();
+}
+
+// Adds the area covered by part of a line within a single row, given its X at the top & bottom of that part, its height in subpixels, and its direction
+// The line is walked from left to right across the columns, the height of the part within each column is the exact share of its height rounded down
+void FixedRasterizer::accumulateLine( int32_t topX, int32_t bottomX, int32_t lineHeight, int32_t direction, unsigned int &minimumCell, unsigned int &maximumCell ) {
+
+	int32_t *row = this->cells.data();
+	int32_t right = ( int32_t ) this->width << FIXED_SHIFT;
+	int32_t leftX = std::min( topX, bottomX );
+	int32_t rightX = std::max( topX, bottomX );
+	int32_t signedHeight = lineHeight * direction;
+
+	// Entirely to the left, so it covers the whole of every pixel on the row
+	if ( rightX <= 0 ) {
+		row[ 0 ] += signedHeight * FIXED_ONE * 2;
+		minimumCell = 0;
+		return;
+	}
+
+	// Entirely to the right, so its winding goes in the spare cell past the last pixel
+	if ( leftX >= right ) {
+		row[ this->width ] += signedHeight * FIXED_ONE * 2;
+		minimumCell = std::min( minimumCell, this->width );
+		maximumCell = std::max( maximumCell, this->width );
+		return;
+	}
+
+	// Vertical, so its area is split between its column & the next by where it is within the column
+	if ( leftX == rightX ) {
+		unsigned int cell = ( unsigned int ) ( leftX >> FIXED_SHIFT );
+		int32_t offset = ( leftX & ( FIXED_ONE - 1 ) ) * 2;
+		row[ cell ] += signedHeight * ( FIXED_ONE * 2 - offset );
+		row[ cell + 1 ] += signedHeight * offset;
+
+		minimumCell = std::min( minimumCell, cell );
+		maximumCell = std::max( maximumCell, cell + 1 );
+		return;
+	}
+
+	// The height of the line left of a position is (position - leftX) * height / width, rounded down so the shares always add up to the whole height
+	// Nearly every line is narrow enough for the products to fit in 32 bits, where dividing is several times faster (and gives exactly the same result)
+	uint32_t lineWidth = ( uint32_t ) ( rightX - leftX );
+	bool isNarrow = lineWidth <= ( uint32_t ) INT32_MAX / FIXED_ONE;
+	auto heightBefore = [ leftX, lineHeight, lineWidth, isNarrow ]( int32_t x ) -> int32_t {
+		if ( isNarrow ) return ( int32_t ) ( ( uint32_t ) ( x - leftX ) * ( uint32_t ) lineHeight / lineWidth );
+		return ( int32_t ) ( ( uint64_t ) ( uint32_t ) ( x - leftX ) * ( uint32_t ) lineHeight / lineWidth );
+	};
+
+	// The part left of the drawing area covers the whole row, like a line on the left edge
+	int32_t startX = leftX;
+	if ( leftX < 0 ) {
+		row[ 0 ] += heightBefore( 0 ) * direction * FIXED_ONE * 2;
+		startX = 0;
+	}
+
+	// The part right of the drawing area goes in the spare cell past the last pixel, like a line on the right edge
+	int32_t endX = std::min( rightX, right );
+	if ( rightX > right ) row[ this->width ] += ( lineHeight - heightBefore( right ) ) * direction * FIXED_ONE * 2;
+
+	unsigned int firstCell = ( unsigned int ) ( startX >> FIXED_SHIFT );
+	unsigned int lastCell = ( unsigned int ) ( ( endX - 1 ) >> FIXED_SHIFT );
+
+	// Adds the part of the line within a cell, between two positions within it
+	auto addPart = [ row, direction ]( unsigned int cell, int32_t partLeft, int32_t partRight, int32_t partHeight ) {
+		int32_t cellLeft = ( int32_t ) cell << FIXED_SHIFT;
+		int32_t offsets = ( partLeft - cellLeft ) + ( partRight - cellLeft );
+		row[ cell ] += partHeight * direction * ( FIXED_ONE * 2 - offsets );
+		row[ cell + 1 ] += partHeight * direction * offsets;
+	};
+
+	int32_t startHeight = heightBefore( startX );
+	if ( firstCell == lastCell ) {
+		addPart( firstCell, startX, endX, heightBefore( endX ) - startHeight );
+	} else {
+
+		// The first column, then every whole column using the same step & remainder (exactly the same as dividing at each one), then the last column
+		int32_t boundary = ( int32_t ) ( firstCell + 1 ) << FIXED_SHIFT;
+		int32_t heightSoFar = heightBefore( boundary );
+		uint64_t remainder = ( uint64_t ) ( uint32_t ) ( boundary - leftX ) * ( uint32_t ) lineHeight - ( uint64_t ) heightSoFar * lineWidth;
+		addPart( firstCell, startX, boundary, heightSoFar - startHeight );
+
+		uint32_t step = ( uint32_t ) ( FIXED_ONE * lineHeight );
+		int32_t stepHeight = ( int32_t ) ( step / lineWidth );
+		uint64_t stepRemainder = step % lineWidth;
+
+		for ( unsigned int cell = firstCell + 1; cell < lastCell; cell++ ) {
+			int32_t partHeight = stepHeight;
+			remainder += stepRemainder;
+			if ( remainder >= lineWidth ) {
+				partHeight++;
+				remainder -= lineWidth;
+			}
+
+			heightSoFar += partHeight;
+			row[ cell ] += partHeight * direction * FIXED_ONE;
+			row[ cell + 1 ] += partHeight * direction * FIXED_ONE;
+		}
+
+		addPart( lastCell, ( int32_t ) lastCell << FIXED_SHIFT, endX, heightBefore( endX ) - heightSoFar );
+
+	}
+
+	minimumCell = std::min( minimumCell, leftX < 0 ? 0u : firstCell );
+	maximumCell = std::max( maximumCell, lastCell + 1 );
+
+}
+
+// Produces the coverage for every row touched by the lines, which are kept until the next reset
+void FixedRasterizer::render( FillRule fillRule, const RasterizerSpanCallback &spanCallback ) {
+
+	if ( this->edges.empty() || this->width == 0 ) return;
+
+	unsigned int firstRow = ( unsigned int ) ( std::max( this->minimumY, 0 ) >> FIXED_SHIFT );
+	unsigned int lastRow = std::min( this->height, ( unsigned int ) ( ( this->maximumY + FIXED_ONE - 1 ) >> FIXED_SHIFT ) );
+
+	// Edges are activated in order of the row they start on, so bucket them by that row
+	this->rowEdgeStarts.assign( ( size_t ) this->height + 1, 0 );
+	for ( const Edge &edge : this->edges ) {
+		unsigned int row = std::min( ( unsigned int ) ( std::max( edge.topY, 0 ) >> FIXED_SHIFT ), this->height - 1 );
+		this->rowEdgeStarts[ row + 1 ]++;
+	}
+
+	for ( unsigned int row = 0; row < this->height; row++ ) this->rowEdgeStarts[ row + 1 ] += this->rowEdgeStarts[ row ];
+
+	this->sortedEdges.resize( this->edges.size() );
+	for ( const Edge &edge : this->edges ) {
+		unsigned int row = std::min( ( unsigned int ) ( std::max( edge.topY, 0 ) >> FIXED_SHIFT ), this->height - 1 );
+		this->sortedEdges[ this->rowEdgeStarts[ row ]++ ] = edge;
+	}
+
+	// Placing each edge moved its row's start along to the next row's start, so shift them back
+	for ( unsigned int row = this->height; row > 0; row-- ) this->rowEdgeStarts[ row ] = this->rowEdgeStarts[ row - 1 ];
+	this->rowEdgeStarts[ 0 ] = 0;
+
+	this->activeEdges.clear();
+
+	for ( unsigned int row = firstRow; row < lastRow; row++ ) {
+		int32_t rowTop = ( int32_t ) row << FIXED_SHIFT;
+		int32_t rowBottom = rowTop + FIXED_ONE;
+
+		// Activate the edges that start on this row (the first row also gets every edge starting above the drawing area)
+		// Dividing is only needed here, every row after this steps down by exactly the same amounts, which is the same as dividing at every row
+		unsigned int bucketStart = row == firstRow ? 0 : this->rowEdgeStarts[ row ];
+		for ( unsigned int edgeIndex = bucketStart; edgeIndex < this->rowEdgeStarts[ row + 1 ]; edgeIndex++ ) {
+			const Edge &edge = this->sortedEdges[ edgeIndex ];
+			int64_t deltaX = ( int64_t ) edge.bottomX - edge.topX;
+			int64_t deltaY = ( int64_t ) edge.bottomY - edge.topY;
+
+			ActiveEdge active;
+			active.edge = edgeIndex;
+			active.topX = edge.topY < rowTop ? edge.topX + fixedFloorDivide( ( int64_t ) ( rowTop - edge.topY ) * deltaX, deltaY ) : edge.topX;
+
+			int64_t numerator = ( int64_t ) ( rowBottom - edge.topY ) * deltaX;
+			int64_t quotient = fixedFloorDivide( numerator, deltaY );
+			active.bottomX = edge.topX + quotient;
+			active.remainder = numerator - quotient * deltaY;
+
+			active.step = fixedFloorDivide( deltaX * FIXED_ONE, deltaY );
+			active.stepRemainder = deltaX * FIXED_ONE - active.step * deltaY;
+
+			this->activeEdges.push_back( active );
+		}
+
+		unsigned int minimumCell = UINT_MAX;
+		unsigned int maximumCell = 0;
+
+		// Add the area of the part of each active edge within this row, retiring the ones that ended above it
+		for ( size_t index = 0; index < this->activeEdges.size(); ) {
+			ActiveEdge &active = this->activeEdges[ index ];
+			const Edge &edge = this->sortedEdges[ active.edge ];
+
+			if ( edge.bottomY <= rowTop ) {
+				active = this->activeEdges.back();
+				this->activeEdges.pop_back();
+				continue;
+			}
+
+			// Where the edge starts or ends within the row its exact end is used, so joined edges meet at exactly the same X
+			int32_t top = std::max( rowTop, edge.topY );
+			int32_t bottom = std::min( rowBottom, edge.bottomY );
+			int32_t topX = top == edge.topY ? edge.topX : ( int32_t ) active.topX;
+			int32_t bottomX = bottom == edge.bottomY ? edge.bottomX : ( int32_t ) active.bottomX;
+
+			this->accumulateLine( topX, bottomX, bottom - top, edge.direction, minimumCell, maximumCell );
+
+			// Step down to the next row, the X only depends on the edge & the row, never on what else was drawn or where the tile is
+			active.topX = active.bottomX;
+			active.bottomX += active.step;
+			active.remainder += active.stepRemainder;
+			if ( active.remainder >= edge.bottomY - edge.topY ) {
+				active.bottomX++;
+				active.remainder -= edge.bottomY - edge.topY;
+			}
+
+			index++;
+		}
+
+		// Skip rows that nothing touched
+		if ( minimumCell == UINT_MAX ) continue;
+
+		// Lines right of the drawing area added their winding to the spare cell past the last pixel, so every pixel right of the last touched cell has the same winding as the left of the row, and is empty
+		if ( minimumCell < this->width ) {
+			unsigned int count = std::min( maximumCell, this->width - 1 ) - minimumCell + 1;
+			kernelTable.fixedCoverage( &this->cells[ minimumCell ], this->coverage.data(), count, fillRule );
+			spanCallback( row, minimumCell, count, this->coverage.data() );
+		}
+
+		// Leave the cells cleared for the next row
+		std::fill( this->cells.begin() + minimumCell, this->cells.begin() + maximumCell + 1, 0 );
+	}
+
+}
+
+// Turns a row of accumulated integer cell areas into 8-bit coverage, using the running sum across the row
+// With the non-zero rule the coverage is the absolute winding clamped to a whole pixel, with even-odd it folds back down between every odd & even winding
+// Only whole numbers are added, multiplied & shifted, so every instruction set's version gives exactly the same bytes
+void accumulateFixedCoverage( const int32_t *cells, uint8_t *coverage, unsigned int count, FillRule fillRule ) {
+
+	int32_t sum = 0;
+	for ( unsigned int index = 0; index < count; index++ ) {
+		sum += cells[ index ];
+
+		uint32_t area = ( uint32_t ) std::abs( sum );
+		if ( fillRule == FillRule::NonZero ) {
+			area = std::min( area, ( uint32_t ) FIXED_CELL_AREA );
+		} else {
+			area &= FIXED_CELL_AREA * 2 - 1;
+			if ( area > ( uint32_t ) FIXED_CELL_AREA ) area = FIXED_CELL_AREA * 2 - area;
+		}
+
+		coverage[ index ] = ( uint8_t ) ( ( area * 255 + FIXED_CELL_AREA / 2 ) >> 17 );
+	}
+
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Dynamic arrays
+#include <vector>
+
+// Fill rules & the span callback
+#include "Rasterizer.h"
+
+// Fixed-point coordinates are 24.8: the number of subpixel steps across a pixel, and the shift between pixels & subpixels
+const int32_t FIXED_ONE = 256;
+const int FIXED_SHIFT = 8;
+
+// The area of a whole pixel in cell units: 256 subpixels tall, by twice 256 subpixels wide (the sum of a line's X at both ends of a cell, rather than their average)
+const int32_t FIXED_CELL_AREA = FIXED_ONE * FIXED_ONE * 2;
+
+// The most lines a quarter of an ellipse is flattened into
+const int32_t FIXED_MAXIMUM_CURVE_SEGMENTS = 256;
+
+// A position in 24.8 fixed point, where the top-left corner of the top-left pixel is the origin
+struct FixedPoint {
+	int32_t x;
+	int32_t y;
+};
+
+// Converts pixels to 24.8 fixed point, rounding to the nearest subpixel the same way on every compiler & instruction set
+int32_t fixedFromFloat( float );
+
+// Divides, rounding towards negative infinity rather than zero (which is what the division operator does)
+inline int64_t fixedFloorDivide( int64_t numerator, int64_t denominator ) {
+	int64_t quotient = numerator / denominator;
+	if ( ( numerator % denominator != 0 ) && ( ( numerator < 0 ) != ( denominator < 0 ) ) ) quotient--;
+	return quotient;
+}
+
+// The same as the rasterizer, but every coordinate, area & coverage is an integer, so its output is exactly the same on every compiler, instruction set & tile size
+// Each line adds the area it covers to the cells of a row in units of 1/131072 of a pixel, where a line crosses between columns its height is split with exact integer division
+class FixedRasterizer {
+
+	// Only usable by this class
+	private:
+
+		// A line going downwards, with the direction it originally went in
+		struct Edge {
+			int32_t topX;
+			int32_t topY;
+			int32_t bottomX;
+			int32_t bottomY;
+			int32_t direction; // +1 if the line went down, -1 if it went up
+		};
+
+		// The size of the area being drawn to, anything outside is clipped
+		unsigned int width = 0;
+		unsigned int height = 0;
+
+		// Every line added since the last reset, and the vertical extent of them all
+		std::vector<Edge> edges;
+		int32_t minimumY = 0;
+		int32_t maximumY = 0;
+
+		// The edges ordered by the row they start on, and where each row's edges start within them
+		std::vector<Edge> sortedEdges;
+		std::vector<unsigned int> rowEdgeStarts;
+
+		// An edge crossing the current row, with its X at the top & bottom of the row, stepped down a row at a time by a whole part & a remainder
+		struct ActiveEdge {
+			unsigned int edge; // Index into the sorted edges
+			int64_t topX;
+			int64_t bottomX;
+			int64_t remainder; // Of the division that gave the bottom X, between 0 & the edge's height
+			int64_t step;
+			int64_t stepRemainder;
+		};
+
+		// The sorted edges crossing the current row
+		std::vector<ActiveEdge> activeEdges;
+
+		// Signed area added to each cell of the current row, with 2 extra cells for lines touching the right-hand side
+		std::vector<int32_t> cells;
+
+		// The coverage of each pixel on the current row
+		std::vector<uint8_t> coverage;
+
+		// Reused between curves to avoid allocating
+		std::vector<FixedPoint> curvePoints;
+
+		// Adds the area covered by part of a line within a single row
+		void accumulateLine( int32_t, int32_t, int32_t, int32_t, unsigned int &, unsigned int & );
+
+	// Usable by anyone
+	public:
+
+		// Clears every line & sets the drawing area size
+		void reset( unsigned int, unsigned int );
+
+		// Adding geometry
+		void addLine( FixedPoint, FixedPoint );
+		void addPolygon( const FixedPoint *, unsigned int, bool );
+		void addRectangle( int32_t, int32_t, int32_t, int32_t, bool );
+		void addEllipse( FixedPoint, int32_t, int32_t, int32_t, bool );
+
+		// Information
+		bool isEmpty() const;
+
+		// Produces the coverage for every row touched by the lines
+		void render( FillRule, const RasterizerSpanCallback & );
+
+};
+
+// Turns a row of accumulated integer cell areas into 8-bit coverage, the plain version of the fixed-point coverage kernel
+void accumulateFixedCoverage( const int32_t *, uint8_t *, unsigned int, FillRule );
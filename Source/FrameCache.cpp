@@ -0,0 +1,109 @@
+#include "FrameCache.h"
+
+// Copying rows of pixels
+#include <cstring>
+
+// Finding the least recently used frame
+#include <algorithm>
+
+// The memory a frame's pixels use
+static size_t getFrameBytes( unsigned int width, unsigned int height ) {
+	return ( size_t ) width * height * sizeof( uint32_t );
+}
+
+// Starts empty, with a budget in bytes
+FrameCache::FrameCache( size_t newBudget ) :
+	budget( newBudget ) {
+
+}
+
+// Changes the memory the frames may use, evicting the least recently used until the rest fit
+void FrameCache::setBudget( size_t newBudget ) {
+
+	this->budget = newBudget;
+	this->evict( 0 );
+
+}
+
+// Evicts the least recently used frames until the cached frames plus some more bytes fit within the budget
+void FrameCache::evict( size_t extraBytes ) {
+
+	while ( !this->entries.empty() && this->statistics.bytes + extraBytes > this->budget ) {
+		std::vector<Entry>::iterator oldest = std::min_element( this->entries.begin(), this->entries.end(), []( const Entry &first, const Entry &second ) {
+			return first.lastUsed < second.lastUsed;
+		} );
+
+		this->statistics.bytes -= getFrameBytes( oldest->frame.width, oldest->frame.height );
+		this->statistics.evictedCount++;
+		this->entries.erase( oldest );
+	}
+
+}
+
+// Finds the frame drawn from a display list with a hash at a size, NULL if it is not cached
+// The frame is only valid until the next store(), setBudget() or clear()
+const Framebuffer *FrameCache::find( uint64_t hash, unsigned int width, unsigned int height ) {
+
+	this->statistics.lookupCount++;
+
+	for ( Entry &entry : this->entries ) {
+		if ( entry.hash != hash || entry.frame.width != width || entry.frame.height != height ) continue;
+
+		entry.lastUsed = ++this->useCounter;
+		this->statistics.hitCount++;
+		return &entry.frame;
+	}
+
+	return NULL;
+
+}
+
+// Keeps a copy of a frame drawn from a display list with a hash, evicting the least recently used frames to make room
+void FrameCache::store( uint64_t hash, const Framebuffer &frame ) {
+
+	// Do not store the same frame twice, just mark it as used
+	for ( Entry &entry : this->entries ) {
+		if ( entry.hash == hash && entry.frame.width == frame.width && entry.frame.height == frame.height ) {
+			entry.lastUsed = ++this->useCounter;
+			return;
+		}
+	}
+
+	// Do not continue if the frame could never fit, rather than evicting everything for it
+	size_t frameBytes = getFrameBytes( frame.width, frame.height );
+	if ( frameBytes > this->budget || frameBytes == 0 ) {
+		this->statistics.rejectedCount++;
+		return;
+	}
+
+	this->evict( frameBytes );
+
+	// Copy it row by row, as the frame may be in shared memory with a stride wider than it
+	Entry entry;
+	entry.hash = hash;
+	entry.lastUsed = ++this->useCounter;
+	framebufferAllocate( entry.frame, frame.width, frame.height );
+	for ( unsigned int row = 0; row < frame.height; row++ ) {
+		std::memcpy( entry.frame.pixels + ( size_t ) row * entry.frame.stride, frame.pixels + ( size_t ) row * frame.stride, frame.width * sizeof( uint32_t ) );
+	}
+
+	this->entries.push_back( std::move( entry ) );
+
+	this->statistics.storedCount++;
+	this->statistics.bytes += frameBytes;
+	this->statistics.peakBytes = std::max( this->statistics.peakBytes, this->statistics.bytes );
+
+}
+
+// Removes every frame, such as when whatever the display lists do not capture has changed
+void FrameCache::clear() {
+
+	this->entries.clear();
+	this->statistics.bytes = 0;
+
+}
+
+// Gets a copy of the statistics so far
+FrameCacheStatistics FrameCache::getStatistics() const {
+	return this->statistics;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Sizes
+#include <cstddef>
+
+// The cached frames
+#include <vector>
+
+// The pixels being cached
+#include "Framebuffer.h"
+
+// The default memory the cached frames may use, enough for a handful of frames at 1080p
+const size_t FRAME_CACHE_DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+// How well the frame cache is working, counted since it was created
+struct FrameCacheStatistics {
+	unsigned long long lookupCount = 0;
+	unsigned long long hitCount = 0; // Frames presented from the cache without drawing anything
+	unsigned long long storedCount = 0;
+	unsigned long long evictedCount = 0; // Frames removed to stay within the budget, the least recently used first
+	unsigned long long rejectedCount = 0; // Frames bigger than the whole budget, which are never stored
+	size_t bytes = 0; // Memory used by the cached frames right now
+	size_t peakBytes = 0;
+};
+
+// Keeps frames that were drawn recently, identified by the hash of their display list & their size, so drawing exactly the same frame again (such as after an expose, restore or resizing back) can copy it instead
+// Only whole frames are cached, and the least recently used are evicted once their pixels would use more memory than the budget
+class FrameCache {
+
+	// Only usable by this class
+	private:
+
+		// A cached frame, and the lookup or store that last used it
+		struct Entry {
+			uint64_t hash;
+			Framebuffer frame;
+			unsigned long long lastUsed;
+		};
+
+		// There are only ever a few frames within the budget, so they are searched in order
+		std::vector<Entry> entries;
+		size_t budget;
+		unsigned long long useCounter = 0;
+
+		FrameCacheStatistics statistics;
+
+		// Evicts the least recently used frames until some more bytes would fit within the budget
+		void evict( size_t );
+
+	// Usable by anyone
+	public:
+
+		// Constructor
+		FrameCache( size_t = FRAME_CACHE_DEFAULT_BUDGET );
+
+		// Changing the memory the frames may use, evicting any that no longer fit
+		void setBudget( size_t );
+
+		// Finding & storing frames by the hash of their display list
+		const Framebuffer *find( uint64_t, unsigned int, unsigned int );
+		void store( uint64_t, const Framebuffer & );
+		void clear();
+
+		// Telemetry
+		FrameCacheStatistics getStatistics() const;
+
+};
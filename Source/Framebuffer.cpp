@@ -0,0 +1,125 @@
+#include "Framebuffer.h"
+
+// FNV-1a constants
+#include "Hash.h"
+
+// Allocates pixels owned by the framebuffer, cleared to transparent black
+void framebufferAllocate( Framebuffer &framebuffer, unsigned int width, unsigned int height ) {
+
+	// Reuse the existing allocation where possible
+	framebuffer.storage.assign( ( size_t ) width * height, 0 );
+
+	// Point at our own storage, rows are tightly packed
+	framebuffer.pixels = framebuffer.storage.empty() ? NULL : framebuffer.storage.data();
+	framebuffer.width = width;
+	framebuffer.height = height;
+	framebuffer.stride = width;
+
+}
+
+// Points the framebuffer at pixels owned by someone else (shared memory, a locked bitmap, etc.)
+void framebufferWrap( Framebuffer &framebuffer, uint32_t *pixels, unsigned int width, unsigned int height, unsigned int stride ) {
+
+	// Release any storage we previously owned
+	framebuffer.storage.clear();
+	framebuffer.storage.shrink_to_fit();
+
+	framebuffer.pixels = pixels;
+	framebuffer.width = width;
+	framebuffer.height = height;
+	framebuffer.stride = stride;
+
+}
+
+// A 64-bit FNV-1a hash of the size & every pixel (but not the padding at the end of rows), equal frames always have equal hashes
+uint64_t framebufferHash( const Framebuffer &framebuffer ) {
+
+	uint64_t hash = HASH_OFFSET_BASIS;
+	hash = ( hash ^ framebuffer.width ) * HASH_PRIME;
+	hash = ( hash ^ framebuffer.height ) * HASH_PRIME;
+
+	// A whole pixel at a time rather than a byte, which is four times fewer multiplies
+	for ( unsigned int row = 0; row < framebuffer.height; row++ ) {
+		const uint32_t *pixels = framebuffer.pixels + ( size_t ) row * framebuffer.stride;
+		for ( unsigned int column = 0; column < framebuffer.width; column++ ) hash = ( hash ^ pixels[ column ] ) * HASH_PRIME;
+	}
+
+	return hash;
+
+}
+
+// Packs a straight-alpha color with channels between 0 and 1 into a premultiplied pixel
+uint32_t colorFromFloats( float red, float green, float blue, float alpha ) {
+
+	// Clamp each channel, then premultiply the color channels by the alpha
+	auto toByte = []( float value ) -> uint32_t {
+		if ( value <= 0.0f ) return 0;
+		if ( value >= 1.0f ) return 255;
+		return ( uint32_t ) ( value * 255.0f + 0.5f );
+	};
+
+	uint32_t alphaByte = toByte( alpha );
+	return ( alphaByte << 24 ) | ( toByte( red * alpha ) << 16 ) | ( toByte( green * alpha ) << 8 ) | toByte( blue * alpha );
+
+}
+
+// Packs a straight-alpha color with 8-bit channels into a premultiplied pixel
+uint32_t colorFromBytes( uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha ) {
+
+	// Opaque colors do not need premultiplying
+	if ( alpha == 255 ) return 0xFF000000 | ( red << 16 ) | ( green << 8 ) | blue;
+
+	uint32_t scale = coverageToScale( alpha );
+	return ( ( uint32_t ) alpha << 24 ) | ( ( ( red * scale ) >> 8 ) << 16 ) | ( ( ( green * scale ) >> 8 ) << 8 ) | ( ( blue * scale ) >> 8 );
+
+}
+
+// Replaces a run of pixels with a single color
+void spanFill( uint32_t *destination, unsigned int count, uint32_t color ) {
+	for ( unsigned int index = 0; index < count; index++ ) destination[ index ] = color;
+}
+
+// Composites a single color over a run of pixels, weighted by per-pixel coverage
+void spanBlendSolid( uint32_t *destination, const uint8_t *coverage, unsigned int count, uint32_t color ) {
+
+	// Fully covered pixels of an opaque color can be stored without reading the destination
+	bool isOpaque = ( color >> 24 ) == 255;
+
+	for ( unsigned int index = 0; index < count; index++ ) {
+		uint8_t pixelCoverage = coverage[ index ];
+
+		if ( pixelCoverage == 0 ) continue;
+
+		if ( pixelCoverage == 255 && isOpaque ) {
+			destination[ index ] = color;
+		} else {
+			destination[ index ] = pixelOver( pixelScale( color, coverageToScale( pixelCoverage ) ), destination[ index ] );
+		}
+	}
+
+}
+
+// Composites a run of source pixels over a run of pixels, weighted by per-pixel coverage
+void spanBlend( uint32_t *destination, const uint32_t *source, const uint8_t *coverage, unsigned int count ) {
+
+	for ( unsigned int index = 0; index < count; index++ ) {
+		uint8_t pixelCoverage = coverage[ index ];
+
+		if ( pixelCoverage == 0 ) continue;
+
+		uint32_t sourcePixel = pixelCoverage == 255 ? source[ index ] : pixelScale( source[ index ], coverageToScale( pixelCoverage ) );
+		destination[ index ] = ( sourcePixel >> 24 ) == 255 ? sourcePixel : pixelOver( sourcePixel, destination[ index ] );
+	}
+
+}
+
+// Composites a run of source pixels over a run of pixels using only their own alpha, skipping the transparent & copying the opaque ones
+void spanBlendOver( uint32_t *destination, const uint32_t *source, unsigned int count ) {
+
+	for ( unsigned int index = 0; index < count; index++ ) {
+		uint32_t alpha = source[ index ] >> 24;
+		if ( alpha == 255 ) destination[ index ] = source[ index ];
+		else if ( alpha != 0 ) destination[ index ] = pixelOver( source[ index ], destination[ index ] );
+	}
+
+}
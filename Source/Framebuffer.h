@@ -0,0 +1,61 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// NULL
+#include <cstddef>
+
+// Dynamic arrays
+#include <vector>
+
+// A block of 32-bit premultiplied BGRA pixels (0xAARRGGBB in memory order B, G, R, A) that the software renderer draws into
+// This matches DXGI_FORMAT_B8G8R8A8_UNORM with premultiplied alpha, so it can be copied straight into a Direct2D bitmap
+struct Framebuffer {
+
+	// The first pixel of the top row, either points into the storage below or to memory owned by someone else
+	uint32_t *pixels = NULL;
+
+	// The size in pixels, and the distance between the start of each row in pixels
+	unsigned int width = 0;
+	unsigned int height = 0;
+	unsigned int stride = 0;
+
+	// Only used when the framebuffer owns its pixels
+	std::vector<uint32_t> storage;
+
+};
+
+// Creating framebuffers
+void framebufferAllocate( Framebuffer &, unsigned int, unsigned int );
+void framebufferWrap( Framebuffer &, uint32_t *, unsigned int, unsigned int, unsigned int );
+
+// Identifying frames by their pixels
+uint64_t framebufferHash( const Framebuffer & );
+
+// Packing colors
+uint32_t colorFromFloats( float, float, float, float );
+uint32_t colorFromBytes( uint8_t, uint8_t, uint8_t, uint8_t );
+
+// Multiplies every channel of a premultiplied pixel by a scale between 0 and 256
+inline uint32_t pixelScale( uint32_t pixel, uint32_t scale ) {
+	uint32_t redBlue = ( ( ( pixel & 0x00FF00FF ) * scale ) >> 8 ) & 0x00FF00FF;
+	uint32_t alphaGreen = ( ( ( pixel >> 8 ) & 0x00FF00FF ) * scale ) & 0xFF00FF00;
+	return redBlue | alphaGreen;
+}
+
+// Composites a premultiplied pixel over another (Porter-Duff source-over)
+inline uint32_t pixelOver( uint32_t source, uint32_t destination ) {
+	return source + pixelScale( destination, 256 - ( source >> 24 ) );
+}
+
+// Converts an 8-bit coverage value to a scale between 0 and 256
+inline uint32_t coverageToScale( uint8_t coverage ) {
+	return coverage + ( coverage >> 7 );
+}
+
+// Span operations used by the rasterizer & compositor, these are the plain versions of the kernels (draw with kernelTable, which has the fastest for the CPU)
+void spanFill( uint32_t *, unsigned int, uint32_t );
+void spanBlendSolid( uint32_t *, const uint8_t *, unsigned int, uint32_t );
+void spanBlend( uint32_t *, const uint32_t *, const uint8_t *, unsigned int );
+void spanBlendOver( uint32_t *, const uint32_t *, unsigned int );
@@ -0,0 +1,26 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Sizes
+#include <cstddef>
+
+// 64-bit FNV-1a, a simple hash that is the same on every platform: start with the offset basis, then for every byte xor it in & multiply by the prime
+const uint64_t HASH_OFFSET_BASIS = 0xCBF29CE484222325ULL;
+const uint64_t HASH_PRIME = 0x100000001B3ULL;
+
+// Adds bytes to a hash
+inline uint64_t hashBytes( uint64_t hash, const void *data, size_t size ) {
+
+	const uint8_t *bytes = ( const uint8_t * ) data;
+	for ( size_t index = 0; index < size; index++ ) hash = ( hash ^ bytes[ index ] ) * HASH_PRIME;
+	return hash;
+
+}
+
+// Adds the bytes of a value to a hash (only for types without padding, so every byte is part of the value)
+template <typename Value>
+inline uint64_t hashValue( uint64_t hash, const Value &value ) {
+	return hashBytes( hash, &value, sizeof( value ) );
+}
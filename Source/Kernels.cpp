@@ -0,0 +1,456 @@
+#include "Kernels.h"
+
+// The plain versions of every kernel
+#include "Framebuffer.h"
+#include "Canvas.h"
+#include "Rasterizer.h"
+#include "FixedRasterizer.h"
+#include "Encoder.h"
+
+// Reading the environment variable
+#include <cstdlib>
+
+// Formatting failures
+#include <cstdio>
+
+// Absolute values
+#include <cmath>
+
+// Comparing & copying results
+#include <cstring>
+
+// Min & max
+#include <algorithm>
+
+// The same spans every time the self-test runs
+#include "Random.h"
+
+// Reading the CPU's features
+#ifdef KERNELS_X86
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+// The names given to --kernels & the environment variable, in the same order as the levels
+const char *const KERNEL_LEVEL_NAMES[ KERNEL_LEVEL_COUNT ] = { "scalar", "sse2", "sse4.1", "avx2", "avx512" };
+
+// The self-test runs every span length up to this at each alignment, so the vector loops, their remainders & the plain tails are all covered
+const unsigned int KERNEL_TEST_MAXIMUM_LENGTH = 100;
+const unsigned int KERNEL_TEST_ALIGNMENTS = 4;
+
+// Pixels past the end of each span the self-test checks are left alone
+const unsigned int KERNEL_TEST_GUARD = 16;
+
+// The plain versions, which every CPU can run & every other version must match
+const KernelTable KERNELS_SCALAR = {
+	spanFill,
+	spanBlendSolid,
+	spanBlend,
+	spanBlendOver,
+	gradientFillSpan,
+	accumulateCoverage,
+	accumulateFixedCoverage,
+	encodeLuma,
+	encodeChroma
+};
+
+// The kernels everything draws with, and the instruction set they were bound for
+KernelTable kernelTable = KERNELS_SCALAR;
+KernelLevel kernelCurrentLevel = KernelLevel::Scalar;
+
+#ifdef KERNELS_X86
+
+// Reads a leaf of CPUID: EAX, EBX, ECX & EDX
+static void readCpuid( unsigned int leaf, unsigned int subleaf, unsigned int registers[ 4 ] ) {
+
+#ifdef _MSC_VER
+	int values[ 4 ];
+	__cpuidex( values, ( int ) leaf, ( int ) subleaf );
+	for ( unsigned int index = 0; index < 4; index++ ) registers[ index ] = ( unsigned int ) values[ index ];
+#else
+	__cpuid_count( leaf, subleaf, registers[ 0 ], registers[ 1 ], registers[ 2 ], registers[ 3 ] );
+#endif
+
+}
+
+// Which registers the operating system saves between threads, only readable once CPUID says XGETBV is enabled
+static uint64_t readEnabledRegisters() {
+
+#ifdef _MSC_VER
+	return _xgetbv( 0 );
+#else
+	uint32_t low, high;
+	__asm__( "xgetbv" : "=a"( low ), "=d"( high ) : "c"( 0 ) );
+	return ( ( uint64_t ) high << 32 ) | low;
+#endif
+
+}
+
+#endif
+
+// Asks the CPU what it supports, the AVX features also need the operating system to save their registers
+static CpuFeatures detectFeatures() {
+
+	CpuFeatures features;
+
+#ifdef KERNELS_X86
+	unsigned int registers[ 4 ];
+	readCpuid( 0, 0, registers );
+	unsigned int maximumLeaf = registers[ 0 ];
+	if ( maximumLeaf < 1 ) return features;
+
+	readCpuid( 1, 0, registers );
+	features.hasSSE2 = ( registers[ 3 ] & ( 1u << 26 ) ) != 0;
+	features.hasSSE41 = ( registers[ 2 ] & ( 1u << 19 ) ) != 0;
+	bool hasFMA = ( registers[ 2 ] & ( 1u << 12 ) ) != 0;
+	bool hasXGETBV = ( registers[ 2 ] & ( 1u << 27 ) ) != 0;
+	bool hasAVX = ( registers[ 2 ] & ( 1u << 28 ) ) != 0;
+
+	// XMM & YMM registers for AVX, plus the mask registers & the upper halves of the 32 ZMM registers for AVX-512
+	uint64_t enabledRegisters = hasXGETBV ? readEnabledRegisters() : 0;
+	bool isAVXEnabled = hasAVX && ( enabledRegisters & 0x06 ) == 0x06;
+	bool isAVX512Enabled = isAVXEnabled && ( enabledRegisters & 0xE0 ) == 0xE0;
+
+	features.hasFMA = isAVXEnabled && hasFMA;
+
+	if ( maximumLeaf >= 7 ) {
+		readCpuid( 7, 0, registers );
+		features.hasAVX2 = isAVXEnabled && ( registers[ 1 ] & ( 1u << 5 ) ) != 0;
+
+		bool hasFoundation = ( registers[ 1 ] & ( 1u << 16 ) ) != 0;
+		bool hasByteWord = ( registers[ 1 ] & ( 1u << 30 ) ) != 0;
+		bool hasVectorLength = ( registers[ 1 ] & ( 1u << 31 ) ) != 0;
+		features.hasAVX512 = isAVX512Enabled && hasFoundation && hasByteWord && hasVectorLength;
+	}
+#endif
+
+	return features;
+
+}
+
+// The CPU's features, detected the first time they are asked for
+const CpuFeatures &kernelsGetFeatures() {
+
+	static const CpuFeatures features = detectFeatures();
+	return features;
+
+}
+
+// Can the CPU run the kernels of an instruction set (and every one before it)?
+bool kernelsIsSupported( KernelLevel level ) {
+
+	const CpuFeatures &features = kernelsGetFeatures();
+	switch ( level ) {
+		case KernelLevel::Scalar: return true;
+		case KernelLevel::SSE2: return features.hasSSE2;
+		case KernelLevel::SSE41: return features.hasSSE2 && features.hasSSE41;
+		case KernelLevel::AVX2: return features.hasSSE2 && features.hasSSE41 && features.hasAVX2;
+		case KernelLevel::AVX512: return features.hasSSE2 && features.hasSSE41 && features.hasAVX2 && features.hasAVX512;
+	}
+
+	return false;
+
+}
+
+// The latest instruction set the CPU can run the kernels of
+KernelLevel kernelsGetBestLevel() {
+
+	KernelLevel best = KernelLevel::Scalar;
+	for ( unsigned int index = 0; index < KERNEL_LEVEL_COUNT; index++ ) {
+		if ( kernelsIsSupported( ( KernelLevel ) index ) ) best = ( KernelLevel ) index;
+	}
+
+	return best;
+
+}
+
+// The name of an instruction set, as given to --kernels
+const char *kernelsGetLevelName( KernelLevel level ) {
+	return KERNEL_LEVEL_NAMES[ ( unsigned int ) level ];
+}
+
+// Finds the instruction set with a name, returning false if there is none
+bool kernelsParseLevel( const std::string &name, KernelLevel &level ) {
+
+	for ( unsigned int index = 0; index < KERNEL_LEVEL_COUNT; index++ ) {
+		if ( name == KERNEL_LEVEL_NAMES[ index ] ) {
+			level = ( KernelLevel ) index;
+			return true;
+		}
+	}
+
+	return false;
+
+}
+
+// The value of the environment variable, or an empty string if it is not set
+static std::string getEnvironmentOverride() {
+
+#ifdef _MSC_VER
+	char *value = NULL;
+	size_t length = 0;
+	if ( _dupenv_s( &value, &length, KERNELS_ENVIRONMENT_VARIABLE ) != 0 || value == NULL ) return "";
+
+	std::string result = value;
+	std::free( value );
+	return result;
+#else
+	const char *value = std::getenv( KERNELS_ENVIRONMENT_VARIABLE );
+	return value != NULL ? value : "";
+#endif
+
+}
+
+// Binds the kernels of the best instruction set the CPU supports, or the one named by the option (or the environment variable, when there is no option)
+// Returns false with the reason if the name is unknown or the CPU cannot run it, leaving the best kernels bound
+bool kernelsSetup( const std::string &option, std::string &error ) {
+
+	kernelsSelect( kernelsGetBestLevel() );
+
+	std::string name = option.empty() ? getEnvironmentOverride() : option;
+	if ( name.empty() ) return true;
+
+	KernelLevel level;
+	if ( !kernelsParseLevel( name, level ) ) {
+		error = "Unknown kernels '" + name + "', expected scalar, sse2, sse4.1, avx2 or avx512";
+		return false;
+	}
+
+	if ( !kernelsIsSupported( level ) ) {
+		error = "This CPU cannot run the " + name + " kernels";
+		return false;
+	}
+
+	kernelsSelect( level );
+	return true;
+
+}
+
+// Binds the kernels of an instruction set, which must not be called while anything is drawing
+void kernelsSelect( KernelLevel level ) {
+
+	kernelTable = kernelsGetTable( level );
+	kernelCurrentLevel = level;
+
+}
+
+// The instruction set of the bound kernels
+KernelLevel kernelsGetLevel() {
+	return kernelCurrentLevel;
+}
+
+// The kernels of an instruction set, starting from the plain versions & replacing them with each instruction set's own up to that one
+KernelTable kernelsGetTable( KernelLevel level ) {
+
+	KernelTable table = KERNELS_SCALAR;
+
+#ifdef KERNELS_X86
+	if ( level >= KernelLevel::SSE2 ) kernelsAddSSE2( table );
+	if ( level >= KernelLevel::SSE41 ) kernelsAddSSE41( table );
+	if ( level >= KernelLevel::AVX2 ) kernelsAddAVX2( table );
+	if ( level >= KernelLevel::AVX512 ) kernelsAddAVX512( table );
+#endif
+
+	return table;
+
+}
+
+// A random premultiplied pixel, a third of them transparent or opaque so the kernels' shortcuts are covered too
+static uint32_t randomPixel( uint32_t &state ) {
+
+	uint32_t kind = randomNext( state ) % 6;
+	uint32_t alpha = kind == 0 ? 0 : ( kind == 1 ? 255 : randomNext( state ) & 0xFF );
+	uint32_t red = alpha == 0 ? 0 : randomNext( state ) % ( alpha + 1 );
+	uint32_t green = alpha == 0 ? 0 : randomNext( state ) % ( alpha + 1 );
+	uint32_t blue = alpha == 0 ? 0 : randomNext( state ) % ( alpha + 1 );
+	return ( alpha << 24 ) | ( red << 16 ) | ( green << 8 ) | blue;
+
+}
+
+// Random coverage in runs, like the rasterizer gives: empty & fully covered runs with partially covered pixels between them
+static void randomCoverage( uint32_t &state, uint8_t *coverage, unsigned int count ) {
+
+	unsigned int index = 0;
+	while ( index < count ) {
+		unsigned int runLength = 1 + randomNext( state ) % 12;
+		uint32_t kind = randomNext( state ) % 3;
+
+		for ( unsigned int run = 0; run < runLength && index < count; run++, index++ ) {
+			coverage[ index ] = kind == 0 ? 0 : ( kind == 1 ? 255 : ( uint8_t ) randomNext( state ) );
+		}
+	}
+
+}
+
+// Runs a check on spans of every length & alignment, recording the first that gives different results
+template <typename Check>
+static void checkKernel( KernelLevel level, const char *kernelName, std::vector<std::string> &failures, Check check ) {
+
+	uint32_t state = 12345u;
+	for ( unsigned int length = 0; length <= KERNEL_TEST_MAXIMUM_LENGTH; length++ ) {
+		for ( unsigned int offset = 0; offset < KERNEL_TEST_ALIGNMENTS; offset++ ) {
+			if ( check( length, offset, state ) ) continue;
+
+			char message[ 256 ];
+			std::snprintf( message, sizeof( message ), "The %s %s kernel differs from the plain version on a span of %u at offset %u", kernelsGetLevelName( level ), kernelName, length, offset );
+			failures.push_back( message );
+			return;
+		}
+	}
+
+}
+
+// Checks the kernels an instruction set has its own version of against the plain versions, on the same random spans
+// Everything must be exactly the same except float coverage, where adding several cells at once rounds differently & a pixel can be one step off
+static void checkLevel( KernelLevel level, std::vector<std::string> &failures ) {
+
+	const unsigned int size = KERNEL_TEST_MAXIMUM_LENGTH + KERNEL_TEST_ALIGNMENTS + KERNEL_TEST_GUARD;
+	KernelTable variant = kernelsGetTable( level );
+	KernelTable previous = kernelsGetTable( ( KernelLevel ) ( ( unsigned int ) level - 1 ) );
+
+	if ( variant.fill != previous.fill ) checkKernel( level, "fill", failures, [ & ]( unsigned int length, unsigned int offset, uint32_t &state ) {
+		uint32_t expected[ size ], actual[ size ];
+		for ( unsigned int index = 0; index < size; index++ ) expected[ index ] = actual[ index ] = randomNext( state );
+		uint32_t color = randomPixel( state );
+
+		KERNELS_SCALAR.fill( expected + offset, length, color );
+		variant.fill( actual + offset, length, color );
+		return std::memcmp( expected, actual, sizeof( expected ) ) == 0;
+	} );
+
+	if ( variant.blendSolid != previous.blendSolid ) checkKernel( level, "blend solid", failures, [ & ]( unsigned int length, unsigned int offset, uint32_t &state ) {
+		uint32_t expected[ size ], actual[ size ];
+		uint8_t coverage[ size ];
+		for ( unsigned int index = 0; index < size; index++ ) expected[ index ] = actual[ index ] = randomPixel( state );
+		randomCoverage( state, coverage, size );
+		uint32_t color = randomPixel( state );
+
+		KERNELS_SCALAR.blendSolid( expected + offset, coverage + offset, length, color );
+		variant.blendSolid( actual + offset, coverage + offset, length, color );
+		return std::memcmp( expected, actual, sizeof( expected ) ) == 0;
+	} );
+
+	if ( variant.blend != previous.blend ) checkKernel( level, "blend", failures, [ & ]( unsigned int length, unsigned int offset, uint32_t &state ) {
+		uint32_t expected[ size ], actual[ size ], source[ size ];
+		uint8_t coverage[ size ];
+		for ( unsigned int index = 0; index < size; index++ ) {
+			expected[ index ] = actual[ index ] = randomPixel( state );
+			source[ index ] = randomPixel( state );
+		}
+		randomCoverage( state, coverage, size );
+
+		KERNELS_SCALAR.blend( expected + offset, source + offset, coverage + offset, length );
+		variant.blend( actual + offset, source + offset, coverage + offset, length );
+		return std::memcmp( expected, actual, sizeof( expected ) ) == 0;
+	} );
+
+	if ( variant.blendOver != previous.blendOver ) checkKernel( level, "blend over", failures, [ & ]( unsigned int length, unsigned int offset, uint32_t &state ) {
+		uint32_t expected[ size ], actual[ size ], source[ size ];
+		for ( unsigned int index = 0; index < size; index++ ) {
+			expected[ index ] = actual[ index ] = randomPixel( state );
+			source[ index ] = randomPixel( state );
+		}
+
+		KERNELS_SCALAR.blendOver( expected + offset, source + offset, length );
+		variant.blendOver( actual + offset, source + offset, length );
+		return std::memcmp( expected, actual, sizeof( expected ) ) == 0;
+	} );
+
+	if ( variant.gradient != previous.gradient ) checkKernel( level, "gradient", failures, [ & ]( unsigned int length, unsigned int offset, uint32_t &state ) {
+		uint32_t table[ GRADIENT_TABLE_SIZE ];
+		for ( uint32_t &color : table ) color = randomPixel( state );
+
+		// Starting before, within & after the table, with steps from a wide gradient to one only a few pixels across (in either direction)
+		uint32_t expected[ size ], actual[ size ];
+		for ( unsigned int index = 0; index < size; index++ ) expected[ index ] = actual[ index ] = randomNext( state );
+		float position = ( float ) ( randomNext( state ) % 1024 ) - 384.0f + ( float ) ( randomNext( state ) % 256 ) / 256.0f;
+		float step = ( ( float ) ( randomNext( state ) % 4096 ) - 2048.0f ) / 256.0f;
+
+		KERNELS_SCALAR.gradient( expected + offset, table, position, step, length );
+		variant.gradient( actual + offset, table, position, step, length );
+		return std::memcmp( expected, actual, sizeof( expected ) ) == 0;
+	} );
+
+	if ( variant.coverage != previous.coverage ) checkKernel( level, "coverage", failures, [ & ]( unsigned int length, unsigned int offset, uint32_t &state ) {
+		float cells[ size ];
+		for ( float &cell : cells ) cell = randomNext( state ) % 4 == 0 ? ( ( float ) ( randomNext( state ) % 2048 ) - 1024.0f ) / 500.0f : 0.0f;
+
+		for ( FillRule fillRule : { FillRule::NonZero, FillRule::EvenOdd } ) {
+			uint8_t expected[ size ], actual[ size ];
+			std::memset( expected, 0xCD, sizeof( expected ) );
+			std::memset( actual, 0xCD, sizeof( actual ) );
+
+			KERNELS_SCALAR.coverage( cells + offset, expected + offset, length, fillRule );
+			variant.coverage( cells + offset, actual + offset, length, fillRule );
+			for ( unsigned int index = 0; index < size; index++ ) {
+				if ( std::abs( ( int ) expected[ index ] - ( int ) actual[ index ] ) > 1 ) return false;
+				if ( ( index < offset || index >= offset + length ) && expected[ index ] != actual[ index ] ) return false;
+			}
+		}
+
+		return true;
+	} );
+
+	if ( variant.fixedCoverage != previous.fixedCoverage ) checkKernel( level, "fixed-point coverage", failures, [ & ]( unsigned int length, unsigned int offset, uint32_t &state ) {
+		int32_t cells[ size ];
+		for ( int32_t &cell : cells ) cell = randomNext( state ) % 4 == 0 ? ( int32_t ) ( randomNext( state ) % ( FIXED_CELL_AREA * 4 ) ) - FIXED_CELL_AREA * 2 : 0;
+
+		for ( FillRule fillRule : { FillRule::NonZero, FillRule::EvenOdd } ) {
+			uint8_t expected[ size ], actual[ size ];
+			std::memset( expected, 0xCD, sizeof( expected ) );
+			std::memset( actual, 0xCD, sizeof( actual ) );
+
+			KERNELS_SCALAR.fixedCoverage( cells + offset, expected + offset, length, fillRule );
+			variant.fixedCoverage( cells + offset, actual + offset, length, fillRule );
+			if ( std::memcmp( expected, actual, sizeof( expected ) ) != 0 ) return false;
+		}
+
+		return true;
+	} );
+
+	if ( variant.convert != previous.convert ) checkKernel( level, "convert", failures, [ & ]( unsigned int length, unsigned int offset, uint32_t &state ) {
+		uint32_t pixels[ size ];
+		for ( uint32_t &pixel : pixels ) pixel = randomNext( state ) | ( randomNext( state ) << 24 );
+
+		uint8_t expected[ size ], actual[ size ];
+		std::memset( expected, 0xCD, sizeof( expected ) );
+		std::memset( actual, 0xCD, sizeof( actual ) );
+
+		KERNELS_SCALAR.convert( pixels + offset, expected + offset, length );
+		variant.convert( pixels + offset, actual + offset, length );
+		return std::memcmp( expected, actual, sizeof( expected ) ) == 0;
+	} );
+
+	// Each chroma sample covers two pixels, so the spans are half as long
+	if ( variant.downsample != previous.downsample ) checkKernel( level, "downsample", failures, [ & ]( unsigned int length, unsigned int offset, uint32_t &state ) {
+		uint32_t topRow[ size * 2 ], bottomRow[ size * 2 ];
+		for ( unsigned int index = 0; index < size * 2; index++ ) {
+			topRow[ index ] = randomNext( state ) | ( randomNext( state ) << 24 );
+			bottomRow[ index ] = randomNext( state ) | ( randomNext( state ) << 24 );
+		}
+
+		uint8_t expected[ size * 2 ], actual[ size * 2 ];
+		std::memset( expected, 0xCD, sizeof( expected ) );
+		std::memset( actual, 0xCD, sizeof( actual ) );
+
+		KERNELS_SCALAR.downsample( topRow + offset, bottomRow + offset, expected + offset, expected + size + offset, length / 2 );
+		variant.downsample( topRow + offset, bottomRow + offset, actual + offset, actual + size + offset, length / 2 );
+		return std::memcmp( expected, actual, sizeof( expected ) ) == 0;
+	} );
+
+}
+
+// Checks every instruction set's own kernels the CPU can run against the plain versions, returning a description of each that differed
+std::vector<std::string> kernelsSelfTest() {
+
+	std::vector<std::string> failures;
+	for ( unsigned int index = 1; index < KERNEL_LEVEL_COUNT; index++ ) {
+		if ( kernelsIsSupported( ( KernelLevel ) index ) ) checkLevel( ( KernelLevel ) index, failures );
+	}
+
+	return failures;
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Names & failure descriptions
+#include <string>
+#include <vector>
+
+// Fill rules
+#include "Path.h"
+
+// Only x86 & x64 have versions of the kernels for their instruction sets, everything else uses the plain versions
+#if defined( _M_X64 ) || defined( _M_IX86 ) || defined( __x86_64__ ) || defined( __i386__ )
+	#define KERNELS_X86
+#endif
+
+// Lets GCC & Clang compile a function for an instruction set the rest of the build does not assume, Visual C++ allows any intrinsic anywhere
+#if defined( __GNUC__ )
+	#define KERNEL_TARGET( instructionSets ) __attribute__( ( target( instructionSets ) ) )
+#else
+	#define KERNEL_TARGET( instructionSets )
+#endif
+
+// The environment variable that forces the kernels of an instruction set, when --kernels is not given
+const char KERNELS_ENVIRONMENT_VARIABLE[] = "GRAPHICS_KERNELS";
+
+// The instruction sets there are kernels for, each one includes everything before it
+enum class KernelLevel : uint8_t {
+	Scalar,
+	SSE2,
+	SSE41,
+	AVX2,
+	AVX512
+};
+
+const unsigned int KERNEL_LEVEL_COUNT = 5;
+
+// What the CPU (and the operating system, for the wider registers) supports, detected once
+struct CpuFeatures {
+	bool hasSSE2 = false;
+	bool hasSSE41 = false;
+	bool hasAVX2 = false;
+	bool hasFMA = false;
+	bool hasAVX512 = false; // Foundation, byte & word, and vector length extensions
+};
+
+// Every hot loop of the software renderer, as function pointers bound to the best version for the CPU
+struct KernelTable {
+
+	// Replaces a run of pixels with a single color
+	void ( *fill )( uint32_t *, unsigned int, uint32_t );
+
+	// Composites a color or a run of pixels over a run of pixels, weighted by per-pixel coverage, or a run of pixels with their own alpha only
+	void ( *blendSolid )( uint32_t *, const uint8_t *, unsigned int, uint32_t );
+	void ( *blend )( uint32_t *, const uint32_t *, const uint8_t *, unsigned int );
+	void ( *blendOver )( uint32_t *, const uint32_t *, unsigned int );
+
+	// Looks up a run of colors from a gradient table: the table, the position of the first pixel & how much it changes for each pixel after it
+	void ( *gradient )( uint32_t *, const uint32_t *, float, float, unsigned int );
+
+	// Turns a row of accumulated cell areas into 8-bit coverage, from the float & fixed-point rasterizers
+	void ( *coverage )( const float *, uint8_t *, unsigned int, FillRule );
+	void ( *fixedCoverage )( const int32_t *, uint8_t *, unsigned int, FillRule );
+
+	// Converts a row of pixels to luma, and a pair of rows to chroma averaged over each 2 x 2 block, for recording video
+	void ( *convert )( const uint32_t *, uint8_t *, unsigned int );
+	void ( *downsample )( const uint32_t *, const uint32_t *, uint8_t *, uint8_t *, unsigned int );
+
+};
+
+// The kernels everything draws with, the plain versions until kernelsSetup() or kernelsSelect() is called
+extern KernelTable kernelTable;
+
+// Detecting the CPU's features & which kernels it can run
+const CpuFeatures &kernelsGetFeatures();
+bool kernelsIsSupported( KernelLevel );
+KernelLevel kernelsGetBestLevel();
+
+// Names of the instruction sets, as given to --kernels & the environment variable
+const char *kernelsGetLevelName( KernelLevel );
+bool kernelsParseLevel( const std::string &, KernelLevel & );
+
+// Binding the kernels of an instruction set, falling back to earlier ones for kernels it has no version of
+bool kernelsSetup( const std::string &, std::string & );
+void kernelsSelect( KernelLevel );
+KernelLevel kernelsGetLevel();
+KernelTable kernelsGetTable( KernelLevel );
+
+// Checks every version the CPU can run gives the same results as the plain version, returning what did not
+std::vector<std::string> kernelsSelfTest();
+
+// Each instruction set's versions, replacing the kernels in a table they have a version of
+#ifdef KERNELS_X86
+	void kernelsAddSSE2( KernelTable & );
+	void kernelsAddSSE41( KernelTable & );
+	void kernelsAddAVX2( KernelTable & );
+	void kernelsAddAVX512( KernelTable & );
+#endif
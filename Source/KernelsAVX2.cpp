@@ -0,0 +1,346 @@
+#include "Kernels.h"
+
+#ifdef KERNELS_X86
+
+// The plain versions, for the pixels left over after the last whole vector
+#include "Framebuffer.h"
+#include "Canvas.h"
+#include "Encoder.h"
+
+// Fixed-point cell areas
+#include "FixedRasterizer.h"
+
+// Absolute values & rounding
+#include <cmath>
+
+// Min, max & clamp
+#include <algorithm>
+
+// Copying packed bytes
+#include <cstring>
+
+// AVX2 intrinsics
+#include <immintrin.h>
+
+// Multiplies every channel of eight pixels by a scale between 0 and 256 each, giving exactly what pixelScale() does
+// Unpacking works within each 128-bit half, so pixels 0, 1, 4 & 5 are in the low unpack & 2, 3, 6 & 7 in the high one, the scales unpack the same way
+KERNEL_TARGET( "avx2" ) static inline __m256i scalePixels( __m256i pixels, __m256i scales ) {
+
+	__m256i scaleWords = _mm256_or_si256( scales, _mm256_slli_epi32( scales, 16 ) );
+	__m256i zero = _mm256_setzero_si256();
+	__m256i low = _mm256_srli_epi16( _mm256_mullo_epi16( _mm256_unpacklo_epi8( pixels, zero ), _mm256_unpacklo_epi32( scaleWords, scaleWords ) ), 8 );
+	__m256i high = _mm256_srli_epi16( _mm256_mullo_epi16( _mm256_unpackhi_epi8( pixels, zero ), _mm256_unpackhi_epi32( scaleWords, scaleWords ) ), 8 );
+	return _mm256_packus_epi16( low, high );
+
+}
+
+// Composites eight premultiplied pixels over eight others, adding whole pixels like pixelOver()
+KERNEL_TARGET( "avx2" ) static inline __m256i over( __m256i source, __m256i destination ) {
+
+	__m256i inverseAlpha = _mm256_sub_epi32( _mm256_set1_epi32( 256 ), _mm256_srli_epi32( source, 24 ) );
+	return _mm256_add_epi32( source, scalePixels( destination, inverseAlpha ) );
+
+}
+
+// Eight coverage bytes as scales between 0 and 256, like coverageToScale()
+KERNEL_TARGET( "avx2" ) static inline __m256i coverageScales( const uint8_t *coverageBytes ) {
+
+	__m256i coverage = _mm256_cvtepu8_epi32( _mm_loadl_epi64( ( const __m128i * ) coverageBytes ) );
+	return _mm256_add_epi32( coverage, _mm256_srli_epi32( coverage, 7 ) );
+
+}
+
+// Eight pixels at a time
+KERNEL_TARGET( "avx2" ) static void fill( uint32_t *destination, unsigned int count, uint32_t color ) {
+
+	__m256i colors = _mm256_set1_epi32( ( int ) color );
+	unsigned int index = 0;
+	for ( ; index + 8 <= count; index += 8 ) _mm256_storeu_si256( ( __m256i * ) ( destination + index ), colors );
+	for ( ; index < count; index++ ) destination[ index ] = color;
+
+}
+
+// Eight pixels at a time, skipping uncovered ones & storing fully covered opaque ones
+KERNEL_TARGET( "avx2" ) static void blendSolid( uint32_t *destination, const uint8_t *coverage, unsigned int count, uint32_t color ) {
+
+	__m256i colors = _mm256_set1_epi32( ( int ) color );
+	bool isOpaque = ( color >> 24 ) == 255;
+	unsigned int index = 0;
+
+	for ( ; index + 8 <= count; index += 8 ) {
+		uint64_t packedCoverage;
+		std::memcpy( &packedCoverage, coverage + index, sizeof( packedCoverage ) );
+		if ( packedCoverage == 0 ) continue;
+
+		__m256i *pixels = ( __m256i * ) ( destination + index );
+		if ( packedCoverage == ~( uint64_t ) 0 && isOpaque ) {
+			_mm256_storeu_si256( pixels, colors );
+			continue;
+		}
+
+		_mm256_storeu_si256( pixels, over( scalePixels( colors, coverageScales( coverage + index ) ), _mm256_loadu_si256( pixels ) ) );
+	}
+
+	spanBlendSolid( destination + index, coverage + index, count - index, color );
+
+}
+
+// Eight pixels at a time, skipping uncovered ones
+KERNEL_TARGET( "avx2" ) static void blend( uint32_t *destination, const uint32_t *source, const uint8_t *coverage, unsigned int count ) {
+
+	unsigned int index = 0;
+	for ( ; index + 8 <= count; index += 8 ) {
+		uint64_t packedCoverage;
+		std::memcpy( &packedCoverage, coverage + index, sizeof( packedCoverage ) );
+		if ( packedCoverage == 0 ) continue;
+
+		__m256i sourcePixels = _mm256_loadu_si256( ( const __m256i * ) ( source + index ) );
+		__m256i *pixels = ( __m256i * ) ( destination + index );
+		_mm256_storeu_si256( pixels, over( scalePixels( sourcePixels, coverageScales( coverage + index ) ), _mm256_loadu_si256( pixels ) ) );
+	}
+
+	spanBlend( destination + index, source + index, coverage + index, count - index );
+
+}
+
+// Eight pixels at a time, skipping transparent runs & copying opaque ones, the rest are composited & transparent pixels put back
+KERNEL_TARGET( "avx2" ) static void blendOver( uint32_t *destination, const uint32_t *source, unsigned int count ) {
+
+	__m256i zero = _mm256_setzero_si256();
+	__m256i alphaMask = _mm256_set1_epi32( ( int ) 0xFF000000 );
+	unsigned int index = 0;
+
+	for ( ; index + 8 <= count; index += 8 ) {
+		__m256i sourcePixels = _mm256_loadu_si256( ( const __m256i * ) ( source + index ) );
+		if ( _mm256_testz_si256( sourcePixels, alphaMask ) ) continue;
+
+		__m256i *pixels = ( __m256i * ) ( destination + index );
+		if ( _mm256_testc_si256( sourcePixels, alphaMask ) ) {
+			_mm256_storeu_si256( pixels, sourcePixels );
+			continue;
+		}
+
+		__m256i destinationPixels = _mm256_loadu_si256( pixels );
+		__m256i isTransparent = _mm256_cmpeq_epi32( _mm256_and_si256( sourcePixels, alphaMask ), zero );
+		_mm256_storeu_si256( pixels, _mm256_blendv_epi8( over( sourcePixels, destinationPixels ), destinationPixels, isTransparent ) );
+	}
+
+	spanBlendOver( destination + index, source + index, count - index );
+
+}
+
+// Eight positions at a time, each from the first & its index like the plain version, looked up with a gather
+KERNEL_TARGET( "avx2" ) static void gradient( uint32_t *destination, const uint32_t *table, float position, float step, unsigned int count ) {
+
+	__m256 positions = _mm256_set1_ps( position );
+	__m256 steps = _mm256_set1_ps( step );
+	__m256 lastIndex = _mm256_set1_ps( ( float ) ( GRADIENT_TABLE_SIZE - 1 ) );
+	__m256 half = _mm256_set1_ps( 0.5f );
+	__m256i indices = _mm256_set_epi32( 7, 6, 5, 4, 3, 2, 1, 0 );
+	unsigned int index = 0;
+
+	for ( ; index + 8 <= count; index += 8 ) {
+		__m256 clamped = _mm256_min_ps( _mm256_max_ps( _mm256_add_ps( positions, _mm256_mul_ps( _mm256_cvtepi32_ps( indices ), steps ) ), _mm256_setzero_ps() ), lastIndex );
+		__m256i entries = _mm256_cvttps_epi32( _mm256_add_ps( clamped, half ) );
+		_mm256_storeu_si256( ( __m256i * ) ( destination + index ), _mm256_i32gather_epi32( ( const int * ) table, entries, 4 ) );
+		indices = _mm256_add_epi32( indices, _mm256_set1_epi32( 8 ) );
+	}
+
+	// Whatever is left, still from the first position so it rounds the same
+	for ( ; index < count; index++ ) {
+		float clamped = std::clamp( position + ( float ) index * step, 0.0f, ( float ) ( GRADIENT_TABLE_SIZE - 1 ) );
+		destination[ index ] = table[ ( unsigned int ) ( clamped + 0.5f ) ];
+	}
+
+}
+
+// A prefix sum of eight values: within each 128-bit half, then the low half's total added to the high half
+KERNEL_TARGET( "avx2" ) static inline __m256 prefixSum( __m256 value ) {
+
+	value = _mm256_add_ps( value, _mm256_castsi256_ps( _mm256_slli_si256( _mm256_castps_si256( value ), 4 ) ) );
+	value = _mm256_add_ps( value, _mm256_castsi256_ps( _mm256_slli_si256( _mm256_castps_si256( value ), 8 ) ) );
+	__m256 lowTotal = _mm256_permute2f128_ps( _mm256_permute_ps( value, _MM_SHUFFLE( 3, 3, 3, 3 ) ), value, 0x08 );
+	return _mm256_add_ps( value, lowTotal );
+
+}
+
+// Eight cells at a time, the same as the SSE2 version
+KERNEL_TARGET( "avx2" ) static void accumulate( const float *cells, uint8_t *coverage, unsigned int count, FillRule fillRule ) {
+
+	__m256 offset = _mm256_setzero_ps();
+	const __m256 absoluteMask = _mm256_castsi256_ps( _mm256_set1_epi32( 0x7FFFFFFF ) );
+	const __m256 one = _mm256_set1_ps( 1.0f );
+	const __m256 two = _mm256_set1_ps( 2.0f );
+	const __m256 half = _mm256_set1_ps( 0.5f );
+	const __m256 scale = _mm256_set1_ps( 255.0f );
+	unsigned int index = 0;
+
+	for ( ; index + 8 <= count; index += 8 ) {
+		__m256 value = _mm256_add_ps( prefixSum( _mm256_loadu_ps( cells + index ) ), offset );
+		__m256 last = _mm256_permute_ps( value, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+		offset = _mm256_permute2f128_ps( last, last, 0x11 );
+
+		__m256 winding = _mm256_and_ps( value, absoluteMask );
+		if ( fillRule == FillRule::NonZero ) {
+			winding = _mm256_min_ps( winding, one );
+		} else {
+			__m256 pairs = _mm256_cvtepi32_ps( _mm256_cvttps_epi32( _mm256_mul_ps( winding, half ) ) );
+			winding = _mm256_sub_ps( winding, _mm256_mul_ps( pairs, two ) );
+			winding = _mm256_min_ps( winding, _mm256_sub_ps( two, winding ) );
+		}
+
+		// Round to the nearest byte, packing leaves each half's four bytes at the bottom of that half
+		__m256i bytes = _mm256_cvtps_epi32( _mm256_mul_ps( winding, scale ) );
+		bytes = _mm256_packs_epi32( bytes, bytes );
+		bytes = _mm256_packus_epi16( bytes, bytes );
+		int packed[ 2 ] = { _mm_cvtsi128_si32( _mm256_castsi256_si128( bytes ) ), _mm_cvtsi128_si32( _mm256_extracti128_si256( bytes, 1 ) ) };
+		std::memcpy( coverage + index, packed, sizeof( packed ) );
+	}
+
+	// Whatever is left, rounding the same way as above
+	float sum = _mm_cvtss_f32( _mm256_castps256_ps128( offset ) );
+	for ( ; index < count; index++ ) {
+		sum += cells[ index ];
+
+		float winding = std::fabs( sum );
+		if ( fillRule == FillRule::NonZero ) {
+			winding = std::min( winding, 1.0f );
+		} else {
+			winding -= 2.0f * ( float ) ( int ) ( winding * 0.5f );
+			winding = std::min( winding, 2.0f - winding );
+		}
+
+		coverage[ index ] = ( uint8_t ) std::lrintf( winding * 255.0f );
+	}
+
+}
+
+// Eight cells at a time, the same as the SSE4.1 version
+KERNEL_TARGET( "avx2" ) static void accumulateFixed( const int32_t *cells, uint8_t *coverage, unsigned int count, FillRule fillRule ) {
+
+	__m256i offset = _mm256_setzero_si256();
+	const __m256i wholePixel = _mm256_set1_epi32( FIXED_CELL_AREA );
+	const __m256i twoPixels = _mm256_set1_epi32( FIXED_CELL_AREA * 2 );
+	const __m256i foldMask = _mm256_set1_epi32( FIXED_CELL_AREA * 2 - 1 );
+	const __m256i half = _mm256_set1_epi32( FIXED_CELL_AREA / 2 );
+	const __m256i scale = _mm256_set1_epi32( 255 );
+	unsigned int index = 0;
+
+	for ( ; index + 8 <= count; index += 8 ) {
+		__m256i value = _mm256_loadu_si256( ( const __m256i * ) ( cells + index ) );
+		value = _mm256_add_epi32( value, _mm256_slli_si256( value, 4 ) );
+		value = _mm256_add_epi32( value, _mm256_slli_si256( value, 8 ) );
+		value = _mm256_add_epi32( value, _mm256_permute2x128_si256( _mm256_shuffle_epi32( value, _MM_SHUFFLE( 3, 3, 3, 3 ) ), value, 0x08 ) );
+		value = _mm256_add_epi32( value, offset );
+		__m256i last = _mm256_shuffle_epi32( value, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+		offset = _mm256_permute2x128_si256( last, last, 0x11 );
+
+		__m256i area = _mm256_abs_epi32( value );
+		if ( fillRule == FillRule::NonZero ) {
+			area = _mm256_min_epi32( area, wholePixel );
+		} else {
+			area = _mm256_and_si256( area, foldMask );
+			area = _mm256_min_epi32( area, _mm256_sub_epi32( twoPixels, area ) );
+		}
+
+		__m256i bytes = _mm256_srli_epi32( _mm256_add_epi32( _mm256_mullo_epi32( area, scale ), half ), 17 );
+		bytes = _mm256_packs_epi32( bytes, bytes );
+		bytes = _mm256_packus_epi16( bytes, bytes );
+		int packed[ 2 ] = { _mm_cvtsi128_si32( _mm256_castsi256_si128( bytes ) ), _mm_cvtsi128_si32( _mm256_extracti128_si256( bytes, 1 ) ) };
+		std::memcpy( coverage + index, packed, sizeof( packed ) );
+	}
+
+	// Whatever is left, the same as the plain version
+	int32_t sum = _mm_cvtsi128_si32( _mm256_castsi256_si128( offset ) );
+	for ( ; index < count; index++ ) {
+		sum += cells[ index ];
+
+		uint32_t area = ( uint32_t ) std::abs( sum );
+		if ( fillRule == FillRule::NonZero ) {
+			area = std::min( area, ( uint32_t ) FIXED_CELL_AREA );
+		} else {
+			area &= FIXED_CELL_AREA * 2 - 1;
+			if ( area > ( uint32_t ) FIXED_CELL_AREA ) area = FIXED_CELL_AREA * 2 - area;
+		}
+
+		coverage[ index ] = ( uint8_t ) ( ( area * 255 + FIXED_CELL_AREA / 2 ) >> 17 );
+	}
+
+}
+
+// Eight pixels at a time, the same as the SSE2 version with the pairs added by a horizontal add (which keeps each half's pixels in order)
+KERNEL_TARGET( "avx2" ) static void convert( const uint32_t *pixels, uint8_t *luma, unsigned int count ) {
+
+	__m256i zero = _mm256_setzero_si256();
+	__m256i weights = _mm256_set_epi16( 0, 77, 150, 29, 0, 77, 150, 29, 0, 77, 150, 29, 0, 77, 150, 29 );
+	__m256i rounding = _mm256_set1_epi32( 128 );
+	unsigned int index = 0;
+
+	for ( ; index + 8 <= count; index += 8 ) {
+		__m256i pixelValues = _mm256_loadu_si256( ( const __m256i * ) ( pixels + index ) );
+		__m256i low = _mm256_madd_epi16( _mm256_unpacklo_epi8( pixelValues, zero ), weights );
+		__m256i high = _mm256_madd_epi16( _mm256_unpackhi_epi8( pixelValues, zero ), weights );
+		__m256i values = _mm256_srli_epi32( _mm256_add_epi32( _mm256_hadd_epi32( low, high ), rounding ), 8 );
+
+		values = _mm256_packs_epi32( values, values );
+		values = _mm256_packus_epi16( values, values );
+		int packed[ 2 ] = { _mm_cvtsi128_si32( _mm256_castsi256_si128( values ) ), _mm_cvtsi128_si32( _mm256_extracti128_si256( values, 1 ) ) };
+		std::memcpy( luma + index, packed, sizeof( packed ) );
+	}
+
+	encodeLuma( pixels + index, luma + index, count - index );
+
+}
+
+// Four blocks at a time: the low half of each row's eight pixels holds blocks 0 & 1, the high half blocks 2 & 3
+KERNEL_TARGET( "avx2" ) static void downsample( const uint32_t *topRow, const uint32_t *bottomRow, uint8_t *blueChroma, uint8_t *redChroma, unsigned int count ) {
+
+	__m256i zero = _mm256_setzero_si256();
+	__m256i blueWeights = _mm256_set_epi16( 0, -43, -85, 128, 0, -43, -85, 128, 0, -43, -85, 128, 0, -43, -85, 128 );
+	__m256i redWeights = _mm256_set_epi16( 0, 128, -107, -21, 0, 128, -107, -21, 0, 128, -107, -21, 0, 128, -107, -21 );
+	__m256i rounding = _mm256_set1_epi32( 32896 );
+
+	// Blue for the four blocks, then red
+	__m256i order = _mm256_set_epi32( 7, 6, 3, 2, 5, 4, 1, 0 );
+	unsigned int index = 0;
+
+	for ( ; index + 4 <= count; index += 4 ) {
+		__m256i top = _mm256_loadu_si256( ( const __m256i * ) ( topRow + index * 2 ) );
+		__m256i bottom = _mm256_loadu_si256( ( const __m256i * ) ( bottomRow + index * 2 ) );
+		__m256i low = _mm256_add_epi16( _mm256_unpacklo_epi8( top, zero ), _mm256_unpacklo_epi8( bottom, zero ) );
+		__m256i high = _mm256_add_epi16( _mm256_unpackhi_epi8( top, zero ), _mm256_unpackhi_epi8( bottom, zero ) );
+
+		__m256i totals = _mm256_unpacklo_epi64( _mm256_add_epi16( low, _mm256_srli_si256( low, 8 ) ), _mm256_add_epi16( high, _mm256_srli_si256( high, 8 ) ) );
+		__m256i averages = _mm256_srli_epi16( _mm256_add_epi16( totals, _mm256_set1_epi16( 2 ) ), 2 );
+
+		// Each half gives blue & red for its two blocks, put in order then shifted & saturated to bytes
+		__m256i chroma = _mm256_hadd_epi32( _mm256_madd_epi16( averages, blueWeights ), _mm256_madd_epi16( averages, redWeights ) );
+		chroma = _mm256_srai_epi32( _mm256_add_epi32( _mm256_permutevar8x32_epi32( chroma, order ), rounding ), 8 );
+		chroma = _mm256_packus_epi16( _mm256_packs_epi32( chroma, chroma ), zero );
+
+		int packedBlue = _mm_cvtsi128_si32( _mm256_castsi256_si128( chroma ) );
+		int packedRed = _mm_cvtsi128_si32( _mm256_extracti128_si256( chroma, 1 ) );
+		std::memcpy( blueChroma + index, &packedBlue, sizeof( packedBlue ) );
+		std::memcpy( redChroma + index, &packedRed, sizeof( packedRed ) );
+	}
+
+	encodeChroma( topRow + index * 2, bottomRow + index * 2, blueChroma + index, redChroma + index, count - index );
+
+}
+
+// Replaces every kernel there is an AVX2 version of
+void kernelsAddAVX2( KernelTable &table ) {
+
+	table.fill = fill;
+	table.blendSolid = blendSolid;
+	table.blend = blend;
+	table.blendOver = blendOver;
+	table.gradient = gradient;
+	table.coverage = accumulate;
+	table.fixedCoverage = accumulateFixed;
+	table.convert = convert;
+	table.downsample = downsample;
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+#include "Kernels.h"
+
+#ifdef KERNELS_X86
+
+// The size of gradient tables
+#include "Canvas.h"
+
+// AVX-512 intrinsics
+#include <immintrin.h>
+
+// Every function here needs the foundation, byte & word, and vector length extensions
+#define AVX512_TARGET KERNEL_TARGET( "avx512f,avx512bw,avx512vl" )
+
+// Multiplies every channel of sixteen pixels by a scale between 0 and 256 each, giving exactly what pixelScale() does
+// Unpacking works within each 128-bit quarter, the same way for the pixels & the scales
+AVX512_TARGET static inline __m512i scalePixels( __m512i pixels, __m512i scales ) {
+
+	__m512i scaleWords = _mm512_or_si512( scales, _mm512_slli_epi32( scales, 16 ) );
+	__m512i zero = _mm512_setzero_si512();
+	__m512i low = _mm512_srli_epi16( _mm512_mullo_epi16( _mm512_unpacklo_epi8( pixels, zero ), _mm512_unpacklo_epi32( scaleWords, scaleWords ) ), 8 );
+	__m512i high = _mm512_srli_epi16( _mm512_mullo_epi16( _mm512_unpackhi_epi8( pixels, zero ), _mm512_unpackhi_epi32( scaleWords, scaleWords ) ), 8 );
+	return _mm512_packus_epi16( low, high );
+
+}
+
+// Composites sixteen premultiplied pixels over sixteen others, adding whole pixels like pixelOver()
+AVX512_TARGET static inline __m512i over( __m512i source, __m512i destination ) {
+
+	__m512i inverseAlpha = _mm512_sub_epi32( _mm512_set1_epi32( 256 ), _mm512_srli_epi32( source, 24 ) );
+	return _mm512_add_epi32( source, scalePixels( destination, inverseAlpha ) );
+
+}
+
+// Sixteen coverage bytes (or fewer, with the rest as zero) as scales between 0 and 256, like coverageToScale()
+AVX512_TARGET static inline __m512i coverageScales( __m128i coverageBytes ) {
+
+	__m512i coverage = _mm512_cvtepu8_epi32( coverageBytes );
+	return _mm512_add_epi32( coverage, _mm512_srli_epi32( coverage, 7 ) );
+
+}
+
+// The lanes of the last vector of a span that are within it
+static inline __mmask16 getTailMask( unsigned int remaining ) {
+	return remaining >= 16 ? ( __mmask16 ) 0xFFFF : ( __mmask16 ) ( ( 1u << remaining ) - 1 );
+}
+
+// Sixteen pixels at a time, the last few with a masked store
+AVX512_TARGET static void fill( uint32_t *destination, unsigned int count, uint32_t color ) {
+
+	__m512i colors = _mm512_set1_epi32( ( int ) color );
+	for ( unsigned int index = 0; index < count; index += 16 ) _mm512_mask_storeu_epi32( destination + index, getTailMask( count - index ), colors );
+
+}
+
+// Sixteen pixels at a time, skipping uncovered ones & storing fully covered opaque ones, the last few with masked loads & stores
+AVX512_TARGET static void blendSolid( uint32_t *destination, const uint8_t *coverage, unsigned int count, uint32_t color ) {
+
+	__m512i colors = _mm512_set1_epi32( ( int ) color );
+	bool isOpaque = ( color >> 24 ) == 255;
+
+	for ( unsigned int index = 0; index < count; index += 16 ) {
+		__mmask16 mask = getTailMask( count - index );
+		__m128i coverageBytes = _mm_maskz_loadu_epi8( mask, coverage + index );
+		__mmask16 isCovered = _mm_test_epi8_mask( coverageBytes, coverageBytes );
+		if ( isCovered == 0 ) continue;
+
+		if ( isOpaque && _mm_cmpeq_epi8_mask( coverageBytes, _mm_set1_epi8( -1 ) ) == mask ) {
+			_mm512_mask_storeu_epi32( destination + index, mask, colors );
+			continue;
+		}
+
+		__m512i pixels = _mm512_maskz_loadu_epi32( mask, destination + index );
+		_mm512_mask_storeu_epi32( destination + index, mask, over( scalePixels( colors, coverageScales( coverageBytes ) ), pixels ) );
+	}
+
+}
+
+// Sixteen pixels at a time, skipping uncovered ones, the last few with masked loads & stores
+AVX512_TARGET static void blend( uint32_t *destination, const uint32_t *source, const uint8_t *coverage, unsigned int count ) {
+
+	for ( unsigned int index = 0; index < count; index += 16 ) {
+		__mmask16 mask = getTailMask( count - index );
+		__m128i coverageBytes = _mm_maskz_loadu_epi8( mask, coverage + index );
+		if ( _mm_test_epi8_mask( coverageBytes, coverageBytes ) == 0 ) continue;
+
+		__m512i sourcePixels = _mm512_maskz_loadu_epi32( mask, source + index );
+		__m512i pixels = _mm512_maskz_loadu_epi32( mask, destination + index );
+		_mm512_mask_storeu_epi32( destination + index, mask, over( scalePixels( sourcePixels, coverageScales( coverageBytes ) ), pixels ) );
+	}
+
+}
+
+// Sixteen pixels at a time, only storing the pixels that are not transparent, the last few with masked loads & stores
+AVX512_TARGET static void blendOver( uint32_t *destination, const uint32_t *source, unsigned int count ) {
+
+	__m512i alphaMask = _mm512_set1_epi32( ( int ) 0xFF000000 );
+
+	for ( unsigned int index = 0; index < count; index += 16 ) {
+		__mmask16 mask = getTailMask( count - index );
+		__m512i sourcePixels = _mm512_maskz_loadu_epi32( mask, source + index );
+		__mmask16 isVisible = _mm512_test_epi32_mask( sourcePixels, alphaMask );
+		if ( isVisible == 0 ) continue;
+
+		if ( _mm512_cmpeq_epi32_mask( _mm512_and_si512( sourcePixels, alphaMask ), alphaMask ) == mask ) {
+			_mm512_mask_storeu_epi32( destination + index, mask, sourcePixels );
+			continue;
+		}
+
+		__m512i pixels = _mm512_maskz_loadu_epi32( isVisible, destination + index );
+		_mm512_mask_storeu_epi32( destination + index, isVisible, over( sourcePixels, pixels ) );
+	}
+
+}
+
+// Sixteen positions at a time, each from the first & its index like the plain version, looked up with a gather & the last few stored with a mask
+AVX512_TARGET static void gradient( uint32_t *destination, const uint32_t *table, float position, float step, unsigned int count ) {
+
+	__m512 positions = _mm512_set1_ps( position );
+	__m512 steps = _mm512_set1_ps( step );
+	__m512 lastIndex = _mm512_set1_ps( ( float ) ( GRADIENT_TABLE_SIZE - 1 ) );
+	__m512 half = _mm512_set1_ps( 0.5f );
+	__m512i indices = _mm512_set_epi32( 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 );
+
+	for ( unsigned int index = 0; index < count; index += 16 ) {
+		__m512 clamped = _mm512_min_ps( _mm512_max_ps( _mm512_add_ps( positions, _mm512_mul_ps( _mm512_cvtepi32_ps( indices ), steps ) ), _mm512_setzero_ps() ), lastIndex );
+		__m512i entries = _mm512_cvttps_epi32( _mm512_add_ps( clamped, half ) );
+		_mm512_mask_storeu_epi32( destination + index, getTailMask( count - index ), _mm512_i32gather_epi32( entries, table, 4 ) );
+		indices = _mm512_add_epi32( indices, _mm512_set1_epi32( 16 ) );
+	}
+
+}
+
+// Replaces every kernel there is an AVX-512 version of
+void kernelsAddAVX512( KernelTable &table ) {
+
+	table.fill = fill;
+	table.blendSolid = blendSolid;
+	table.blend = blend;
+	table.blendOver = blendOver;
+	table.gradient = gradient;
+
+}
+
+#endif
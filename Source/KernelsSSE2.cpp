@@ -0,0 +1,367 @@
+#include "Kernels.h"
+
+#ifdef KERNELS_X86
+
+// The plain versions, for the pixels left over after the last whole vector
+#include "Framebuffer.h"
+#include "Canvas.h"
+#include "Encoder.h"
+
+// Fixed-point cell areas
+#include "FixedRasterizer.h"
+
+// Absolute values & rounding
+#include <cmath>
+
+// Min, max & clamp
+#include <algorithm>
+
+// Copying packed bytes
+#include <cstring>
+
+// SSE2 intrinsics
+#include <emmintrin.h>
+
+// Multiplies every channel of four pixels by a scale between 0 and 256 each, giving exactly what pixelScale() does
+KERNEL_TARGET( "sse2" ) static inline __m128i scalePixels( __m128i pixels, __m128i scales ) {
+
+	// Each pixel's scale into all four of its 16-bit channels, the channels of two pixels fit in each half
+	__m128i scaleWords = _mm_or_si128( scales, _mm_slli_epi32( scales, 16 ) );
+	__m128i lowScales = _mm_unpacklo_epi32( scaleWords, scaleWords );
+	__m128i highScales = _mm_unpackhi_epi32( scaleWords, scaleWords );
+
+	// A channel times a scale is at most 65,280, so it never overflows 16 bits
+	__m128i zero = _mm_setzero_si128();
+	__m128i low = _mm_srli_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( pixels, zero ), lowScales ), 8 );
+	__m128i high = _mm_srli_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( pixels, zero ), highScales ), 8 );
+	return _mm_packus_epi16( low, high );
+
+}
+
+// Composites four premultiplied pixels over four others, adding whole pixels like pixelOver() so even invalid colors carry the same way
+KERNEL_TARGET( "sse2" ) static inline __m128i over( __m128i source, __m128i destination ) {
+
+	__m128i inverseAlpha = _mm_sub_epi32( _mm_set1_epi32( 256 ), _mm_srli_epi32( source, 24 ) );
+	return _mm_add_epi32( source, scalePixels( destination, inverseAlpha ) );
+
+}
+
+// Four coverage bytes as scales between 0 and 256, like coverageToScale()
+KERNEL_TARGET( "sse2" ) static inline __m128i coverageScales( int packedCoverage ) {
+
+	__m128i zero = _mm_setzero_si128();
+	__m128i coverage = _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128( packedCoverage ), zero ), zero );
+	return _mm_add_epi32( coverage, _mm_srli_epi32( coverage, 7 ) );
+
+}
+
+// Four pixels at a time
+KERNEL_TARGET( "sse2" ) static void fill( uint32_t *destination, unsigned int count, uint32_t color ) {
+
+	__m128i colors = _mm_set1_epi32( ( int ) color );
+	unsigned int index = 0;
+	for ( ; index + 4 <= count; index += 4 ) _mm_storeu_si128( ( __m128i * ) ( destination + index ), colors );
+	for ( ; index < count; index++ ) destination[ index ] = color;
+
+}
+
+// Four pixels at a time, skipping uncovered ones & storing fully covered opaque ones, zero & full coverage give the same result as the plain version's shortcuts anyway
+KERNEL_TARGET( "sse2" ) static void blendSolid( uint32_t *destination, const uint8_t *coverage, unsigned int count, uint32_t color ) {
+
+	__m128i colors = _mm_set1_epi32( ( int ) color );
+	bool isOpaque = ( color >> 24 ) == 255;
+	unsigned int index = 0;
+
+	for ( ; index + 4 <= count; index += 4 ) {
+		int packedCoverage;
+		std::memcpy( &packedCoverage, coverage + index, sizeof( packedCoverage ) );
+		if ( packedCoverage == 0 ) continue;
+
+		__m128i *pixels = ( __m128i * ) ( destination + index );
+		if ( packedCoverage == -1 && isOpaque ) {
+			_mm_storeu_si128( pixels, colors );
+			continue;
+		}
+
+		_mm_storeu_si128( pixels, over( scalePixels( colors, coverageScales( packedCoverage ) ), _mm_loadu_si128( pixels ) ) );
+	}
+
+	spanBlendSolid( destination + index, coverage + index, count - index, color );
+
+}
+
+// Four pixels at a time, skipping uncovered ones
+KERNEL_TARGET( "sse2" ) static void blend( uint32_t *destination, const uint32_t *source, const uint8_t *coverage, unsigned int count ) {
+
+	unsigned int index = 0;
+	for ( ; index + 4 <= count; index += 4 ) {
+		int packedCoverage;
+		std::memcpy( &packedCoverage, coverage + index, sizeof( packedCoverage ) );
+		if ( packedCoverage == 0 ) continue;
+
+		__m128i sourcePixels = _mm_loadu_si128( ( const __m128i * ) ( source + index ) );
+		__m128i *pixels = ( __m128i * ) ( destination + index );
+		_mm_storeu_si128( pixels, over( scalePixels( sourcePixels, coverageScales( packedCoverage ) ), _mm_loadu_si128( pixels ) ) );
+	}
+
+	spanBlend( destination + index, source + index, coverage + index, count - index );
+
+}
+
+// Four pixels at a time, skipping transparent runs & copying opaque ones, the rest are composited & transparent pixels put back
+KERNEL_TARGET( "sse2" ) static void blendOver( uint32_t *destination, const uint32_t *source, unsigned int count ) {
+
+	__m128i zero = _mm_setzero_si128();
+	__m128i opaque = _mm_set1_epi32( 255 );
+	unsigned int index = 0;
+
+	for ( ; index + 4 <= count; index += 4 ) {
+		__m128i sourcePixels = _mm_loadu_si128( ( const __m128i * ) ( source + index ) );
+		__m128i alphas = _mm_srli_epi32( sourcePixels, 24 );
+		__m128i isTransparent = _mm_cmpeq_epi32( alphas, zero );
+		if ( _mm_movemask_epi8( isTransparent ) == 0xFFFF ) continue;
+
+		__m128i *pixels = ( __m128i * ) ( destination + index );
+		if ( _mm_movemask_epi8( _mm_cmpeq_epi32( alphas, opaque ) ) == 0xFFFF ) {
+			_mm_storeu_si128( pixels, sourcePixels );
+			continue;
+		}
+
+		__m128i destinationPixels = _mm_loadu_si128( pixels );
+		__m128i composited = over( sourcePixels, destinationPixels );
+		_mm_storeu_si128( pixels, _mm_or_si128( _mm_and_si128( isTransparent, destinationPixels ), _mm_andnot_si128( isTransparent, composited ) ) );
+	}
+
+	spanBlendOver( destination + index, source + index, count - index );
+
+}
+
+// Four positions at a time, each from the first & its index like the plain version, then looked up one by one
+KERNEL_TARGET( "sse2" ) static void gradient( uint32_t *destination, const uint32_t *table, float position, float step, unsigned int count ) {
+
+	__m128 positions = _mm_set1_ps( position );
+	__m128 steps = _mm_set1_ps( step );
+	__m128 lastIndex = _mm_set1_ps( ( float ) ( GRADIENT_TABLE_SIZE - 1 ) );
+	__m128 half = _mm_set1_ps( 0.5f );
+	__m128i indices = _mm_set_epi32( 3, 2, 1, 0 );
+	unsigned int index = 0;
+
+	for ( ; index + 4 <= count; index += 4 ) {
+		__m128 clamped = _mm_min_ps( _mm_max_ps( _mm_add_ps( positions, _mm_mul_ps( _mm_cvtepi32_ps( indices ), steps ) ), _mm_setzero_ps() ), lastIndex );
+		alignas( 16 ) int32_t entries[ 4 ];
+		_mm_store_si128( ( __m128i * ) entries, _mm_cvttps_epi32( _mm_add_ps( clamped, half ) ) );
+
+		for ( unsigned int lane = 0; lane < 4; lane++ ) destination[ index + lane ] = table[ entries[ lane ] ];
+		indices = _mm_add_epi32( indices, _mm_set1_epi32( 4 ) );
+	}
+
+	// Whatever is left, still from the first position so it rounds the same
+	for ( ; index < count; index++ ) {
+		float clamped = std::clamp( position + ( float ) index * step, 0.0f, ( float ) ( GRADIENT_TABLE_SIZE - 1 ) );
+		destination[ index ] = table[ ( unsigned int ) ( clamped + 0.5f ) ];
+	}
+
+}
+
+// Four cells at a time: an in-register prefix sum, plus the total of every cell before them
+KERNEL_TARGET( "sse2" ) static void accumulate( const float *cells, uint8_t *coverage, unsigned int count, FillRule fillRule ) {
+
+	__m128 offset = _mm_setzero_ps();
+	const __m128 absoluteMask = _mm_castsi128_ps( _mm_set1_epi32( 0x7FFFFFFF ) );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 two = _mm_set1_ps( 2.0f );
+	const __m128 half = _mm_set1_ps( 0.5f );
+	const __m128 scale = _mm_set1_ps( 255.0f );
+	unsigned int index = 0;
+
+	for ( ; index + 4 <= count; index += 4 ) {
+		__m128 value = _mm_loadu_ps( cells + index );
+		value = _mm_add_ps( value, _mm_castsi128_ps( _mm_slli_si128( _mm_castps_si128( value ), 4 ) ) );
+		value = _mm_add_ps( value, _mm_shuffle_ps( _mm_setzero_ps(), value, 0x40 ) );
+		value = _mm_add_ps( value, offset );
+		offset = _mm_shuffle_ps( value, value, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+
+		__m128 winding = _mm_and_ps( value, absoluteMask );
+		if ( fillRule == FillRule::NonZero ) {
+			winding = _mm_min_ps( winding, one );
+		} else {
+			__m128 pairs = _mm_cvtepi32_ps( _mm_cvttps_epi32( _mm_mul_ps( winding, half ) ) );
+			winding = _mm_sub_ps( winding, _mm_mul_ps( pairs, two ) );
+			winding = _mm_min_ps( winding, _mm_sub_ps( two, winding ) );
+		}
+
+		// Round to the nearest byte & pack the four values down
+		__m128i bytes = _mm_cvtps_epi32( _mm_mul_ps( winding, scale ) );
+		bytes = _mm_packs_epi32( bytes, bytes );
+		bytes = _mm_packus_epi16( bytes, bytes );
+		int packed = _mm_cvtsi128_si32( bytes );
+		std::memcpy( coverage + index, &packed, sizeof( packed ) );
+	}
+
+	// Whatever is left, rounding the same way as above
+	float sum = _mm_cvtss_f32( offset );
+	for ( ; index < count; index++ ) {
+		sum += cells[ index ];
+
+		float winding = std::fabs( sum );
+		if ( fillRule == FillRule::NonZero ) {
+			winding = std::min( winding, 1.0f );
+		} else {
+			winding -= 2.0f * ( float ) ( int ) ( winding * 0.5f );
+			winding = std::min( winding, 2.0f - winding );
+		}
+
+		coverage[ index ] = ( uint8_t ) std::lrintf( winding * 255.0f );
+	}
+
+}
+
+// Four cells at a time, the same as above with integers
+KERNEL_TARGET( "sse2" ) static void accumulateFixed( const int32_t *cells, uint8_t *coverage, unsigned int count, FillRule fillRule ) {
+
+	__m128i offset = _mm_setzero_si128();
+	const __m128i wholePixel = _mm_set1_epi32( FIXED_CELL_AREA );
+	const __m128i foldMask = _mm_set1_epi32( FIXED_CELL_AREA * 2 - 1 );
+	const __m128i half = _mm_set1_epi32( FIXED_CELL_AREA / 2 );
+	unsigned int index = 0;
+
+	for ( ; index + 4 <= count; index += 4 ) {
+		__m128i value = _mm_loadu_si128( ( const __m128i * ) ( cells + index ) );
+		value = _mm_add_epi32( value, _mm_slli_si128( value, 4 ) );
+		value = _mm_add_epi32( value, _mm_slli_si128( value, 8 ) );
+		value = _mm_add_epi32( value, offset );
+		offset = _mm_shuffle_epi32( value, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+
+		// Absolute value without SSSE3: flip the bits of negative values & add one
+		__m128i sign = _mm_srai_epi32( value, 31 );
+		__m128i area = _mm_sub_epi32( _mm_xor_si128( value, sign ), sign );
+
+		// Minimum & the even-odd fold without SSE4.1: select with a comparison mask
+		if ( fillRule == FillRule::NonZero ) {
+			__m128i isOver = _mm_cmpgt_epi32( area, wholePixel );
+			area = _mm_or_si128( _mm_andnot_si128( isOver, area ), _mm_and_si128( isOver, wholePixel ) );
+		} else {
+			area = _mm_and_si128( area, foldMask );
+			__m128i isOver = _mm_cmpgt_epi32( area, wholePixel );
+			__m128i folded = _mm_sub_epi32( _mm_add_epi32( wholePixel, wholePixel ), area );
+			area = _mm_or_si128( _mm_andnot_si128( isOver, area ), _mm_and_si128( isOver, folded ) );
+		}
+
+		// Times 255 (without a 32-bit multiply before SSE4.1), rounded to the nearest byte & packed down
+		__m128i bytes = _mm_srli_epi32( _mm_add_epi32( _mm_sub_epi32( _mm_slli_epi32( area, 8 ), area ), half ), 17 );
+		bytes = _mm_packs_epi32( bytes, bytes );
+		bytes = _mm_packus_epi16( bytes, bytes );
+		int packed = _mm_cvtsi128_si32( bytes );
+		std::memcpy( coverage + index, &packed, sizeof( packed ) );
+	}
+
+	// Whatever is left, the same as the plain version
+	int32_t sum = _mm_cvtsi128_si32( offset );
+	for ( ; index < count; index++ ) {
+		sum += cells[ index ];
+
+		uint32_t area = ( uint32_t ) std::abs( sum );
+		if ( fillRule == FillRule::NonZero ) {
+			area = std::min( area, ( uint32_t ) FIXED_CELL_AREA );
+		} else {
+			area &= FIXED_CELL_AREA * 2 - 1;
+			if ( area > ( uint32_t ) FIXED_CELL_AREA ) area = FIXED_CELL_AREA * 2 - area;
+		}
+
+		coverage[ index ] = ( uint8_t ) ( ( area * 255 + FIXED_CELL_AREA / 2 ) >> 17 );
+	}
+
+}
+
+// Adds each pair of neighbouring 32-bit values of two vectors: the first's pairs, then the second's (SSSE3 has an instruction for this)
+KERNEL_TARGET( "sse2" ) static inline __m128i addPairs( __m128i first, __m128i second ) {
+
+	__m128 evens = _mm_shuffle_ps( _mm_castsi128_ps( first ), _mm_castsi128_ps( second ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+	__m128 odds = _mm_shuffle_ps( _mm_castsi128_ps( first ), _mm_castsi128_ps( second ), _MM_SHUFFLE( 3, 1, 3, 1 ) );
+	return _mm_add_epi32( _mm_castps_si128( evens ), _mm_castps_si128( odds ) );
+
+}
+
+// Four pixels at a time: multiply & add the channels of each pixel with the luma weights (blue, green, red, then zero for alpha)
+KERNEL_TARGET( "sse2" ) static void convert( const uint32_t *pixels, uint8_t *luma, unsigned int count ) {
+
+	__m128i zero = _mm_setzero_si128();
+	__m128i weights = _mm_set_epi16( 0, 77, 150, 29, 0, 77, 150, 29 );
+	__m128i rounding = _mm_set1_epi32( 128 );
+	unsigned int index = 0;
+
+	for ( ; index + 4 <= count; index += 4 ) {
+		__m128i pixelValues = _mm_loadu_si128( ( const __m128i * ) ( pixels + index ) );
+		__m128i low = _mm_madd_epi16( _mm_unpacklo_epi8( pixelValues, zero ), weights );
+		__m128i high = _mm_madd_epi16( _mm_unpackhi_epi8( pixelValues, zero ), weights );
+		__m128i values = _mm_srli_epi32( _mm_add_epi32( addPairs( low, high ), rounding ), 8 );
+
+		values = _mm_packs_epi32( values, values );
+		values = _mm_packus_epi16( values, values );
+		int packed = _mm_cvtsi128_si32( values );
+		std::memcpy( luma + index, &packed, sizeof( packed ) );
+	}
+
+	encodeLuma( pixels + index, luma + index, count - index );
+
+}
+
+// The rounded average of the channels of two 2 x 2 blocks: four pixels of the top & bottom rows
+KERNEL_TARGET( "sse2" ) static inline __m128i averageBlocks( const uint32_t *topRow, const uint32_t *bottomRow ) {
+
+	__m128i zero = _mm_setzero_si128();
+	__m128i top = _mm_loadu_si128( ( const __m128i * ) topRow );
+	__m128i bottom = _mm_loadu_si128( ( const __m128i * ) bottomRow );
+	__m128i low = _mm_add_epi16( _mm_unpacklo_epi8( top, zero ), _mm_unpacklo_epi8( bottom, zero ) );
+	__m128i high = _mm_add_epi16( _mm_unpackhi_epi8( top, zero ), _mm_unpackhi_epi8( bottom, zero ) );
+
+	// Add the two pixels of each block, the first block's totals from the low half & the second's from the high half
+	__m128i totals = _mm_unpacklo_epi64( _mm_add_epi16( low, _mm_srli_si128( low, 8 ) ), _mm_add_epi16( high, _mm_srli_si128( high, 8 ) ) );
+	return _mm_srli_epi16( _mm_add_epi16( totals, _mm_set1_epi16( 2 ) ), 2 );
+
+}
+
+// Four blocks at a time: average them, then multiply & add with each chroma's weights, saturating to a byte caps pure blue & red at 255
+KERNEL_TARGET( "sse2" ) static void downsample( const uint32_t *topRow, const uint32_t *bottomRow, uint8_t *blueChroma, uint8_t *redChroma, unsigned int count ) {
+
+	__m128i blueWeights = _mm_set_epi16( 0, -43, -85, 128, 0, -43, -85, 128 );
+	__m128i redWeights = _mm_set_epi16( 0, 128, -107, -21, 0, 128, -107, -21 );
+	__m128i rounding = _mm_set1_epi32( 32896 );
+	unsigned int index = 0;
+
+	for ( ; index + 4 <= count; index += 4 ) {
+		__m128i firstBlocks = averageBlocks( topRow + index * 2, bottomRow + index * 2 );
+		__m128i secondBlocks = averageBlocks( topRow + index * 2 + 4, bottomRow + index * 2 + 4 );
+
+		__m128i blue = addPairs( _mm_madd_epi16( firstBlocks, blueWeights ), _mm_madd_epi16( secondBlocks, blueWeights ) );
+		__m128i red = addPairs( _mm_madd_epi16( firstBlocks, redWeights ), _mm_madd_epi16( secondBlocks, redWeights ) );
+		blue = _mm_srai_epi32( _mm_add_epi32( blue, rounding ), 8 );
+		red = _mm_srai_epi32( _mm_add_epi32( red, rounding ), 8 );
+
+		__m128i bytes = _mm_packus_epi16( _mm_packs_epi32( blue, red ), _mm_setzero_si128() );
+		int packedBlue = _mm_cvtsi128_si32( bytes );
+		int packedRed = _mm_cvtsi128_si32( _mm_srli_si128( bytes, 4 ) );
+		std::memcpy( blueChroma + index, &packedBlue, sizeof( packedBlue ) );
+		std::memcpy( redChroma + index, &packedRed, sizeof( packedRed ) );
+	}
+
+	encodeChroma( topRow + index * 2, bottomRow + index * 2, blueChroma + index, redChroma + index, count - index );
+
+}
+
+// Replaces every kernel there is an SSE2 version of
+void kernelsAddSSE2( KernelTable &table ) {
+
+	table.fill = fill;
+	table.blendSolid = blendSolid;
+	table.blend = blend;
+	table.blendOver = blendOver;
+	table.gradient = gradient;
+	table.coverage = accumulate;
+	table.fixedCoverage = accumulateFixed;
+	table.convert = convert;
+	table.downsample = downsample;
+
+}
+
+#endif
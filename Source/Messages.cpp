@@ -4,6 +4,9 @@
 // Console functions
 #include "Console.h"
 
+// Startup timeline
+#include "Timeline.h"
+
 // Receives and handles messages dispatched to our window, ideally should be done on another thread as another message cannot be received until this finishes processing the current one
 // https://docs.microsoft.com/en-us/windows/win32/learnwin32/writing-the-window-procedure
 LRESULT CALLBACK MyWindow::windowProcedure( HWND windowHandle, UINT messageCode, WPARAM wParam, LPARAM lParam ) {
@@ -140,8 +143,8 @@ LRESULT CALLBACK MyWindow::windowProcedure( HWND windowHandle, UINT messageCode,
 // Called when the window needs to be painted
 void MyWindow::onWindowPaint( HWND windowHandle ) {
 
-	// Create the Direct2D resources if they have not been created yet
-	this->createGraphicsResources();
+	// Create the render target if it has not been created yet (or was lost), the brushes are created when first used below
+	this->createRenderTarget();
 
 	// Get the current size of the render target, which is changed whenever the window is resized
 	D2D1_SIZE_F renderTargetSize = this->renderTarget->GetSize();
@@ -170,36 +173,46 @@ void MyWindow::onWindowPaint( HWND windowHandle ) {
 	// Start the drawing code
 	this->renderTarget->BeginDraw();
 
-	// Clear everything (fill with a color)
-	// https://docs.microsoft.com/en-us/windows/win32/direct2d/id2d1rendertarget-clear
-	this->renderTarget->Clear( D2D1::ColorF( D2D1::ColorF::LightGray, 1.0f ) );
-
-	// Fill a rectangle using the gradient brush
-	// https://docs.microsoft.com/en-us/windows/win32/api/d2d1/nn-d2d1-id2d1solidcolorbrush#examples
-	this->renderTarget->FillRectangle( rectangleArea, this->gradientBrushFill );
-
-	// Draw a rectangle outline using the solid brush
-	// https://docs.microsoft.com/en-us/windows/win32/direct2d/getting-started-with-direct2d#step-5-draw-the-rectangle
-	this->renderTarget->DrawRectangle( rectangleArea, this->solidBrushOutline );
-
-	// Draw a circle outline
-	this->renderTarget->DrawEllipse(
-		D2D1::Ellipse(
-			D2D1::Point2F( renderTargetSize.width / 2.0f, renderTargetSize.height / 2.0f ), // Position in the middle
-			75.0f, 75.0f // The circle radius (X, Y)
-		),
-		this->solidBrushOutline, // Use the outline brush
-		3.0f // The width of the outline (stroke)
-	);
+	// Draw the scene in software if sharing or recording frames is enabled, otherwise draw it with Direct2D
+	if ( !this->drawSoftwareFrame() ) {
+
+		// Clear everything (fill with a color)
+		// https://docs.microsoft.com/en-us/windows/win32/direct2d/id2d1rendertarget-clear
+		this->renderTarget->Clear( D2D1::ColorF( D2D1::ColorF::LightGray, 1.0f ) );
+
+		// Fill a rectangle using the gradient brush
+		// https://docs.microsoft.com/en-us/windows/win32/api/d2d1/nn-d2d1-id2d1solidcolorbrush#examples
+		this->renderTarget->FillRectangle( rectangleArea, this->gradientBrushFill.get() );
+
+		// Draw a rectangle outline using the solid brush
+		// https://docs.microsoft.com/en-us/windows/win32/direct2d/getting-started-with-direct2d#step-5-draw-the-rectangle
+		this->renderTarget->DrawRectangle( rectangleArea, this->solidBrushOutline.get() );
+
+		// Draw a circle outline
+		this->renderTarget->DrawEllipse(
+			D2D1::Ellipse(
+				D2D1::Point2F( renderTargetSize.width / 2.0f, renderTargetSize.height / 2.0f ), // Position in the middle
+				75.0f, 75.0f // The circle radius (X, Y)
+			),
+			this->solidBrushOutline.get(), // Use the outline brush
+			3.0f // The width of the outline (stroke)
+		);
+
+	}
 
-	// Draw some text
-	// https://docs.microsoft.com/en-us/windows/win32/Direct2D/how-to--draw-text
-	this->renderTarget->DrawTextW(
-		L"Hello World!", // The text to draw
-		12, // The length of the text
-		this->writeTextFormat, // The text formatter resource
-		rectangleArea, // Position of the text
-		this->solidBrushText // Use the text brush
+	// Fit the text layout to the rectangle it is drawn in, only when the size has changed as that lays the text out again
+	if ( this->textLayoutSize.width != renderTargetSize.width || this->textLayoutSize.height != renderTargetSize.height ) {
+		this->writeTextLayout->SetMaxWidth( renderTargetSize.width - 100.0f );
+		this->writeTextLayout->SetMaxHeight( renderTargetSize.height - 100.0f );
+		this->textLayoutSize = renderTargetSize;
+	}
+
+	// Draw the text, using the layout pre-warmed during startup
+	// https://docs.microsoft.com/en-us/windows/win32/directwrite/how-to-display-a-simple-text-string
+	this->renderTarget->DrawTextLayout(
+		D2D1::Point2F( rectangleArea.left, rectangleArea.top ), // Position of the text
+		this->writeTextLayout.get(), // The text layout resource
+		this->solidBrushText.get() // Use the text brush
 	);
 
 	// End the drawing code
@@ -219,15 +232,23 @@ void MyWindow::onWindowPaint( HWND windowHandle ) {
 	// End the painting code, this clears the update region & signals to Windows that the painting is complete
 	EndPaint( windowHandle, &paintData );
 
+	// Display the startup timeline once the first frame is on screen
+	if ( !this->hasPresentedFrame ) {
+		this->hasPresentedFrame = true;
+		timelineMark( "First frame presented" );
+
+		for ( const std::string &line : timelineReport() ) consoleOutput( "%s", line.c_str() );
+		consoleOutput( "Time to first frame: %.2f ms", timelineFind( "First frame presented" ) );
+	}
+
 }
 
 // Called when the window is resized
 void MyWindow::onWindowResize( HWND windowHandle, UINT type, UINT width, UINT height ) {
 
-	// Update the size of the render target
-	if ( this->renderTarget != NULL ) {
-		this->renderTarget->Resize( D2D1::SizeU( width, height ) );
-	}
+	// Update the size of the render target, the text layout is fitted to it on the next paint
+	// The render target only exists once startup has finished
+	if ( this->renderTarget != NULL ) this->renderTarget->Resize( D2D1::SizeU( width, height ) );
 
 	// Display a message to the console
 	consoleOutput( "Window resized to %d by %d.", width, height );
@@ -237,8 +258,14 @@ void MyWindow::onWindowResize( HWND windowHandle, UINT type, UINT width, UINT he
 // Called when the window is destroyed
 void MyWindow::onWindowDestroy( HWND windowHandle ) {
 
-	// Discard Direct2D resources
+	// Discard Direct2D resources, then display how long they took to create
 	this->releaseGraphicsResources();
+	this->reportResources();
+
+	// Finish writing any frames still being recorded, and display how well the software layers & frames were cached
+	this->stopRecording();
+	this->reportCompositor();
+	this->reportFrameCache();
 
 	// Exit the message loop by pushing a quit message onto the message queue, which causes GetMessage() to return 0 and thus the loop ends
 	PostQuitMessage( 0 );
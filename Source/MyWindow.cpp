@@ -6,7 +6,12 @@ MyWindow::MyWindow( LPCWSTR windowClassName, LPCWSTR windowTitle, UINT windowWid
 	WINDOW_CLASS_NAME( windowClassName ),
 	WINDOW_TITLE( windowTitle ),
 	WINDOW_WIDTH( windowWidth ),
-	WINDOW_HEIGHT( windowHeight ) {
+	WINDOW_HEIGHT( windowHeight ),
+	writeTextFormat( "DirectWrite text format", [ this ]() { return this->createTextFormat(); } ),
+	writeTextLayout( "DirectWrite text layout", [ this ]() { return this->createTextLayout(); } ),
+	solidBrushOutline( "Direct2D outline brush", [ this ]() { return this->createSolidBrush( D2D1::ColorF( D2D1::ColorF::Black, 1.0f ) ); } ),
+	solidBrushText( "Direct2D text brush", [ this ]() { return this->createSolidBrush( D2D1::ColorF( D2D1::ColorF::Blue, 1.0f ) ); } ),
+	gradientBrushFill( "Direct2D gradient brush", [ this ]() { return this->createGradientBrush(); } ) {
 
 }
 
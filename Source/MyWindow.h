@@ -13,6 +13,16 @@
 // DirectWrite
 #include <dwrite.h>
 
+// Brushes & text resources created on first use
+#include "Resources.h"
+
+// Software rendering into shared memory, and recording it
+#include "SharedFramebuffer.h"
+#include "Recorder.h"
+#include "Scene.h"
+#include "Compositor.h"
+#include "FrameCache.h"
+
 // Custom class to encapsulate everything
 class MyWindow {
 
@@ -28,14 +38,46 @@ class MyWindow {
 		// Window
 		HWND windowHandle = NULL;
 
-		// Direct2D
+		// Direct2D (device-independent, the factories are created on a worker thread during startup & the text resources are pre-warmed on others)
 		ID2D1Factory *d2dFactory = NULL;
 		IDWriteFactory *writeFactory = NULL;
+		LazyHandle<IDWriteTextFormat> writeTextFormat;
+		LazyHandle<IDWriteTextLayout> writeTextLayout;
+		D2D1_SIZE_F textLayoutSize = { 0.0f, 0.0f }; // The size the text layout was last fitted to
+
+		// Direct2D (device-dependent, the render target is created on the main thread once the window exists & the brushes when first needed)
 		ID2D1HwndRenderTarget *renderTarget = NULL;
-		ID2D1SolidColorBrush *solidBrushOutline = NULL;
-		ID2D1SolidColorBrush *solidBrushText = NULL;
-		ID2D1LinearGradientBrush *gradientBrushFill = NULL;
-		IDWriteTextFormat *writeTextFormat = NULL;
+		LazyHandle<ID2D1SolidColorBrush> solidBrushOutline;
+		LazyHandle<ID2D1SolidColorBrush> solidBrushText;
+		LazyHandle<ID2D1LinearGradientBrush> gradientBrushFill;
+
+		// Software rendering of the scene into a ring of buffers shared with other processes and/or recorded to disk, only when enabled on the command line
+		// The frame is composited straight into shared memory (or the recorder's queue if only recording, or a framebuffer of its own if that is full), then copied into a bitmap to put it on screen
+		// The scene is a cached layer, so it is only drawn again when the window is resized, and whole frames drawn before (such as after resizing back) are copied from the frame cache
+		SharedFramebuffer sharedFramebuffer;
+		FrameRecorder recorder;
+		SceneResources sceneResources;
+		Compositor compositor;
+		unsigned int sceneLayer = 0;
+		DisplayList sceneList;
+		FrameCache frameCache;
+		uint64_t composedFrameKey = 0; // The hash of the display list & size the compositor's layers were last drawn for
+		Framebuffer softwareFrame; // Points at whichever pixels this frame is drawn into
+		Framebuffer ownFrame;
+
+		// A buffer the scene was drawn or copied into recently, & the key of the frame it has, so a cached frame is not copied into a buffer that already has it
+		struct SoftwareTarget {
+			const uint32_t *pixels;
+			unsigned int width;
+			unsigned int height;
+			unsigned int stride;
+			uint64_t frameKey;
+		};
+		std::vector<SoftwareTarget> softwareTargets;
+		ID2D1Bitmap *frameBitmap = NULL;
+
+		// Has the first frame been drawn yet, for the startup timeline
+		bool hasPresentedFrame = false;
 
 		// Message receiver
 		static LRESULT CALLBACK windowProcedure( HWND, UINT, WPARAM, LPARAM );
@@ -45,6 +87,21 @@ class MyWindow {
 		void onWindowDestroy( HWND );
 		void onWindowPaint( HWND );
 
+		// Creating the lazy resources
+		IDWriteTextFormat *createTextFormat();
+		IDWriteTextLayout *createTextLayout();
+		ID2D1SolidColorBrush *createSolidBrush( const D2D1_COLOR_F & );
+		ID2D1LinearGradientBrush *createGradientBrush();
+		void reportResources();
+
+		// Software rendering
+		bool drawSoftwareFrame();
+		SoftwareTarget *findSoftwareTarget();
+		void rememberSoftwareTarget( uint64_t );
+		void stopRecording();
+		void reportCompositor();
+		void reportFrameCache();
+
 	// Usable by anyone
 	public:
 
@@ -59,8 +116,11 @@ class MyWindow {
 
 		// Direct2D
 		void setupDirect2D();
-		void createGraphicsResources();
+		void createRenderTarget();
 		void releaseGraphicsResources();
 		void releaseDirect2D();
 
+		// Software rendering
+		void setupSoftwareRendering( const std::string &, const std::string &, size_t );
+
 };
@@ -0,0 +1,510 @@
+#include "Path.h"
+
+// The rasterizer that flattened paths are added to
+#include "Rasterizer.h"
+
+// Square roots, ceilings, etc.
+#include <cmath>
+
+// Min & max
+#include <algorithm>
+
+// The distance of cubic Bezier control points from the ends of a quarter-circle arc, relative to the radius
+const float ELLIPSE_CONTROL_DISTANCE = 0.5522847498f;
+
+// The most lines a single curve or circle will be divided into, keeps huge shapes from exploding
+const unsigned int MAXIMUM_CURVE_LINES = 1024;
+
+// Starts a new contour at the given position
+void Path::moveTo( float x, float y ) {
+
+	this->verbs.push_back( Verb::Move );
+	this->points.push_back( { x, y } );
+	this->contourStart = { x, y };
+
+}
+
+// Starts a contour at the last position if a segment is added without one
+void Path::ensureContour() {
+
+	if ( !this->verbs.empty() && this->verbs.back() != Verb::Close ) return;
+
+	// Contours after a close continue from where the closed contour started
+	this->verbs.push_back( Verb::Move );
+	this->points.push_back( this->contourStart );
+
+}
+
+// Adds a straight line from the last position
+void Path::lineTo( float x, float y ) {
+
+	this->ensureContour();
+	this->verbs.push_back( Verb::Line );
+	this->points.push_back( { x, y } );
+
+}
+
+// Adds a quadratic Bezier curve from the last position, using one control point
+void Path::quadraticTo( float controlX, float controlY, float x, float y ) {
+
+	this->ensureContour();
+	this->verbs.push_back( Verb::Quadratic );
+	this->points.push_back( { controlX, controlY } );
+	this->points.push_back( { x, y } );
+
+}
+
+// Adds a cubic Bezier curve from the last position, using two control points
+void Path::cubicTo( float control1X, float control1Y, float control2X, float control2Y, float x, float y ) {
+
+	this->ensureContour();
+	this->verbs.push_back( Verb::Cubic );
+	this->points.push_back( { control1X, control1Y } );
+	this->points.push_back( { control2X, control2Y } );
+	this->points.push_back( { x, y } );
+
+}
+
+// Closes the current contour with a straight line back to where it started
+void Path::close() {
+
+	if ( this->verbs.empty() || this->verbs.back() == Verb::Close ) return;
+	this->verbs.push_back( Verb::Close );
+
+}
+
+// Removes every contour, but keeps the memory for reuse
+void Path::clear() {
+
+	this->verbs.clear();
+	this->points.clear();
+	this->contourStart = { 0.0f, 0.0f };
+
+}
+
+// Adds a closed rectangle contour
+void Path::addRectangle( float left, float top, float right, float bottom ) {
+
+	this->moveTo( left, top );
+	this->lineTo( right, top );
+	this->lineTo( right, bottom );
+	this->lineTo( left, bottom );
+	this->close();
+
+}
+
+// Adds a closed ellipse contour made from four cubic Bezier curves
+void Path::addEllipse( float centerX, float centerY, float radiusX, float radiusY ) {
+
+	float controlX = radiusX * ELLIPSE_CONTROL_DISTANCE;
+	float controlY = radiusY * ELLIPSE_CONTROL_DISTANCE;
+
+	// Start at the right-most point & go clockwise (on screen)
+	this->moveTo( centerX + radiusX, centerY );
+	this->cubicTo( centerX + radiusX, centerY + controlY, centerX + controlX, centerY + radiusY, centerX, centerY + radiusY );
+	this->cubicTo( centerX - controlX, centerY + radiusY, centerX - radiusX, centerY + controlY, centerX - radiusX, centerY );
+	this->cubicTo( centerX - radiusX, centerY - controlY, centerX - controlX, centerY - radiusY, centerX, centerY - radiusY );
+	this->cubicTo( centerX + controlX, centerY - radiusY, centerX + radiusX, centerY - controlY, centerX + radiusX, centerY );
+	this->close();
+
+}
+
+// Adds a closed contour through every given point
+void Path::addPolygon( const Point *polygonPoints, unsigned int count ) {
+
+	if ( count == 0 ) return;
+
+	this->moveTo( polygonPoints[ 0 ].x, polygonPoints[ 0 ].y );
+	for ( unsigned int index = 1; index < count; index++ ) this->lineTo( polygonPoints[ index ].x, polygonPoints[ index ].y );
+	this->close();
+
+}
+
+// The number of lines & curves in the path, not counting moves & closes
+size_t Path::getSegmentCount() const {
+	return this->verbs.size() - std::count( this->verbs.begin(), this->verbs.end(), Verb::Move ) - std::count( this->verbs.begin(), this->verbs.end(), Verb::Close );
+}
+
+// Is there nothing in this path?
+bool Path::isEmpty() const {
+	return this->verbs.empty();
+}
+
+// Converts every curve into lines that never stray further than the tolerance (in pixels) from the real curve
+// The number of lines per curve comes from the curve's second derivative (Wang's formula), so flat curves cost a single line & tight curves get more
+void Path::flatten( float tolerance, FlattenedPath &flattened ) const {
+
+	flattened.points.clear();
+	flattened.contours.clear();
+
+	// Guard against a zero or negative tolerance, which would divide every curve infinitely
+	tolerance = std::max( tolerance, 0.001f );
+
+	// Finishes the contour currently being written to the output
+	auto finishContour = [ &flattened ]( bool isClosed ) {
+		if ( flattened.contours.empty() ) return;
+
+		FlattenedPath::Contour &contour = flattened.contours.back();
+		if ( contour.count == 0 ) contour.count = ( unsigned int ) flattened.points.size() - contour.first;
+		contour.isClosed = contour.isClosed || isClosed;
+	};
+
+	size_t pointIndex = 0;
+	Point current = { 0.0f, 0.0f };
+
+	for ( Verb verb : this->verbs ) {
+		switch ( verb ) {
+
+			// Start a new output contour
+			case Verb::Move: {
+				finishContour( false );
+
+				current = this->points[ pointIndex++ ];
+				flattened.contours.push_back( { ( unsigned int ) flattened.points.size(), 0, false } );
+				flattened.points.push_back( current );
+
+				break;
+			}
+
+			// Lines are copied as they are
+			case Verb::Line: {
+				current = this->points[ pointIndex++ ];
+				flattened.points.push_back( current );
+
+				break;
+			}
+
+			// The error of n uniform steps along a quadratic curve is at most |p0 - 2p1 + p2| / (4n^2)
+			case Verb::Quadratic: {
+				Point control = this->points[ pointIndex++ ];
+				Point end = this->points[ pointIndex++ ];
+
+				float deviationX = current.x - 2.0f * control.x + end.x;
+				float deviationY = current.y - 2.0f * control.y + end.y;
+				float deviation = std::sqrt( deviationX * deviationX + deviationY * deviationY );
+
+				unsigned int steps = ( unsigned int ) std::ceil( std::sqrt( deviation / ( 4.0f * tolerance ) ) );
+				steps = std::clamp( steps, 1u, MAXIMUM_CURVE_LINES );
+
+				// Evaluate the curve at evenly spaced steps (the last step lands exactly on the end point)
+				float stepSize = 1.0f / ( float ) steps;
+				for ( unsigned int step = 1; step < steps; step++ ) {
+					float t = step * stepSize;
+					float u = 1.0f - t;
+
+					flattened.points.push_back( {
+						u * u * current.x + 2.0f * u * t * control.x + t * t * end.x,
+						u * u * current.y + 2.0f * u * t * control.y + t * t * end.y
+					} );
+				}
+
+				flattened.points.push_back( end );
+				current = end;
+
+				break;
+			}
+
+			// The error of n uniform steps along a cubic curve is at most 3 * max(|p0 - 2p1 + p2|, |p1 - 2p2 + p3|) / (4n^2)
+			case Verb::Cubic: {
+				Point control1 = this->points[ pointIndex++ ];
+				Point control2 = this->points[ pointIndex++ ];
+				Point end = this->points[ pointIndex++ ];
+
+				float deviation1X = current.x - 2.0f * control1.x + control2.x;
+				float deviation1Y = current.y - 2.0f * control1.y + control2.y;
+				float deviation2X = control1.x - 2.0f * control2.x + end.x;
+				float deviation2Y = control1.y - 2.0f * control2.y + end.y;
+				float deviation = std::sqrt( std::max( deviation1X * deviation1X + deviation1Y * deviation1Y, deviation2X * deviation2X + deviation2Y * deviation2Y ) );
+
+				unsigned int steps = ( unsigned int ) std::ceil( std::sqrt( 3.0f * deviation / ( 4.0f * tolerance ) ) );
+				steps = std::clamp( steps, 1u, MAXIMUM_CURVE_LINES );
+
+				float stepSize = 1.0f / ( float ) steps;
+				for ( unsigned int step = 1; step < steps; step++ ) {
+					float t = step * stepSize;
+					float u = 1.0f - t;
+					float a = u * u * u;
+					float b = 3.0f * u * u * t;
+					float c = 3.0f * u * t * t;
+					float d = t * t * t;
+
+					flattened.points.push_back( {
+						a * current.x + b * control1.x + c * control2.x + d * end.x,
+						a * current.y + b * control1.y + c * control2.y + d * end.y
+					} );
+				}
+
+				flattened.points.push_back( end );
+				current = end;
+
+				break;
+			}
+
+			// Mark the contour as closed, the closing line is implied
+			case Verb::Close: {
+				finishContour( true );
+
+				break;
+			}
+
+		}
+	}
+
+	finishContour( false );
+
+}
+
+// Adds every contour to the rasterizer as filled polygons (open contours are implicitly closed, like Direct2D does)
+void pathFill( const FlattenedPath &flattened, Rasterizer &rasterizer ) {
+
+	for ( const FlattenedPath::Contour &contour : flattened.contours ) {
+		if ( contour.count < 2 ) continue;
+		rasterizer.addPolygon( &flattened.points[ contour.first ], contour.count );
+	}
+
+}
+
+// Adds a polygon that always winds the same way, so that overlapping stroke pieces add up instead of cancelling out under the non-zero rule
+static void addPositivePolygon( Rasterizer &rasterizer, std::vector<Point> &polygon ) {
+
+	// Twice the signed area (shoelace formula)
+	float area = 0.0f;
+	for ( size_t index = 0, previous = polygon.size() - 1; index < polygon.size(); previous = index++ ) {
+		area += polygon[ previous ].x * polygon[ index ].y - polygon[ index ].x * polygon[ previous ].y;
+	}
+
+	// Degenerate pieces add nothing
+	if ( area == 0.0f ) return;
+	if ( area < 0.0f ) std::reverse( polygon.begin(), polygon.end() );
+
+	rasterizer.addPolygon( polygon.data(), ( unsigned int ) polygon.size() );
+
+}
+
+// The offsets from the center of a circle made from enough lines to stay within the tolerance
+static void createCircleOffsets( std::vector<Point> &offsets, float radius, float tolerance ) {
+
+	// Each line's midpoint is radius * cos(angle / 2) from the center, so solve for the angle that keeps that within the tolerance
+	unsigned int steps = 8;
+	if ( tolerance < radius ) {
+		float angle = 2.0f * std::acos( 1.0f - tolerance / radius );
+		steps = std::clamp( ( unsigned int ) std::ceil( 6.2831853f / angle ), 8u, MAXIMUM_CURVE_LINES );
+	}
+
+	offsets.clear();
+	for ( unsigned int step = 0; step < steps; step++ ) {
+		float angle = 6.2831853f * ( float ) step / ( float ) steps;
+		offsets.push_back( { radius * std::cos( angle ), radius * std::sin( angle ) } );
+	}
+
+}
+
+// Adds a circle by moving the precomputed offsets to a center
+static void addCircle( Rasterizer &rasterizer, std::vector<Point> &polygon, const std::vector<Point> &offsets, Point center ) {
+
+	polygon.clear();
+	for ( const Point &offset : offsets ) polygon.push_back( { center.x + offset.x, center.y + offset.y } );
+
+	addPositivePolygon( rasterizer, polygon );
+
+}
+
+// Adds the points of an arc around a center, turning from one offset to another in the positive direction (the first point is not added)
+// Each step rotates the offset by the same angle, until the end is within a step of it
+static void addArc( std::vector<Point> &outline, Point center, Point from, Point to, float stepCosine, float stepSine ) {
+
+	float squaredRadius = from.x * from.x + from.y * from.y;
+	Point offset = from;
+
+	for ( unsigned int step = 0; step < MAXIMUM_CURVE_LINES && offset.x * to.x + offset.y * to.y < stepCosine * squaredRadius; step++ ) {
+		offset = { offset.x * stepCosine - offset.y * stepSine, offset.x * stepSine + offset.y * stepCosine };
+		outline.push_back( { center.x + offset.x, center.y + offset.y } );
+	}
+
+	outline.push_back( { center.x + to.x, center.y + to.y } );
+
+}
+
+// Adds the outline of every contour to the rasterizer: one polygon going along one side & back along the other for open contours, or one polygon for each side of closed contours
+// Joins are only added on the outside of each turn, the inside goes through the point itself, so every part of the outline winds the same way & overlaps add up
+// The result must be filled with the non-zero rule, regardless of the fill rule used for the interior of the path
+void pathStroke( const FlattenedPath &flattened, const StrokeStyle &style, float tolerance, Rasterizer &rasterizer ) {
+
+	float halfWidth = style.width * 0.5f;
+	if ( halfWidth <= 0.0f ) return;
+
+	// Reused for every contour
+	std::vector<Point> contourPoints;
+	std::vector<Point> normals;
+	std::vector<float> lengths;
+	std::vector<Point> outline;
+	std::vector<Point> polygon;
+
+	// Round joins & caps turn by the largest angle that keeps each line's midpoint within the tolerance of the arc, at least 8 to a full circle
+	float stepAngle = 6.2831853f / 8.0f;
+	if ( tolerance < halfWidth ) stepAngle = std::clamp( 2.0f * std::acos( 1.0f - tolerance / halfWidth ), 6.2831853f / ( float ) MAXIMUM_CURVE_LINES, stepAngle );
+	float stepCosine = std::cos( stepAngle );
+	float stepSine = std::sin( stepAngle );
+
+	// Single points with round caps are a whole circle, so only work out its shape once
+	std::vector<Point> circleOffsets;
+	if ( style.cap == LineCap::Round ) createCircleOffsets( circleOffsets, halfWidth, tolerance );
+
+	// Adds the points where the line with the first offset meets the line with the second (given their lengths), going along the side the offsets point to
+	// A turn towards the other side gets the join, a turn towards this side only needs to reach where the two sides cross, which the lines either side already cover
+	auto addJoin = [ & ]( Point point, Point from, Point to, float fromLength, float toLength ) {
+		float cross = from.x * to.y - from.y * to.x;
+		float dot = from.x * to.x + from.y * to.y;
+		float squaredHalfWidth = halfWidth * halfWidth;
+
+		// Nothing to fill in when the lines continue straight on
+		if ( std::fabs( cross ) < 1e-6f * squaredHalfWidth && dot > 0.0f ) {
+			outline.push_back( { point.x + from.x, point.y + from.y } );
+			return;
+		}
+
+		if ( cross < 0.0f ) {
+
+			// The sides cross along the sum of the offsets, that is only on both lines if it is no further along them than they are long
+			float scale = squaredHalfWidth / ( squaredHalfWidth + dot );
+			float crossingX = ( from.x + to.x ) * scale;
+			float crossingY = ( from.y + to.y ) * scale;
+			float along = crossingX * crossingX + crossingY * crossingY - squaredHalfWidth;
+			float shortest = std::min( fromLength, toLength );
+			if ( dot > -squaredHalfWidth && along <= shortest * shortest ) {
+				outline.push_back( { point.x + crossingX, point.y + crossingY } );
+				return;
+			}
+
+			// Otherwise going through the point itself stays within the lines either side
+			outline.push_back( { point.x + from.x, point.y + from.y } );
+			outline.push_back( point );
+			outline.push_back( { point.x + to.x, point.y + to.y } );
+			return;
+		}
+
+		outline.push_back( { point.x + from.x, point.y + from.y } );
+
+		if ( style.join == LineJoin::Round ) {
+			addArc( outline, point, from, to, stepCosine, stepSine );
+			return;
+		}
+
+		// The miter tip lies along the sum of the two offsets, its distance relative to half the width is 1 / cos(half the angle)
+		if ( style.join == LineJoin::Miter ) {
+			float miterX = from.x + to.x;
+			float miterY = from.y + to.y;
+			float miterLength = std::sqrt( miterX * miterX + miterY * miterY );
+
+			if ( miterLength > 1e-6f * halfWidth ) {
+				float cosineHalfAngle = ( from.x * miterX + from.y * miterY ) / ( miterLength * halfWidth );
+
+				if ( cosineHalfAngle > 1e-6f && 1.0f / cosineHalfAngle <= style.miterLimit ) {
+					float tipDistance = halfWidth / cosineHalfAngle / miterLength;
+					outline.push_back( { point.x + miterX * tipDistance, point.y + miterY * tipDistance } );
+				}
+			}
+		}
+
+		// Bevel joins, and miters that went over the limit, are a straight line across
+		outline.push_back( { point.x + to.x, point.y + to.y } );
+	};
+
+	// Adds the end of an open contour, going around it from one side to the other
+	auto addCap = [ & ]( Point point, Point offset ) {
+		Point outward = { -offset.y, offset.x };
+
+		outline.push_back( { point.x + offset.x, point.y + offset.y } );
+		if ( style.cap == LineCap::Round ) {
+			addArc( outline, point, offset, { -offset.x, -offset.y }, stepCosine, stepSine );
+			return;
+		}
+
+		// Square caps extend the line by half the width
+		if ( style.cap == LineCap::Square ) {
+			outline.push_back( { point.x + offset.x + outward.x, point.y + offset.y + outward.y } );
+			outline.push_back( { point.x - offset.x + outward.x, point.y - offset.y + outward.y } );
+		}
+
+		outline.push_back( { point.x - offset.x, point.y - offset.y } );
+	};
+
+	for ( const FlattenedPath::Contour &contour : flattened.contours ) {
+
+		// Copy the points, dropping repeats that would give zero-length lines with no direction
+		contourPoints.clear();
+		for ( unsigned int index = 0; index < contour.count; index++ ) {
+			Point point = flattened.points[ contour.first + index ];
+			if ( !contourPoints.empty() && std::fabs( point.x - contourPoints.back().x ) < 1e-6f && std::fabs( point.y - contourPoints.back().y ) < 1e-6f ) continue;
+			contourPoints.push_back( point );
+		}
+
+		// Closed contours usually end where they started
+		if ( contour.isClosed && contourPoints.size() > 1 && std::fabs( contourPoints.front().x - contourPoints.back().x ) < 1e-6f && std::fabs( contourPoints.front().y - contourPoints.back().y ) < 1e-6f ) {
+			contourPoints.pop_back();
+		}
+
+		size_t count = contourPoints.size();
+		if ( count == 0 ) continue;
+
+		// A single point only draws its caps
+		if ( count == 1 ) {
+			Point point = contourPoints[ 0 ];
+
+			if ( !contour.isClosed && style.cap == LineCap::Round ) {
+				addCircle( rasterizer, polygon, circleOffsets, point );
+			} else if ( !contour.isClosed && style.cap == LineCap::Square ) {
+				polygon = { { point.x - halfWidth, point.y - halfWidth }, { point.x + halfWidth, point.y - halfWidth }, { point.x + halfWidth, point.y + halfWidth }, { point.x - halfWidth, point.y + halfWidth } };
+				addPositivePolygon( rasterizer, polygon );
+			}
+
+			continue;
+		}
+
+		// The offset of each line's side, half the width along its normal, pointing so that the outlines below wind the same way as the single points above
+		size_t lineCount = contour.isClosed ? count : count - 1;
+		normals.clear();
+		lengths.clear();
+		for ( size_t index = 0; index < lineCount; index++ ) {
+			Point start = contourPoints[ index ];
+			Point end = contourPoints[ ( index + 1 ) % count ];
+			float length = std::sqrt( ( end.x - start.x ) * ( end.x - start.x ) + ( end.y - start.y ) * ( end.y - start.y ) );
+			float scale = halfWidth / length;
+			normals.push_back( { ( end.y - start.y ) * scale, ( start.x - end.x ) * scale } );
+			lengths.push_back( length );
+		}
+
+		// Closed contours are a loop along each side, forwards along one & backwards along the other
+		if ( contour.isClosed ) {
+			outline.clear();
+			for ( size_t index = 0; index < count; index++ ) {
+				size_t previous = ( index + count - 1 ) % count;
+				addJoin( contourPoints[ index ], normals[ previous ], normals[ index ], lengths[ previous ], lengths[ index ] );
+			}
+			rasterizer.addPolygon( outline.data(), ( unsigned int ) outline.size() );
+
+			outline.clear();
+			for ( size_t index = count; index > 0; index-- ) {
+				Point incoming = normals[ index - 1 ];
+				Point outgoing = normals[ index % count ];
+				addJoin( contourPoints[ index % count ], { -outgoing.x, -outgoing.y }, { -incoming.x, -incoming.y }, lengths[ index % count ], lengths[ index - 1 ] );
+			}
+			rasterizer.addPolygon( outline.data(), ( unsigned int ) outline.size() );
+
+			continue;
+		}
+
+		// Open contours are a single loop: along one side, around the end, back along the other side & around the start
+		outline.clear();
+		for ( size_t index = 1; index + 1 < count; index++ ) addJoin( contourPoints[ index ], normals[ index - 1 ], normals[ index ], lengths[ index - 1 ], lengths[ index ] );
+		addCap( contourPoints[ count - 1 ], normals[ count - 2 ] );
+		for ( size_t index = count - 2; index > 0; index-- ) {
+			addJoin( contourPoints[ index ], { -normals[ index ].x, -normals[ index ].y }, { -normals[ index - 1 ].x, -normals[ index - 1 ].y }, lengths[ index ], lengths[ index - 1 ] );
+		}
+		addCap( contourPoints[ 0 ], { -normals[ 0 ].x, -normals[ 0 ].y } );
+
+		rasterizer.addPolygon( outline.data(), ( unsigned int ) outline.size() );
+
+	}
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Sizes
+#include <cstddef>
+
+// Dynamic arrays
+#include <vector>
+
+// A position in pixels, where the top-left corner of the top-left pixel is the origin
+struct Point {
+	float x;
+	float y;
+};
+
+// How overlapping or self-intersecting areas of a path are filled, same as D2D1_FILL_MODE
+enum class FillRule : uint8_t {
+	NonZero,
+	EvenOdd
+};
+
+// The shape drawn where two stroked segments meet, same as D2D1_LINE_JOIN
+enum class LineJoin : uint8_t {
+	Miter,
+	Bevel,
+	Round
+};
+
+// The shape drawn at the ends of an open stroked contour, same as D2D1_CAP_STYLE
+enum class LineCap : uint8_t {
+	Butt,
+	Square,
+	Round
+};
+
+// Describes how a path is outlined
+struct StrokeStyle {
+	float width = 1.0f;
+	LineJoin join = LineJoin::Miter;
+	LineCap cap = LineCap::Butt;
+	float miterLimit = 10.0f;
+};
+
+// A path after all of its curves have been turned into straight lines
+struct FlattenedPath {
+
+	// A run of points in the array below
+	struct Contour {
+		unsigned int first;
+		unsigned int count;
+		bool isClosed;
+	};
+
+	std::vector<Point> points;
+	std::vector<Contour> contours;
+
+};
+
+// The rasterizer that paths are filled or stroked into
+class Rasterizer;
+
+// A sequence of contours made from lines & Bezier curves, like ID2D1PathGeometry
+class Path {
+
+	// Only usable by this class
+	private:
+
+		// The kinds of segment, each one consumes a number of points
+		enum class Verb : uint8_t {
+			Move, // 1 point
+			Line, // 1 point
+			Quadratic, // 2 points
+			Cubic, // 3 points
+			Close // 0 points
+		};
+
+		// The segments & their points
+		std::vector<Verb> verbs;
+		std::vector<Point> points;
+
+		// Where the current contour started, so it can be closed
+		Point contourStart = { 0.0f, 0.0f };
+
+		// Ensures a contour has been started before a segment is added
+		void ensureContour();
+
+	// Usable by anyone
+	public:
+
+		// Building
+		void moveTo( float, float );
+		void lineTo( float, float );
+		void quadraticTo( float, float, float, float );
+		void cubicTo( float, float, float, float, float, float );
+		void close();
+		void clear();
+
+		// Common shapes
+		void addRectangle( float, float, float, float );
+		void addEllipse( float, float, float, float );
+		void addPolygon( const Point *, unsigned int );
+
+		// Information
+		size_t getSegmentCount() const;
+		bool isEmpty() const;
+
+		// Converting to lines
+		void flatten( float, FlattenedPath & ) const;
+
+};
+
+// Adds the lines of a flattened path to a rasterizer as a fill or as a stroke outline
+void pathFill( const FlattenedPath &, Rasterizer & );
+void pathStroke( const FlattenedPath &, const StrokeStyle &, float, Rasterizer & );
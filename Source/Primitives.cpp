@@ -0,0 +1,381 @@
+#include "Primitives.h"
+
+// Sorting, min & max
+#include <algorithm>
+
+// Rounding
+#include <cmath>
+
+// Allocates room for a number of primitives up front, so adding them never reallocates
+void PrimitiveStore::reserve( size_t count ) {
+
+	this->lefts.reserve( count );
+	this->tops.reserve( count );
+	this->rights.reserve( count );
+	this->bottoms.reserve( count );
+	this->types.reserve( count );
+	this->brushes.reserve( count );
+	this->strokeWidths.reserve( count );
+	this->zOrders.reserve( count );
+	this->indexSlots.reserve( count );
+	this->slotIndices.reserve( count );
+	this->slotGenerations.reserve( count );
+
+}
+
+// Removes every primitive, every existing handle becomes invalid
+void PrimitiveStore::clear() {
+
+	// Keep the generations so old handles do not match the new primitives in the same slots
+	for ( uint32_t slot = 0; slot < this->slotGenerations.size(); slot++ ) {
+		if ( this->slotIndices[ slot ] != UINT32_MAX ) {
+			this->slotIndices[ slot ] = UINT32_MAX;
+			this->slotGenerations[ slot ]++;
+			this->freeSlots.push_back( slot );
+		}
+	}
+
+	this->lefts.clear();
+	this->tops.clear();
+	this->rights.clear();
+	this->bottoms.clear();
+	this->types.clear();
+	this->brushes.clear();
+	this->strokeWidths.clear();
+	this->zOrders.clear();
+	this->indexSlots.clear();
+
+}
+
+// Adds a primitive at the end of the arrays, reusing a slot from a removed primitive if there is one
+PrimitiveHandle PrimitiveStore::add( PrimitiveType type, const Rect &bounds, uint32_t brush, float strokeWidth, int32_t zOrder ) {
+
+	uint32_t index = ( uint32_t ) this->lefts.size();
+
+	PrimitiveHandle handle;
+	if ( !this->freeSlots.empty() ) {
+		handle.slot = this->freeSlots.back();
+		this->freeSlots.pop_back();
+		this->slotIndices[ handle.slot ] = index;
+	} else {
+		handle.slot = ( uint32_t ) this->slotIndices.size();
+		this->slotIndices.push_back( index );
+		this->slotGenerations.push_back( 0 );
+	}
+
+	handle.generation = this->slotGenerations[ handle.slot ];
+
+	this->lefts.push_back( bounds.left );
+	this->tops.push_back( bounds.top );
+	this->rights.push_back( bounds.right );
+	this->bottoms.push_back( bounds.bottom );
+	this->types.push_back( type );
+	this->brushes.push_back( brush );
+	this->strokeWidths.push_back( strokeWidth );
+	this->zOrders.push_back( zOrder );
+	this->indexSlots.push_back( handle.slot );
+
+	return handle;
+
+}
+
+// Removes a primitive by moving the last one into its place, so the arrays never have gaps
+bool PrimitiveStore::remove( PrimitiveHandle handle ) {
+
+	// Do not continue if the primitive was already removed
+	if ( !this->isValid( handle ) ) return false;
+
+	uint32_t index = this->slotIndices[ handle.slot ];
+	uint32_t lastIndex = ( uint32_t ) this->lefts.size() - 1;
+
+	if ( index != lastIndex ) {
+		this->lefts[ index ] = this->lefts[ lastIndex ];
+		this->tops[ index ] = this->tops[ lastIndex ];
+		this->rights[ index ] = this->rights[ lastIndex ];
+		this->bottoms[ index ] = this->bottoms[ lastIndex ];
+		this->types[ index ] = this->types[ lastIndex ];
+		this->brushes[ index ] = this->brushes[ lastIndex ];
+		this->strokeWidths[ index ] = this->strokeWidths[ lastIndex ];
+		this->zOrders[ index ] = this->zOrders[ lastIndex ];
+		this->indexSlots[ index ] = this->indexSlots[ lastIndex ];
+
+		// The moved primitive's handle has to find it at its new index
+		this->slotIndices[ this->indexSlots[ index ] ] = index;
+	}
+
+	this->lefts.pop_back();
+	this->tops.pop_back();
+	this->rights.pop_back();
+	this->bottoms.pop_back();
+	this->types.pop_back();
+	this->brushes.pop_back();
+	this->strokeWidths.pop_back();
+	this->zOrders.pop_back();
+	this->indexSlots.pop_back();
+
+	// Invalidate the handle, then make the slot available again
+	this->slotIndices[ handle.slot ] = UINT32_MAX;
+	this->slotGenerations[ handle.slot ]++;
+	this->freeSlots.push_back( handle.slot );
+
+	return true;
+
+}
+
+// Does the handle still refer to a primitive?
+bool PrimitiveStore::isValid( PrimitiveHandle handle ) const {
+	return handle.slot < this->slotIndices.size() && this->slotGenerations[ handle.slot ] == handle.generation && this->slotIndices[ handle.slot ] != UINT32_MAX;
+}
+
+// Where a primitive currently is in the arrays, UINT32_MAX if it was removed
+uint32_t PrimitiveStore::getIndex( PrimitiveHandle handle ) const {
+	return this->isValid( handle ) ? this->slotIndices[ handle.slot ] : UINT32_MAX;
+}
+
+// The handle of the primitive currently at an index
+PrimitiveHandle PrimitiveStore::getHandle( uint32_t index ) const {
+
+	PrimitiveHandle handle;
+	handle.slot = this->indexSlots[ index ];
+	handle.generation = this->slotGenerations[ handle.slot ];
+	return handle;
+
+}
+
+// Changing a single field of a primitive, each returns false if the primitive was removed
+bool PrimitiveStore::setBounds( PrimitiveHandle handle, const Rect &bounds ) {
+
+	uint32_t index = this->getIndex( handle );
+	if ( index == UINT32_MAX ) return false;
+
+	this->lefts[ index ] = bounds.left;
+	this->tops[ index ] = bounds.top;
+	this->rights[ index ] = bounds.right;
+	this->bottoms[ index ] = bounds.bottom;
+	return true;
+
+}
+
+bool PrimitiveStore::setBrush( PrimitiveHandle handle, uint32_t brush ) {
+
+	uint32_t index = this->getIndex( handle );
+	if ( index == UINT32_MAX ) return false;
+
+	this->brushes[ index ] = brush;
+	return true;
+
+}
+
+bool PrimitiveStore::setStrokeWidth( PrimitiveHandle handle, float strokeWidth ) {
+
+	uint32_t index = this->getIndex( handle );
+	if ( index == UINT32_MAX ) return false;
+
+	this->strokeWidths[ index ] = strokeWidth;
+	return true;
+
+}
+
+bool PrimitiveStore::setZOrder( PrimitiveHandle handle, int32_t zOrder ) {
+
+	uint32_t index = this->getIndex( handle );
+	if ( index == UINT32_MAX ) return false;
+
+	this->zOrders[ index ] = zOrder;
+	return true;
+
+}
+
+// Moves every primitive, such as when scrolling, which only touches the bounds
+void PrimitiveStore::translate( float x, float y ) {
+
+	size_t count = this->lefts.size();
+	float *left = this->lefts.data();
+	float *top = this->tops.data();
+	float *right = this->rights.data();
+	float *bottom = this->bottoms.data();
+
+	for ( size_t index = 0; index < count; index++ ) {
+		left[ index ] += x;
+		top[ index ] += y;
+		right[ index ] += x;
+		bottom[ index ] += y;
+	}
+
+}
+
+// Reading the fields
+size_t PrimitiveStore::getCount() const {
+	return this->lefts.size();
+}
+
+Rect PrimitiveStore::getBounds( uint32_t index ) const {
+	return { this->lefts[ index ], this->tops[ index ], this->rights[ index ], this->bottoms[ index ] };
+}
+
+const float *PrimitiveStore::getLefts() const {
+	return this->lefts.data();
+}
+
+const float *PrimitiveStore::getTops() const {
+	return this->tops.data();
+}
+
+const float *PrimitiveStore::getRights() const {
+	return this->rights.data();
+}
+
+const float *PrimitiveStore::getBottoms() const {
+	return this->bottoms.data();
+}
+
+const PrimitiveType *PrimitiveStore::getTypes() const {
+	return this->types.data();
+}
+
+const uint32_t *PrimitiveStore::getBrushes() const {
+	return this->brushes.data();
+}
+
+const float *PrimitiveStore::getStrokeWidths() const {
+	return this->strokeWidths.data();
+}
+
+const int32_t *PrimitiveStore::getZOrders() const {
+	return this->zOrders.data();
+}
+
+// Finds the indices of every primitive that overlaps an area (including half its stroke, which sticks out of the bounds), in the order they are stored
+// Each block is tested without any branches so the compiler can test several primitives per instruction, then only blocks with something visible are gathered
+void PrimitiveStore::cull( const Rect &area, std::vector<uint32_t> &visible ) const {
+
+	visible.clear();
+
+	size_t count = this->lefts.size();
+	const float *left = this->lefts.data();
+	const float *top = this->tops.data();
+	const float *right = this->rights.data();
+	const float *bottom = this->bottoms.data();
+	const float *strokeWidth = this->strokeWidths.data();
+
+	uint8_t isVisible[ PRIMITIVE_CULL_BLOCK_SIZE ];
+	for ( size_t blockStart = 0; blockStart < count; blockStart += PRIMITIVE_CULL_BLOCK_SIZE ) {
+		size_t blockSize = std::min<size_t>( PRIMITIVE_CULL_BLOCK_SIZE, count - blockStart );
+
+		uint8_t isAnyVisible = 0;
+		for ( size_t offset = 0; offset < blockSize; offset++ ) {
+			size_t index = blockStart + offset;
+			float halfStroke = strokeWidth[ index ] * 0.5f;
+
+			isVisible[ offset ] = ( uint8_t ) (
+				( left[ index ] - halfStroke < area.right ) &
+				( right[ index ] + halfStroke > area.left ) &
+				( top[ index ] - halfStroke < area.bottom ) &
+				( bottom[ index ] + halfStroke > area.top )
+			);
+
+			isAnyVisible |= isVisible[ offset ];
+		}
+
+		// Most blocks of a large scene are entirely off screen
+		if ( !isAnyVisible ) continue;
+
+		for ( size_t offset = 0; offset < blockSize; offset++ ) {
+			if ( isVisible[ offset ] ) visible.push_back( ( uint32_t ) ( blockStart + offset ) );
+		}
+	}
+
+}
+
+// Sorts every primitive overlapping an area into a grid of square tiles, so each tile can be drawn with only the primitives that touch it
+// Culls to the grid first, then counts the primitives in each tile so every tile's indices can be written straight into one array without any per-tile allocations
+void PrimitiveStore::bin( unsigned int tileSize, unsigned int width, unsigned int height, PrimitiveBins &bins ) const {
+
+	bins.tileSize = tileSize > 0 ? tileSize : 1;
+	bins.columns = ( width + bins.tileSize - 1 ) / bins.tileSize;
+	bins.rows = ( height + bins.tileSize - 1 ) / bins.tileSize;
+	bins.offsets.assign( ( size_t ) bins.columns * bins.rows + 1, 0 );
+	bins.indices.clear();
+
+	// Do not continue if there are no tiles
+	if ( bins.columns == 0 || bins.rows == 0 ) return;
+
+	// Only the primitives that overlap the grid need looking at twice
+	this->cull( { 0.0f, 0.0f, ( float ) width, ( float ) height }, bins.candidates );
+
+	float tileScale = 1.0f / ( float ) bins.tileSize;
+	int lastColumn = ( int ) bins.columns - 1;
+	int lastRow = ( int ) bins.rows - 1;
+
+	// The range of tiles a primitive touches, a primitive ending exactly on the edge of a tile does not touch the next one
+	auto getTiles = [ & ]( uint32_t index, int &firstX, int &firstY, int &lastX, int &lastY ) {
+		float halfStroke = this->strokeWidths[ index ] * 0.5f;
+		firstX = ( int ) ( std::max( this->lefts[ index ] - halfStroke, 0.0f ) * tileScale );
+		firstY = ( int ) ( std::max( this->tops[ index ] - halfStroke, 0.0f ) * tileScale );
+		lastX = std::min( ( int ) std::ceil( std::min( this->rights[ index ] + halfStroke, ( float ) width ) * tileScale ) - 1, lastColumn );
+		lastY = std::min( ( int ) std::ceil( std::min( this->bottoms[ index ] + halfStroke, ( float ) height ) * tileScale ) - 1, lastRow );
+	};
+
+	// Count the primitives in each tile...
+	int firstX, firstY, lastX, lastY;
+	for ( uint32_t index : bins.candidates ) {
+		getTiles( index, firstX, firstY, lastX, lastY );
+
+		for ( int y = firstY; y <= lastY; y++ ) {
+			for ( int x = firstX; x <= lastX; x++ ) bins.offsets[ ( size_t ) y * bins.columns + x + 1 ]++;
+		}
+	}
+
+	// ...turn the counts into where each tile's indices start...
+	for ( size_t tile = 1; tile < bins.offsets.size(); tile++ ) bins.offsets[ tile ] += bins.offsets[ tile - 1 ];
+	bins.indices.resize( bins.offsets.back() );
+
+	// ...then write the indices, in the order they are stored
+	std::vector<uint32_t> nextOffsets( bins.offsets.begin(), bins.offsets.end() - 1 );
+	for ( uint32_t index : bins.candidates ) {
+		getTiles( index, firstX, firstY, lastX, lastY );
+
+		for ( int y = firstY; y <= lastY; y++ ) {
+			for ( int x = firstX; x <= lastX; x++ ) bins.indices[ nextOffsets[ ( size_t ) y * bins.columns + x ]++ ] = index;
+		}
+	}
+
+}
+
+// Sorts indices into the order they should be drawn in, primitives with the same z-order are kept in the order of their slots so they do not swap as others are removed
+void PrimitiveStore::sortByZOrder( std::vector<uint32_t> &indices ) const {
+
+	std::sort( indices.begin(), indices.end(), [ this ]( uint32_t first, uint32_t second ) {
+		if ( this->zOrders[ first ] != this->zOrders[ second ] ) return this->zOrders[ first ] < this->zOrders[ second ];
+		return this->indexSlots[ first ] < this->indexSlots[ second ];
+	} );
+
+}
+
+// Draws primitives one after another, brushes outside the palette use its first paint
+void primitivesDraw( Canvas &canvas, const PrimitiveStore &store, const std::vector<uint32_t> &indices, const Paint *palette, size_t paletteSize ) {
+
+	// Do not continue if there is nothing to draw with
+	if ( paletteSize == 0 ) return;
+
+	const PrimitiveType *types = store.getTypes();
+	const uint32_t *brushes = store.getBrushes();
+	const float *strokeWidths = store.getStrokeWidths();
+
+	for ( uint32_t index : indices ) {
+		Rect bounds = store.getBounds( index );
+		const Paint &paint = palette[ brushes[ index ] < paletteSize ? brushes[ index ] : 0 ];
+
+		Point center = { ( bounds.left + bounds.right ) * 0.5f, ( bounds.top + bounds.bottom ) * 0.5f };
+		float radiusX = ( bounds.right - bounds.left ) * 0.5f;
+		float radiusY = ( bounds.bottom - bounds.top ) * 0.5f;
+
+		switch ( types[ index ] ) {
+			case PrimitiveType::FillRectangle: canvas.fillRectangle( bounds, paint ); break;
+			case PrimitiveType::DrawRectangle: canvas.drawRectangle( bounds, paint, strokeWidths[ index ] ); break;
+			case PrimitiveType::FillEllipse: canvas.fillEllipse( center, radiusX, radiusY, paint ); break;
+			case PrimitiveType::DrawEllipse: canvas.drawEllipse( center, radiusX, radiusY, paint, strokeWidths[ index ] ); break;
+		}
+	}
+
+}
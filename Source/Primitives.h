@@ -0,0 +1,112 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Sizes
+#include <cstddef>
+
+// Dynamic arrays
+#include <vector>
+
+// Rectangles, paints & the canvas to draw onto
+#include "Canvas.h"
+
+// How many primitives are tested at once when culling, small enough for the results to stay in the L1 cache
+const unsigned int PRIMITIVE_CULL_BLOCK_SIZE = 256;
+
+// The kinds of shape that can be stored, all of which fit in their bounds
+enum class PrimitiveType : uint8_t {
+	FillRectangle,
+	DrawRectangle,
+	FillEllipse,
+	DrawEllipse
+};
+
+// Refers to a primitive for as long as it exists, even as removing others moves it within the store
+// The generation is bumped every time a slot is reused, so an old handle to a removed primitive never finds its replacement
+struct PrimitiveHandle {
+	uint32_t slot = UINT32_MAX;
+	uint32_t generation = 0;
+};
+
+// The primitives overlapping each tile of a grid, with every tile's indices stored one after another
+// The indices for tile (column, row) are indices[ offsets[ row * columns + column ] ] up to indices[ offsets[ row * columns + column + 1 ] ]
+struct PrimitiveBins {
+	unsigned int tileSize = 0;
+	unsigned int columns = 0;
+	unsigned int rows = 0;
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> indices;
+	std::vector<uint32_t> candidates; // Reused between calls, the primitives overlapping the grid at all
+};
+
+// Stores lots of primitives as a structure of arrays, so a pass that only needs some of the fields (such as culling by bounds) only reads those
+// Primitives are kept packed at the start of every array by moving the last one into the gap left by a removal, so their order is not stable but handles are
+class PrimitiveStore {
+
+	// Only usable by this class
+	private:
+
+		// The fields of each primitive, all indexed the same way
+		std::vector<float> lefts;
+		std::vector<float> tops;
+		std::vector<float> rights;
+		std::vector<float> bottoms;
+		std::vector<PrimitiveType> types;
+		std::vector<uint32_t> brushes; // Index into the palette the store is drawn with
+		std::vector<float> strokeWidths; // Zero for filled shapes
+		std::vector<int32_t> zOrders; // Higher is drawn on top
+
+		// Which slot each primitive belongs to, to update the slot when the primitive is moved
+		std::vector<uint32_t> indexSlots;
+
+		// Where each handle's primitive currently is, the generation of the slot, and slots that can be reused
+		std::vector<uint32_t> slotIndices;
+		std::vector<uint32_t> slotGenerations;
+		std::vector<uint32_t> freeSlots;
+
+	// Usable by anyone
+	public:
+
+		// Setup
+		void reserve( size_t );
+		void clear();
+
+		// Adding & removing
+		PrimitiveHandle add( PrimitiveType, const Rect &, uint32_t, float, int32_t );
+		bool remove( PrimitiveHandle );
+
+		// Finding a primitive, the index is only valid until the next primitive is removed
+		bool isValid( PrimitiveHandle ) const;
+		uint32_t getIndex( PrimitiveHandle ) const;
+		PrimitiveHandle getHandle( uint32_t ) const;
+
+		// Changing a primitive
+		bool setBounds( PrimitiveHandle, const Rect & );
+		bool setBrush( PrimitiveHandle, uint32_t );
+		bool setStrokeWidth( PrimitiveHandle, float );
+		bool setZOrder( PrimitiveHandle, int32_t );
+		void translate( float, float );
+
+		// Reading the fields, every array has getCount() entries
+		size_t getCount() const;
+		Rect getBounds( uint32_t ) const;
+		const float *getLefts() const;
+		const float *getTops() const;
+		const float *getRights() const;
+		const float *getBottoms() const;
+		const PrimitiveType *getTypes() const;
+		const uint32_t *getBrushes() const;
+		const float *getStrokeWidths() const;
+		const int32_t *getZOrders() const;
+
+		// Finding the primitives to draw
+		void cull( const Rect &, std::vector<uint32_t> & ) const;
+		void bin( unsigned int, unsigned int, unsigned int, PrimitiveBins & ) const;
+		void sortByZOrder( std::vector<uint32_t> & ) const;
+
+};
+
+// Draws primitives in the order given, with a palette of paints that the brush ids index into
+void primitivesDraw( Canvas &, const PrimitiveStore &, const std::vector<uint32_t> &, const Paint *, size_t );
@@ -0,0 +1,19 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// A simple linear congruential generator, which gives the same numbers with every compiler (the standard library's distributions do not)
+// Anything generated from the same seed, such as benchmark data or the kernels' self-test, is the same in every build so results can be compared
+// The state starts as the seed, and only the top 24 bits are returned as the low bits repeat quickly
+inline uint32_t randomNext( uint32_t &state ) {
+
+	state = state * 1664525u + 1013904223u;
+	return state >> 8;
+
+}
+
+// A random number from 0 up to (but not including) 1
+inline float randomUnit( uint32_t &state ) {
+	return ( float ) randomNext( state ) / 16777216.0f;
+}
@@ -0,0 +1,302 @@
+#include "Rasterizer.h"
+
+// Floor, ceiling, rounding, etc.
+#include <cmath>
+
+// Sorting, min & max
+#include <algorithm>
+
+// Limits of integer types
+#include <climits>
+
+// The fastest coverage accumulation for the CPU
+#include "Kernels.h"
+
+// Clears every line & sets the drawing area size
+void Rasterizer::reset( unsigned int newWidth, unsigned int newHeight ) {
+
+	// Only the bands that lines were added to have anything to clear
+	if ( this->edgeCount > 0 ) {
+		unsigned int firstBand = ( unsigned int ) std::max( 0.0f, this->minimumY ) / RASTERIZER_BAND_HEIGHT;
+		unsigned int lastBand = std::min( ( unsigned int ) std::max( 0.0f, this->maximumY ) / RASTERIZER_BAND_HEIGHT, ( unsigned int ) this->bandEdges.size() - 1 );
+		for ( unsigned int band = firstBand; band <= lastBand; band++ ) this->bandEdges[ band ].clear();
+	}
+
+	this->width = newWidth;
+	this->height = newHeight;
+	this->edgeCount = 0;
+	this->minimumY = ( float ) newHeight;
+	this->maximumY = 0.0f;
+
+	// Keep each band's list between resets, so lines are not reallocated for every shape
+	unsigned int bandCount = ( newHeight + RASTERIZER_BAND_HEIGHT - 1 ) / RASTERIZER_BAND_HEIGHT;
+	if ( this->bandEdges.size() < bandCount ) this->bandEdges.resize( bandCount );
+
+	// The cells must always be zero between renders, so only reallocate them if the width changed
+	this->cellStride = newWidth + 2;
+	if ( this->cells.size() != ( size_t ) this->cellStride * RASTERIZER_BAND_HEIGHT ) this->cells.assign( ( size_t ) this->cellStride * RASTERIZER_BAND_HEIGHT, 0.0f );
+	this->coverage.resize( ( size_t ) newWidth + 1 );
+
+}
+
+// Adds a line known to be within the left & right clip edges
+void Rasterizer::addEdge( float startX, float startY, float endX, float endY ) {
+
+	// Horizontal lines do not cross any rows, so they add no area
+	if ( startY == endY ) return;
+
+	// Store every edge going downwards, remembering which way it really went
+	Edge edge;
+	if ( startY < endY ) {
+		edge = { startX, startY, endY, ( endX - startX ) / ( endY - startY ), 1.0f };
+	} else {
+		edge = { endX, endY, startY, ( startX - endX ) / ( startY - endY ), -1.0f };
+	}
+
+	unsigned int row = std::min( ( unsigned int ) std::max( 0.0f, edge.topY ), this->height - 1 );
+	this->bandEdges[ row / RASTERIZER_BAND_HEIGHT ].push_back( edge );
+	this->edgeCount++;
+	this->minimumY = std::min( this->minimumY, edge.topY );
+	this->maximumY = std::max( this->maximumY, edge.bottomY );
+
+}
+
+// Adds a line, clipping it to the drawing area
+void Rasterizer::addLine( Point start, Point end ) {
+
+	// Horizontal lines add no area, and NaNs would poison every cell they touch
+	if ( start.y == end.y || std::isnan( start.x ) || std::isnan( start.y ) || std::isnan( end.x ) || std::isnan( end.y ) ) return;
+
+	// Lines entirely above or below the drawing area never cross a row
+	if ( std::max( start.y, end.y ) <= 0.0f || std::min( start.y, end.y ) >= ( float ) this->height ) return;
+
+	float right = ( float ) this->width;
+
+	// Lines entirely to the left still cover everything to their right, so flatten them onto the left edge
+	if ( start.x <= 0.0f && end.x <= 0.0f ) {
+		this->addEdge( 0.0f, start.y, 0.0f, end.y );
+		return;
+	}
+
+	// Lines entirely to the right only change the winding past the last pixel, so flatten them onto the right edge (the spare cell there is never output)
+	if ( start.x >= right && end.x >= right ) {
+		this->addEdge( right, start.y, right, end.y );
+		return;
+	}
+
+	// Lines within the left & right sides can be added as they are
+	if ( start.x >= 0.0f && start.x <= right && end.x >= 0.0f && end.x <= right ) {
+		this->addEdge( start.x, start.y, end.x, end.y );
+		return;
+	}
+
+	// Otherwise split the line where it crosses each side
+	float splits[ 4 ] = { 0.0f, 1.0f, 1.0f, 1.0f };
+	unsigned int splitCount = 1;
+	float deltaX = end.x - start.x;
+
+	if ( ( start.x < 0.0f ) != ( end.x < 0.0f ) ) splits[ splitCount++ ] = ( 0.0f - start.x ) / deltaX;
+	if ( ( start.x > right ) != ( end.x > right ) ) splits[ splitCount++ ] = ( right - start.x ) / deltaX;
+	splits[ splitCount++ ] = 1.0f;
+	std::sort( splits, splits + splitCount );
+
+	for ( unsigned int index = 0; index + 1 < splitCount; index++ ) {
+		float pieceStartY = start.y + ( end.y - start.y ) * splits[ index ];
+		float pieceEndY = start.y + ( end.y - start.y ) * splits[ index + 1 ];
+		float pieceStartX = start.x + deltaX * splits[ index ];
+		float pieceEndX = start.x + deltaX * splits[ index + 1 ];
+		float middleX = ( pieceStartX + pieceEndX ) * 0.5f;
+
+		// Pieces to either side become vertical lines on that edge
+		if ( middleX <= 0.0f ) {
+			this->addEdge( 0.0f, pieceStartY, 0.0f, pieceEndY );
+		} else if ( middleX >= right ) {
+			this->addEdge( right, pieceStartY, right, pieceEndY );
+		} else {
+			this->addEdge( std::clamp( pieceStartX, 0.0f, right ), pieceStartY, std::clamp( pieceEndX, 0.0f, right ), pieceEndY );
+		}
+	}
+
+}
+
+// Adds a closed polygon through every given point
+void Rasterizer::addPolygon( const Point *points, unsigned int count ) {
+
+	if ( count < 2 ) return;
+
+	for ( unsigned int index = 0; index + 1 < count; index++ ) this->addLine( points[ index ], points[ index + 1 ] );
+	this->addLine( points[ count - 1 ], points[ 0 ] );
+
+}
+
+// Have any lines been added since the last reset?
+bool Rasterizer::isEmpty() const {
+	return this->edgeCount == 0;
+}
+
+// The number of lines left after clipping
+size_t Rasterizer::getEdgeCount() const {
+	return this->edgeCount;
+}
+
+// Adds the area of the part of a line within each row of a band, given the top & bottom of the band
+bool Rasterizer::accumulateEdge( const Edge &edge, unsigned int bandTop, unsigned int bandBottom ) {
+
+	float top = std::max( edge.topY, ( float ) bandTop );
+	float bottom = std::min( edge.bottomY, ( float ) bandBottom );
+
+	// Both are positive, so truncating is the same as rounding down
+	unsigned int row = ( unsigned int ) top;
+	float topX = edge.topX + ( top - edge.topY ) * edge.slope;
+
+	while ( top < bottom ) {
+		float rowBottom = std::min( ( float ) ( row + 1 ), bottom );
+		float bottomX = edge.topX + ( rowBottom - edge.topY ) * edge.slope;
+
+		this->accumulateLine( row - bandTop, topX, bottomX, ( rowBottom - top ) * edge.direction );
+
+		topX = bottomX;
+		top = rowBottom;
+		row++;
+	}
+
+	return edge.bottomY > ( float ) bandBottom;
+
+}
+
+// Adds the area covered by part of a line within a single row of the band, given its X at the top & bottom of that part, and its signed height
+// The area to the right of the line within each cell is added, so that the running sum across the row gives the coverage of each pixel
+void Rasterizer::accumulateLine( unsigned int rowIndex, float topX, float bottomX, float height ) {
+
+	float *row = &this->cells[ ( size_t ) rowIndex * this->cellStride ];
+	unsigned int &minimumCell = this->minimumCells[ rowIndex ];
+	unsigned int &maximumCell = this->maximumCells[ rowIndex ];
+	float right = ( float ) this->width;
+
+	// Guard against rounding errors pushing the line outside of the clip edges
+	topX = std::clamp( topX, 0.0f, right );
+	bottomX = std::clamp( bottomX, 0.0f, right );
+
+	// Both are positive, so truncating is the same as rounding down (and much cheaper than floor & ceil without SSE4.1)
+	float leftX = std::min( topX, bottomX );
+	float rightX = std::max( topX, bottomX );
+	unsigned int leftCell = ( unsigned int ) leftX;
+	unsigned int rightCell = ( unsigned int ) rightX;
+	if ( ( float ) rightCell < rightX ) rightCell++;
+	float leftFloor = ( float ) leftCell;
+	float rightCeiling = ( float ) rightCell;
+
+	// The line is within a single column, so its area is split between that cell & the next using its average X
+	if ( rightCell <= leftCell + 1 ) {
+		float middle = 0.5f * ( topX + bottomX ) - leftFloor;
+		row[ leftCell ] += height - height * middle;
+		row[ leftCell + 1 ] += height * middle;
+
+		minimumCell = std::min( minimumCell, leftCell );
+		maximumCell = std::max( maximumCell, leftCell + 1 );
+		return;
+	}
+
+	// The line spans several columns, so each one gets a share of the area based on where the line crosses it
+	float inverseWidth = 1.0f / ( rightX - leftX );
+	float leftFraction = leftX - leftFloor;
+	float leftArea = 0.5f * inverseWidth * ( 1.0f - leftFraction ) * ( 1.0f - leftFraction );
+	float rightFraction = rightX - rightCeiling + 1.0f;
+	float rightArea = 0.5f * inverseWidth * rightFraction * rightFraction;
+
+	row[ leftCell ] += height * leftArea;
+
+	if ( rightCell == leftCell + 2 ) {
+		row[ leftCell + 1 ] += height * ( 1.0f - leftArea - rightArea );
+	} else {
+		float secondArea = inverseWidth * ( 1.5f - leftFraction );
+		row[ leftCell + 1 ] += height * ( secondArea - leftArea );
+
+		for ( unsigned int cell = leftCell + 2; cell < rightCell - 1; cell++ ) row[ cell ] += height * inverseWidth;
+
+		float lastArea = secondArea + ( float ) ( rightCell - leftCell - 3 ) * inverseWidth;
+		row[ rightCell - 1 ] += height * ( 1.0f - lastArea - rightArea );
+	}
+
+	row[ rightCell ] += height * rightArea;
+
+	minimumCell = std::min( minimumCell, leftCell );
+	maximumCell = std::max( maximumCell, rightCell );
+
+}
+
+// Produces the coverage for every row touched by the lines, which are kept until the next reset
+void Rasterizer::render( FillRule fillRule, const RasterizerSpanCallback &spanCallback ) {
+
+	if ( this->edgeCount == 0 || this->width == 0 ) return;
+
+	unsigned int firstRow = ( unsigned int ) std::max( 0.0f, std::floor( this->minimumY ) );
+	unsigned int lastRow = ( unsigned int ) std::min( ( float ) this->height, std::ceil( this->maximumY ) );
+	if ( firstRow >= lastRow ) return;
+
+	this->continuingEdges.clear();
+
+	for ( unsigned int band = firstRow / RASTERIZER_BAND_HEIGHT; band * RASTERIZER_BAND_HEIGHT < lastRow; band++ ) {
+		unsigned int bandTop = band * RASTERIZER_BAND_HEIGHT;
+		unsigned int bandBottom = std::min( bandTop + RASTERIZER_BAND_HEIGHT, this->height );
+
+		for ( unsigned int rowIndex = 0; rowIndex < RASTERIZER_BAND_HEIGHT; rowIndex++ ) {
+			this->minimumCells[ rowIndex ] = UINT_MAX;
+			this->maximumCells[ rowIndex ] = 0;
+		}
+
+		// Add the lines from the bands above, then the ones starting in this band, keeping the ones that go on below it
+		this->nextContinuingEdges.clear();
+		for ( const Edge &edge : this->continuingEdges ) {
+			if ( this->accumulateEdge( edge, bandTop, bandBottom ) ) this->nextContinuingEdges.push_back( edge );
+		}
+
+		for ( const Edge &edge : this->bandEdges[ band ] ) {
+			if ( this->accumulateEdge( edge, bandTop, bandBottom ) ) this->nextContinuingEdges.push_back( edge );
+		}
+
+		std::swap( this->continuingEdges, this->nextContinuingEdges );
+
+		for ( unsigned int row = bandTop; row < bandBottom; row++ ) {
+			unsigned int rowIndex = row - bandTop;
+			unsigned int minimumCell = this->minimumCells[ rowIndex ];
+			unsigned int maximumCell = this->maximumCells[ rowIndex ];
+			float *rowCells = &this->cells[ ( size_t ) rowIndex * this->cellStride ];
+
+			// Skip rows that nothing touched
+			if ( minimumCell == UINT_MAX ) continue;
+
+			// Lines right of the drawing area were flattened onto its right edge, so every pixel right of the last touched cell has the same winding as the left of the row, and is empty
+			if ( minimumCell < this->width ) {
+				unsigned int count = std::min( maximumCell, this->width - 1 ) - minimumCell + 1;
+				kernelTable.coverage( rowCells + minimumCell, this->coverage.data(), count, fillRule );
+				spanCallback( row, minimumCell, count, this->coverage.data() );
+			}
+
+			// Leave the cells cleared for the next band
+			std::fill( rowCells + minimumCell, rowCells + maximumCell + 1, 0.0f );
+		}
+	}
+
+}
+
+// Turns a row of accumulated cell areas into 8-bit coverage, using the running sum across the row
+// With the non-zero rule the coverage is the absolute winding clamped to 1, with even-odd it folds back down between every odd & even winding
+void accumulateCoverage( const float *cells, uint8_t *coverage, unsigned int count, FillRule fillRule ) {
+
+	float sum = 0.0f;
+	for ( unsigned int index = 0; index < count; index++ ) {
+		sum += cells[ index ];
+
+		float winding = std::fabs( sum );
+		if ( fillRule == FillRule::NonZero ) {
+			winding = std::min( winding, 1.0f );
+		} else {
+			winding -= 2.0f * ( float ) ( int ) ( winding * 0.5f );
+			winding = std::min( winding, 2.0f - winding );
+		}
+
+		coverage[ index ] = ( uint8_t ) std::lrintf( winding * 255.0f );
+	}
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Dynamic arrays
+#include <vector>
+
+// Callbacks for each rasterized row
+#include <functional>
+
+// Points & fill rules
+#include "Path.h"
+
+// Receives the coverage of a run of pixels on a single row: row, first column, number of pixels, coverage (0 to 255) of each pixel
+using RasterizerSpanCallback = std::function<void( unsigned int, unsigned int, unsigned int, const uint8_t * )>;
+
+// The number of rows rendered together, the cells for them all stay in the cache while every line crossing them is added
+const unsigned int RASTERIZER_BAND_HEIGHT = 16;
+
+// Turns lines into anti-aliased per-pixel coverage, a band of scanlines at a time
+// Each line adds the exact area it covers to the cells of a row, the running sum of those cells across the row is the winding number of each pixel
+// Lines are kept with the band they start in, so nothing needs sorting: each band adds the lines starting in it & the ones continuing from the band above, and only the columns they touched are summed & cleared, so empty space is free
+class Rasterizer {
+
+	// Only usable by this class
+	private:
+
+		// A line going downwards, with the direction it originally went in
+		struct Edge {
+			float topX;
+			float topY;
+			float bottomY;
+			float slope; // Change in X for each change in Y
+			float direction; // +1 if the line went down, -1 if it went up
+		};
+
+		// The size of the area being drawn to, anything outside is clipped
+		unsigned int width = 0;
+		unsigned int height = 0;
+
+		// Every line added since the last reset by the band it starts in, and the vertical extent of them all
+		std::vector<std::vector<Edge>> bandEdges;
+		size_t edgeCount = 0;
+		float minimumY = 0.0f;
+		float maximumY = 0.0f;
+
+		// Lines crossing into the band being rendered from the ones above it, and the ones crossing out of it
+		std::vector<Edge> continuingEdges;
+		std::vector<Edge> nextContinuingEdges;
+
+		// Signed area added to each cell of every row in the band, with 2 extra cells per row for lines touching the right-hand side
+		std::vector<float> cells;
+		unsigned int cellStride = 0;
+
+		// The range of cells touched on each row of the band
+		unsigned int minimumCells[ RASTERIZER_BAND_HEIGHT ];
+		unsigned int maximumCells[ RASTERIZER_BAND_HEIGHT ];
+
+		// The coverage of each pixel on the current row
+		std::vector<uint8_t> coverage;
+
+		// Adds a line known to be within the left & right clip edges
+		void addEdge( float, float, float, float );
+
+		// Adds the area of a line within the rows of a band, returns whether it continues below the band
+		bool accumulateEdge( const Edge &, unsigned int, unsigned int );
+
+		// Adds the area covered by part of a line within a single row
+		void accumulateLine( unsigned int, float, float, float );
+
+	// Usable by anyone
+	public:
+
+		// Clears every line & sets the drawing area size
+		void reset( unsigned int, unsigned int );
+
+		// Adding geometry
+		void addLine( Point, Point );
+		void addPolygon( const Point *, unsigned int );
+
+		// Information
+		bool isEmpty() const;
+		size_t getEdgeCount() const;
+
+		// Produces the coverage for every row touched by the lines
+		void render( FillRule, const RasterizerSpanCallback & );
+
+};
+
+// Turns a row of accumulated cell areas into 8-bit coverage, the plain version of the coverage kernel
+void accumulateCoverage( const float *, uint8_t *, unsigned int, FillRule );
@@ -0,0 +1,271 @@
+#include "Recorder.h"
+
+// Image & video encoders
+#include "Encoder.h"
+
+// Job system
+#include "Thread.h"
+
+// Timing
+#include <chrono>
+
+// Copying pixels & formatting file names
+#include <cstring>
+#include <cstdio>
+
+// Creating the output directory
+#include <filesystem>
+
+// The current time in milliseconds, for the statistics
+static double recorderNow() {
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+// Waits for any queued frames to be written when this class is destroyed
+FrameRecorder::~FrameRecorder() {
+	this->stop();
+}
+
+// Starts recording to a directory of images or a video file, with room for a number of frames to be in flight at once
+bool FrameRecorder::start( const std::string &outputPath, RecordingFormat outputFormat, unsigned int queueCapacity, unsigned int outputFrameRate ) {
+
+	this->stop();
+
+	if ( queueCapacity == 0 || outputFrameRate == 0 ) return false;
+
+	// Images go in a directory, the video is a single file that is written as it goes
+	// Every frame is encoded into one block & written with a single call, so the disk already sees large writes without the stream buffering them again
+	if ( outputFormat == RecordingFormat::QOI ) {
+		std::error_code error;
+		std::filesystem::create_directories( outputPath, error );
+		if ( error ) return false;
+	} else {
+		this->videoStream.open( outputPath, std::ios::binary | std::ios::trunc );
+		if ( !this->videoStream.is_open() ) return false;
+	}
+
+	this->path = outputPath;
+	this->format = outputFormat;
+	this->frameRate = outputFrameRate;
+	this->videoWidth = 0;
+	this->videoHeight = 0;
+
+	// Allocate the queue up front, the pixels are allocated by the first frame of each size
+	this->frames.clear();
+	this->freeFrames.clear();
+	for ( unsigned int index = 0; index < queueCapacity; index++ ) {
+		this->frames.push_back( std::make_unique<RecorderFrame>() );
+		this->freeFrames.push_back( this->frames.back().get() );
+	}
+
+	this->writingFrame = NULL;
+	this->encodedFrames.clear();
+	this->nextSubmitNumber = 0;
+	this->nextWriteNumber = 0;
+	this->isWriting = false;
+
+	this->statistics = RecorderStatistics();
+	this->statistics.queueCapacity = queueCapacity;
+
+	this->isStarted = true;
+	return true;
+
+}
+
+// Waits for every queued frame to be written, then closes the output
+void FrameRecorder::stop() {
+
+	std::unique_lock<std::mutex> lock( this->mutex );
+	if ( !this->isStarted ) return;
+
+	// The workers signal this once the last frame in the queue is written
+	this->queueEmptied.wait( lock, [ this ]() {
+		return this->statistics.queuedCount == 0;
+	} );
+
+	// A frame being drawn into was never handed over, so it is not recorded
+	if ( this->writingFrame != NULL ) this->freeFrames.push_back( this->writingFrame );
+	this->writingFrame = NULL;
+
+	if ( this->videoStream.is_open() ) this->videoStream.close();
+	this->isStarted = false;
+
+}
+
+// Is the recorder accepting frames?
+bool FrameRecorder::isRecording() {
+
+	std::lock_guard<std::mutex> lock( this->mutex );
+	return this->isStarted && !this->statistics.hasFailed;
+
+}
+
+// Gives the renderer the next free frame in the queue to draw into, so it is encoded without being copied, or drops it straight away if the queue is full
+// The frame is only recorded once endFrame() hands it over, fails if the frame is not the size of the video
+bool FrameRecorder::beginFrame( unsigned int width, unsigned int height, Framebuffer &framebuffer ) {
+
+	double startTime = recorderNow();
+	std::lock_guard<std::mutex> lock( this->mutex );
+	if ( !this->isStarted || this->statistics.hasFailed || this->writingFrame != NULL || width == 0 || height == 0 ) return false;
+
+	this->statistics.submittedCount++;
+
+	// The video is the size of its first frame, it cannot change part way through
+	if ( this->format == RecordingFormat::Y4M ) {
+		if ( this->videoWidth == 0 ) {
+			this->videoWidth = width;
+			this->videoHeight = height;
+		} else if ( width != this->videoWidth || height != this->videoHeight ) {
+			this->statistics.mismatchedCount++;
+			return false;
+		}
+	}
+
+	// Never wait for the workers, that would stall the renderer
+	if ( this->freeFrames.empty() ) {
+		this->statistics.droppedCount++;
+		this->statistics.submitMilliseconds += recorderNow() - startTime;
+		return false;
+	}
+
+	this->writingFrame = this->freeFrames.back();
+	this->freeFrames.pop_back();
+
+	// The pixels are allocated by the first frame of each size, after that the frame still has what was last drawn into it
+	Framebuffer &pixels = this->writingFrame->framebuffer;
+	if ( pixels.width != width || pixels.height != height ) framebufferAllocate( pixels, width, height );
+	framebufferWrap( framebuffer, pixels.pixels, pixels.width, pixels.height, pixels.stride );
+
+	this->statistics.submitMilliseconds += recorderNow() - startTime;
+	return true;
+
+}
+
+// Hands the frame drawn since beginFrame() to a worker, the renderer must not touch it after this
+void FrameRecorder::endFrame() {
+
+	double startTime = recorderNow();
+	RecorderFrame *frame = NULL;
+
+	{
+		std::lock_guard<std::mutex> lock( this->mutex );
+		if ( this->writingFrame == NULL ) return;
+
+		frame = this->writingFrame;
+		frame->number = this->nextSubmitNumber++;
+		this->writingFrame = NULL;
+
+		this->statistics.queuedCount++;
+		if ( this->statistics.queuedCount > this->statistics.queueHighWater ) this->statistics.queueHighWater = this->statistics.queuedCount;
+	}
+
+	threadEnqueue( [ this, frame ]() {
+		this->encodeFrame( frame );
+	} );
+
+	std::lock_guard<std::mutex> lock( this->mutex );
+	this->statistics.submitMilliseconds += recorderNow() - startTime;
+
+}
+
+// Copies a frame into the queue & hands it to a worker, for frames that were drawn somewhere else (such as shared memory that is about to be reused)
+bool FrameRecorder::submit( const Framebuffer &framebuffer ) {
+
+	Framebuffer frame;
+	if ( framebuffer.pixels == NULL || !this->beginFrame( framebuffer.width, framebuffer.height, frame ) ) return false;
+
+	// The copy is the only work this adds to the renderer's thread
+	double startTime = recorderNow();
+	for ( unsigned int y = 0; y < framebuffer.height; y++ ) {
+		std::memcpy( frame.pixels + ( size_t ) y * frame.stride, framebuffer.pixels + ( size_t ) y * framebuffer.stride, framebuffer.width * sizeof( uint32_t ) );
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( this->mutex );
+		this->statistics.submitMilliseconds += recorderNow() - startTime;
+	}
+
+	this->endFrame();
+	return true;
+
+}
+
+// Compresses a frame on a worker, then writes every frame that is ready in order
+// Frames finish encoding in any order, so whichever worker finishes the next frame to be written does the writing while the others carry on encoding
+void FrameRecorder::encodeFrame( RecorderFrame *frame ) {
+
+	double startTime = recorderNow();
+
+	frame->encoded.clear();
+	if ( this->format == RecordingFormat::QOI ) {
+		encodeQOI( frame->framebuffer, frame->encoded );
+	} else {
+		if ( frame->number == 0 ) encodeY4MHeader( frame->framebuffer.width, frame->framebuffer.height, this->frameRate, frame->encoded );
+		encodeY4MFrame( frame->framebuffer, frame->encoded );
+	}
+
+	std::unique_lock<std::mutex> lock( this->mutex );
+	this->statistics.encodeMilliseconds += recorderNow() - startTime;
+	this->encodedFrames[ frame->number ] = frame;
+
+	// Another worker is already writing, it will pick this frame up when it gets to it
+	if ( this->isWriting ) return;
+	this->isWriting = true;
+
+	while ( !this->encodedFrames.empty() && this->encodedFrames.begin()->first == this->nextWriteNumber ) {
+		RecorderFrame *nextFrame = this->encodedFrames.begin()->second;
+		this->encodedFrames.erase( this->encodedFrames.begin() );
+		bool shouldWrite = !this->statistics.hasFailed;
+
+		// Write without holding the lock, so the renderer can keep submitting
+		lock.unlock();
+		double writeStartTime = recorderNow();
+		bool isWritten = shouldWrite && this->writeFrame( nextFrame );
+		double writeTime = recorderNow() - writeStartTime;
+		lock.lock();
+
+		if ( isWritten ) {
+			this->statistics.writtenCount++;
+			this->statistics.bytesWritten += nextFrame->encoded.size();
+		} else if ( shouldWrite ) {
+			this->statistics.hasFailed = true;
+		}
+
+		this->statistics.writeMilliseconds += writeTime;
+		this->nextWriteNumber++;
+
+		// Put the frame back in the queue
+		this->freeFrames.push_back( nextFrame );
+		this->statistics.queuedCount--;
+	}
+
+	this->isWriting = false;
+	if ( this->statistics.queuedCount == 0 ) this->queueEmptied.notify_all();
+
+}
+
+// Writes an encoded frame to its own image file, or to the end of the video
+bool FrameRecorder::writeFrame( RecorderFrame *frame ) {
+
+	if ( this->format == RecordingFormat::Y4M ) {
+		this->videoStream.write( ( const char * ) frame->encoded.data(), ( std::streamsize ) frame->encoded.size() );
+		return ( bool ) this->videoStream;
+	}
+
+	// Number the images from one, padded so they sort in order
+	char fileName[ 32 ];
+	std::snprintf( fileName, sizeof( fileName ), "frame-%06llu.qoi", ( unsigned long long ) frame->number + 1 );
+
+	std::ofstream imageFile( std::filesystem::path( this->path ) / fileName, std::ios::binary | std::ios::trunc );
+	imageFile.write( ( const char * ) frame->encoded.data(), ( std::streamsize ) frame->encoded.size() );
+	return ( bool ) imageFile;
+
+}
+
+// Gets a copy of the statistics so far
+RecorderStatistics FrameRecorder::getStatistics() {
+
+	std::lock_guard<std::mutex> lock( this->mutex );
+	return this->statistics;
+
+}
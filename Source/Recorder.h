@@ -0,0 +1,111 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Strings & dynamic arrays
+#include <string>
+#include <vector>
+
+// Frames waiting to be written, in order
+#include <map>
+#include <memory>
+
+// Sharing the queue with the workers
+#include <mutex>
+#include <condition_variable>
+
+// Output files
+#include <fstream>
+
+// The pixels being recorded
+#include "Framebuffer.h"
+
+// What to record frames as
+enum class RecordingFormat {
+	QOI, // A numbered QOI image per frame in a directory, lossless
+	Y4M // A single uncompressed YUV4MPEG2 video, frames must all be the same size
+};
+
+// What happened to the frames given to the recorder, for spotting when it cannot keep up
+struct RecorderStatistics {
+	uint64_t submittedCount = 0; // Frames given to beginFrame() or submit()
+	uint64_t writtenCount = 0; // Frames on disk
+	uint64_t droppedCount = 0; // Frames turned away because the queue was full (backpressure)
+	uint64_t mismatchedCount = 0; // Frames turned away because they were not the size of the video
+	unsigned int queuedCount = 0; // Frames being encoded or waiting to be written right now
+	unsigned int queueCapacity = 0;
+	unsigned int queueHighWater = 0; // The most frames that were ever queued at once
+	uint64_t bytesWritten = 0;
+	double submitMilliseconds = 0.0; // Total time spent in beginFrame(), endFrame() & submit(), the only cost to the render thread
+	double encodeMilliseconds = 0.0; // Total time spent compressing, on the worker threads
+	double writeMilliseconds = 0.0; // Total time spent writing to disk, on the worker threads
+	bool hasFailed = false; // Writing to disk failed, nothing more will be written
+};
+
+// Records frames from the renderer to disk without stalling it
+// Frames are drawn (or copied) into a bounded queue, compressed in parallel on the job system's workers, then written in order with a single large write each
+// When the queue is full the frame is dropped & counted instead of waiting, so a slow disk shows up in the statistics rather than in frame times
+class FrameRecorder {
+
+	// Only usable by this class
+	private:
+
+		// A submitted frame, and the bytes it was encoded as
+		struct RecorderFrame {
+			uint64_t number = 0;
+			Framebuffer framebuffer;
+			std::vector<uint8_t> encoded;
+		};
+
+		// Where frames go
+		std::string path;
+		RecordingFormat format = RecordingFormat::QOI;
+		unsigned int frameRate = 60;
+		unsigned int videoWidth = 0;
+		unsigned int videoHeight = 0;
+		std::ofstream videoStream;
+		bool isStarted = false;
+
+		// Every frame that can be queued is allocated up front, then reused
+		std::vector<std::unique_ptr<RecorderFrame>> frames;
+		std::vector<RecorderFrame *> freeFrames;
+		RecorderFrame *writingFrame = NULL; // Being drawn into by the renderer, between beginFrame() & endFrame()
+
+		// Encoded frames waiting for the ones before them to be written, and whether a worker is writing them
+		std::map<uint64_t, RecorderFrame *> encodedFrames;
+		uint64_t nextSubmitNumber = 0;
+		uint64_t nextWriteNumber = 0;
+		bool isWriting = false;
+
+		// Protects everything above & below, and wakes stop() once every queued frame is written
+		std::mutex mutex;
+		std::condition_variable queueEmptied;
+
+		RecorderStatistics statistics;
+
+		// Run on the workers
+		void encodeFrame( RecorderFrame * );
+		bool writeFrame( RecorderFrame * );
+
+	// Usable by anyone
+	public:
+
+		// Destructor
+		~FrameRecorder();
+
+		// Setup
+		bool start( const std::string &, RecordingFormat, unsigned int = 4, unsigned int = 60 );
+		void stop();
+		bool isRecording();
+
+		// Used by the renderer, never waits for encoding or writing, returns false if the frame was dropped
+		// Drawing straight into the queue between beginFrame() & endFrame() saves submit() copying the frame
+		bool beginFrame( unsigned int, unsigned int, Framebuffer & );
+		void endFrame();
+		bool submit( const Framebuffer & );
+
+		// Information
+		RecorderStatistics getStatistics();
+
+};
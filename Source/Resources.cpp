@@ -0,0 +1,148 @@
+#include "Resources.h"
+
+// Job system, for pre-warming
+#include "Thread.h"
+
+// Recording creations on the startup timeline
+#include "Timeline.h"
+
+// Max
+#include <algorithm>
+
+// Sets up the resource without creating it
+LazyResource::LazyResource( const std::string &resourceName, std::function<void *()> resourceCreator, std::function<void( void * )> resourceReleaser ) :
+	name( resourceName ),
+	creator( std::move( resourceCreator ) ),
+	releaser( std::move( resourceReleaser ) ),
+	resource( NULL ) {
+
+}
+
+// Releases the resource when this class is destroyed
+LazyResource::~LazyResource() {
+	this->release();
+}
+
+// Gets the resource, creating it on this thread if it does not exist yet, NULL if it could not be created
+void *LazyResource::get() {
+
+	// Almost every call finds it already created
+	void *existing = this->resource.load( std::memory_order_acquire );
+	if ( existing != NULL ) return existing;
+
+	return this->create( false, 0 );
+
+}
+
+// Has the resource been created (and not released since)?
+bool LazyResource::isCreated() const {
+	return this->resource.load( std::memory_order_acquire ) != NULL;
+}
+
+// What the resource is called
+const std::string &LazyResource::getName() const {
+	return this->name;
+}
+
+// Creates the resource, only one thread ever creates it at a time & any others wait for that rather than creating it twice
+// A pre-warm only creates it if it has not been released since the pre-warm was queued, as whatever it depended on may be gone
+void *LazyResource::create( bool isPrewarm, uint64_t expectedGeneration ) {
+
+	std::unique_lock<std::mutex> lock( this->mutex );
+	if ( isPrewarm && this->generation != expectedGeneration ) return NULL;
+
+	// Another thread is already creating it
+	if ( this->isCreating ) {
+
+		// A pre-warm has nothing to wait for
+		if ( isPrewarm ) return NULL;
+
+		double waitStartTime = timelineNow();
+		this->creationFinished.wait( lock, [ this ]() {
+			return !this->isCreating;
+		} );
+
+		this->statistics.waitCount++;
+		this->statistics.waitMilliseconds += timelineNow() - waitStartTime;
+	}
+
+	// Do not continue if it was created while waiting for the lock
+	void *existing = this->resource.load( std::memory_order_relaxed );
+	if ( existing != NULL ) return existing;
+
+	// Create it without holding the lock, so nothing else is blocked unless it needs this resource
+	this->isCreating = true;
+	lock.unlock();
+
+	double startTime = timelineNow();
+	void *created = this->creator();
+	double endTime = timelineNow();
+
+	lock.lock();
+	this->isCreating = false;
+
+	if ( created != NULL ) {
+		double createTime = endTime - startTime;
+		this->statistics.createdCount++;
+		this->statistics.createMilliseconds += createTime;
+		this->statistics.maximumCreateMilliseconds = std::max( this->statistics.maximumCreateMilliseconds, createTime );
+
+		if ( isPrewarm ) this->statistics.prewarmedCount++;
+		else this->statistics.onDemandCount++;
+
+		this->resource.store( created, std::memory_order_release );
+	} else {
+		this->statistics.failedCount++;
+	}
+
+	lock.unlock();
+	this->creationFinished.notify_all();
+
+	// Show it on the startup timeline, alongside whatever it was overlapping with
+	timelineRecord( ( isPrewarm ? "Pre-warm " : "Create " ) + this->name, startTime, endTime );
+
+	return created;
+
+}
+
+// Creates the resource on a worker if it does not exist yet, so its first use does not have to
+void LazyResource::prewarm() {
+
+	// Do not queue anything if it already exists
+	if ( this->isCreated() ) return;
+
+	uint64_t expectedGeneration;
+	{
+		std::lock_guard<std::mutex> lock( this->mutex );
+		expectedGeneration = this->generation;
+	}
+
+	threadEnqueue( [ this, expectedGeneration ]() {
+		this->create( true, expectedGeneration );
+	} );
+
+}
+
+// Frees the resource, waiting for any creation in progress first, it will be created again when it is next used
+void LazyResource::release() {
+
+	std::unique_lock<std::mutex> lock( this->mutex );
+	this->creationFinished.wait( lock, [ this ]() {
+		return !this->isCreating;
+	} );
+
+	// Any pre-warm still queued must not create it again
+	this->generation++;
+
+	void *existing = this->resource.exchange( NULL, std::memory_order_acq_rel );
+	if ( existing != NULL ) this->releaser( existing );
+
+}
+
+// Gets a copy of the statistics so far
+ResourceStatistics LazyResource::getStatistics() {
+
+	std::lock_guard<std::mutex> lock( this->mutex );
+	return this->statistics;
+
+}
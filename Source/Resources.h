@@ -0,0 +1,100 @@
+#pragma once
+
+// Strings
+#include <string>
+
+// Creating & releasing the resource
+#include <functional>
+
+// Locking, and checking whether the resource exists without locking
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Fixed-width integer types
+#include <cstdint>
+
+// How long a resource took to create, and how often its first use had to wait for it
+struct ResourceStatistics {
+	unsigned int createdCount = 0; // Including every recreation after being released
+	unsigned int prewarmedCount = 0; // Created on a worker before anything needed it
+	unsigned int onDemandCount = 0; // Created by the first use, stalling whatever needed it
+	unsigned int waitCount = 0; // Uses that found a pre-warm still running & waited for it
+	unsigned int failedCount = 0;
+	double createMilliseconds = 0.0; // In total
+	double maximumCreateMilliseconds = 0.0;
+	double waitMilliseconds = 0.0; // In total
+};
+
+// A resource that is only created when it is first used, or ahead of time on a worker when it is expected to be needed soon
+// Once created, getting it is a single atomic load, it can be released (such as when the graphics device is lost) & is then created again on its next use
+class LazyResource {
+
+	// Only usable by this class
+	private:
+
+		// What the resource is called in the statistics & startup timeline
+		std::string name;
+
+		// Makes the resource (NULL if that failed), and frees it
+		std::function<void *()> creator;
+		std::function<void( void * )> releaser;
+
+		// The resource, set once it has been created so using it needs no lock
+		std::atomic<void *> resource;
+
+		// Protects everything below, and wakes up anything waiting for a creation in progress
+		std::mutex mutex;
+		std::condition_variable creationFinished;
+		bool isCreating = false;
+		uint64_t generation = 0; // Bumped on every release, so a pre-warm queued beforehand does not create it again
+		ResourceStatistics statistics;
+
+		// Creates the resource on this thread, or waits for another thread that already is
+		void *create( bool, uint64_t );
+
+	// Usable by anyone
+	public:
+
+		// Constructor & destructor
+		LazyResource( const std::string &, std::function<void *()>, std::function<void( void * )> );
+		~LazyResource();
+
+		// Using the resource
+		void *get();
+		bool isCreated() const;
+		const std::string &getName() const;
+
+		// Creating it ahead of time on the job system, and releasing it
+		void prewarm();
+		void release();
+
+		// Telemetry
+		ResourceStatistics getStatistics();
+
+};
+
+// A lazily created COM object (brush, text format, etc.), released with its Release() method
+template <typename Interface>
+class LazyHandle : public LazyResource {
+
+	// Usable by anyone
+	public:
+
+		// Constructor
+		LazyHandle( const std::string &name, std::function<Interface *()> creator ) : LazyResource(
+			name,
+			[ creator ]() -> void * { return creator(); },
+			[]( void *object ) { ( ( Interface * ) object )->Release(); }
+		) {}
+
+		// Gets the object, creating it if it does not exist yet
+		Interface *get() {
+			return ( Interface * ) LazyResource::get();
+		}
+
+		Interface *operator->() {
+			return this->get();
+		}
+
+};
@@ -0,0 +1,49 @@
+#include "Scene.h"
+
+// Builds the gradient lookup table, the same yellow to green as the Direct2D gradient brush
+void scenePrepare( SceneResources &resources ) {
+
+	GradientStop gradientStops[ 2 ] = {
+		{ 0.0f, 1.0f, 1.0f, 0.0f, 1.0f }, // Yellow
+		{ 1.0f, 0.0f, 128.0f / 255.0f, 0.0f, 1.0f } // Green
+	};
+
+	resources.fillGradient.setStops( gradientStops, 2 );
+
+}
+
+// Records the same scene as the window's paint handler (except for the text), for a picture of a size
+void sceneRecord( DisplayList &displayList, SceneResources &resources, unsigned int pictureWidth, unsigned int pictureHeight ) {
+
+	float width = ( float ) pictureWidth;
+	float height = ( float ) pictureHeight;
+
+	// The same area the Direct2D rectangle uses
+	Rect rectangleArea = { 50.0f, 50.0f, width - 50.0f, height - 50.0f };
+
+	// Clear to light gray
+	displayList.reset();
+	displayList.clear( colorFromBytes( 211, 211, 211, 255 ) );
+
+	// Fill the rectangle with the gradient, from the upper-left to the lower-right corner
+	resources.fillGradient.setPoints( { 0.0f, 0.0f }, { width, height } );
+	Paint gradientPaint;
+	gradientPaint.gradient = &resources.fillGradient;
+	displayList.fillRectangle( rectangleArea, gradientPaint );
+
+	// Outline the rectangle & draw a circle outline in the middle, both in black
+	Paint outlinePaint;
+	outlinePaint.color = colorFromBytes( 0, 0, 0, 255 );
+	displayList.drawRectangle( rectangleArea, outlinePaint, 1.0f );
+	displayList.drawEllipse( { width / 2.0f, height / 2.0f }, 75.0f, 75.0f, outlinePaint, 3.0f );
+
+}
+
+// Draws the scene into whatever the canvas targets, by recording it for the canvas's picture size & replaying it straight away
+void sceneDraw( Canvas &canvas, SceneResources &resources ) {
+
+	DisplayList displayList;
+	sceneRecord( displayList, resources, canvas.getWidth(), canvas.getHeight() );
+	displayList.replay( canvas );
+
+}
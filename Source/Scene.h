@@ -0,0 +1,21 @@
+#pragma once
+
+// Software drawing
+#include "Canvas.h"
+
+// Recording the scene's drawing calls
+#include "DisplayList.h"
+
+// The device-independent resources needed to draw the demo scene in software
+struct SceneResources {
+	LinearGradient fillGradient;
+};
+
+// Builds the resources, does not need a window or graphics device so can be done on any thread
+void scenePrepare( SceneResources & );
+
+// Records the drawing calls of the scene for a size of picture, so it can be identified by their hash before it is drawn
+void sceneRecord( DisplayList &, SceneResources &, unsigned int, unsigned int );
+
+// Draws the same scene as the window's paint handler (except for the text) into whatever the canvas targets
+void sceneDraw( Canvas &, SceneResources & );
@@ -0,0 +1,325 @@
+#include "SharedFramebuffer.h"
+
+// Timing
+#include <chrono>
+
+// Constructing the header in place
+#include <new>
+
+// Operating system shared memory
+#ifdef _WIN32
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <cerrno>
+#endif
+
+// Everything in the mapping is aligned to whole pages, so each buffer starts on its own page
+const size_t SHARED_FRAMEBUFFER_ALIGNMENT = 4096;
+
+// Rounds a size up to a whole number of pages
+static size_t alignToPage( size_t size ) {
+	return ( size + SHARED_FRAMEBUFFER_ALIGNMENT - 1 ) / SHARED_FRAMEBUFFER_ALIGNMENT * SHARED_FRAMEBUFFER_ALIGNMENT;
+}
+
+// Unmaps the shared memory when this class is destroyed
+SharedFramebuffer::~SharedFramebuffer() {
+	this->close();
+}
+
+// Maps the shared memory into this process, either creating it with a size (writable) or opening the existing one (read-only)
+bool SharedFramebuffer::map( bool isCreating, size_t size ) {
+
+#ifdef _WIN32
+
+	// Names in the local namespace are visible to every process in this session
+	std::wstring wideName = L"Local\\" + std::wstring( this->name.begin(), this->name.end() );
+
+	HANDLE handle = NULL;
+	if ( isCreating ) {
+		handle = CreateFileMappingW( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, ( DWORD ) ( ( uint64_t ) size >> 32 ), ( DWORD ) size, wideName.c_str() );
+
+		// Someone else already has a mapping with this name, do not scribble over it
+		if ( handle != NULL && GetLastError() == ERROR_ALREADY_EXISTS ) {
+			CloseHandle( handle );
+			return false;
+		}
+	} else {
+		handle = OpenFileMappingW( FILE_MAP_READ, FALSE, wideName.c_str() );
+	}
+
+	if ( handle == NULL ) return false;
+
+	// A size of zero maps the whole thing
+	void *view = MapViewOfFile( handle, isCreating ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, isCreating ? size : 0 );
+	if ( view == NULL ) {
+		CloseHandle( handle );
+		return false;
+	}
+
+	// Find out how big the mapping is when we did not create it
+	if ( !isCreating ) {
+		MEMORY_BASIC_INFORMATION memoryInformation = { 0 };
+		VirtualQuery( view, &memoryInformation, sizeof( memoryInformation ) );
+		size = memoryInformation.RegionSize;
+	}
+
+	this->mappingHandle = handle;
+	this->mapping = view;
+	this->mappingSize = size;
+	return true;
+
+#else
+
+	// POSIX shared memory names start with a slash
+	std::string posixName = "/" + this->name;
+
+	int descriptor = -1;
+	if ( isCreating ) {
+		descriptor = shm_open( posixName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600 );
+
+		// A previous run that crashed may have left its mapping behind, so replace it once
+		if ( descriptor < 0 && errno == EEXIST ) {
+			shm_unlink( posixName.c_str() );
+			descriptor = shm_open( posixName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600 );
+		}
+
+		if ( descriptor < 0 ) return false;
+
+		if ( ftruncate( descriptor, ( off_t ) size ) != 0 ) {
+			::close( descriptor );
+			shm_unlink( posixName.c_str() );
+			return false;
+		}
+	} else {
+		descriptor = shm_open( posixName.c_str(), O_RDONLY, 0 );
+		if ( descriptor < 0 ) return false;
+
+		// Find out how big the mapping is
+		struct stat information;
+		if ( fstat( descriptor, &information ) != 0 || information.st_size <= 0 ) {
+			::close( descriptor );
+			return false;
+		}
+
+		size = ( size_t ) information.st_size;
+	}
+
+	void *view = mmap( NULL, size, isCreating ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, descriptor, 0 );
+	if ( view == MAP_FAILED ) {
+		::close( descriptor );
+		if ( isCreating ) shm_unlink( posixName.c_str() );
+		return false;
+	}
+
+	this->fileDescriptor = descriptor;
+	this->mapping = view;
+	this->mappingSize = size;
+	return true;
+
+#endif
+
+}
+
+// Creates the shared memory with room for a number of buffers of up to a maximum size, fails if the name is already in use
+bool SharedFramebuffer::create( const std::string &mappingName, unsigned int bufferCount, unsigned int maximumWidth, unsigned int maximumHeight ) {
+
+	this->close();
+
+	// Fewer than two buffers would mean every frame tears while it is being read
+	if ( bufferCount < 2 || bufferCount > SHARED_FRAMEBUFFER_MAXIMUM_BUFFERS || maximumWidth == 0 || maximumHeight == 0 ) return false;
+
+	size_t headerSize = alignToPage( sizeof( SharedFramebufferHeader ) );
+	size_t bufferSize = alignToPage( ( size_t ) maximumWidth * maximumHeight * sizeof( uint32_t ) );
+
+	this->name = mappingName;
+	this->isCreator = true;
+	if ( !this->map( true, headerSize + bufferSize * bufferCount ) ) {
+		this->name.clear();
+		this->isCreator = false;
+		return false;
+	}
+
+	// Construct the header in place, every sequence starts at zero (even, so not being written)
+	this->header = new ( this->mapping ) SharedFramebufferHeader();
+	this->header->version = SHARED_FRAMEBUFFER_VERSION;
+	this->header->bufferCount = bufferCount;
+	this->header->maximumWidth = maximumWidth;
+	this->header->maximumHeight = maximumHeight;
+	this->header->bufferSize = bufferSize;
+	this->header->latestFrameNumber.store( 0, std::memory_order_relaxed );
+
+	for ( unsigned int index = 0; index < bufferCount; index++ ) {
+		this->header->slots[ index ].pixelOffset = headerSize + bufferSize * index;
+	}
+
+	// Readers check the magic number last, so make sure everything above is visible first
+	std::atomic_thread_fence( std::memory_order_release );
+	this->header->magic = SHARED_FRAMEBUFFER_MAGIC;
+
+	this->nextFrameNumber = 1;
+	return true;
+
+}
+
+// Opens shared memory created by another process, read-only
+bool SharedFramebuffer::open( const std::string &mappingName ) {
+
+	this->close();
+
+	this->name = mappingName;
+	this->isCreator = false;
+	if ( !this->map( false, 0 ) ) {
+		this->name.clear();
+		return false;
+	}
+
+	// Make sure it is really ours, and a layout we understand
+	SharedFramebufferHeader *mappedHeader = ( SharedFramebufferHeader * ) this->mapping;
+	bool isValid = this->mappingSize >= sizeof( SharedFramebufferHeader ) &&
+		mappedHeader->magic == SHARED_FRAMEBUFFER_MAGIC &&
+		mappedHeader->version == SHARED_FRAMEBUFFER_VERSION &&
+		mappedHeader->bufferCount >= 2 && mappedHeader->bufferCount <= SHARED_FRAMEBUFFER_MAXIMUM_BUFFERS &&
+		mappedHeader->slots[ mappedHeader->bufferCount - 1 ].pixelOffset + mappedHeader->bufferSize <= this->mappingSize;
+
+	if ( !isValid ) {
+		this->close();
+		return false;
+	}
+
+	std::atomic_thread_fence( std::memory_order_acquire );
+	this->header = mappedHeader;
+	return true;
+
+}
+
+// Unmaps the shared memory, and removes it if we created it (readers that still have it mapped keep it alive)
+void SharedFramebuffer::close() {
+
+	if ( this->mapping == NULL ) return;
+
+#ifdef _WIN32
+	UnmapViewOfFile( this->mapping );
+	CloseHandle( ( HANDLE ) this->mappingHandle );
+	this->mappingHandle = NULL;
+#else
+	munmap( this->mapping, this->mappingSize );
+	::close( this->fileDescriptor );
+	this->fileDescriptor = -1;
+	if ( this->isCreator ) shm_unlink( ( "/" + this->name ).c_str() );
+#endif
+
+	this->mapping = NULL;
+	this->mappingSize = 0;
+	this->header = NULL;
+	this->writingSlot = NULL;
+	this->name.clear();
+	this->isCreator = false;
+
+}
+
+// Has the shared memory been created or opened?
+bool SharedFramebuffer::isOpen() const {
+	return this->header != NULL;
+}
+
+// Points a framebuffer at the next buffer in the ring & marks it as being written, fails if the size is too big
+bool SharedFramebuffer::beginFrame( unsigned int width, unsigned int height, Framebuffer &framebuffer ) {
+
+	// Only the creator can write, and only one frame at a time
+	if ( this->header == NULL || !this->isCreator || this->writingSlot != NULL ) return false;
+	if ( width == 0 || height == 0 || width > this->header->maximumWidth || height > this->header->maximumHeight ) return false;
+
+	SharedFramebufferSlot &slot = this->header->slots[ this->nextFrameNumber % this->header->bufferCount ];
+
+	// Make the sequence odd before touching anything else, so readers of the previous frame in this buffer can tell it is being overwritten
+	uint32_t sequence = slot.sequence.load( std::memory_order_relaxed );
+	slot.sequence.store( sequence + 1, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_release );
+
+	slot.width.store( width, std::memory_order_relaxed );
+	slot.height.store( height, std::memory_order_relaxed );
+	slot.stride.store( width, std::memory_order_relaxed );
+	slot.format.store( SHARED_FRAMEBUFFER_FORMAT_BGRA8_PREMULTIPLIED, std::memory_order_relaxed );
+	slot.frameNumber.store( this->nextFrameNumber, std::memory_order_relaxed );
+
+	// The renderer draws straight into shared memory
+	framebufferWrap( framebuffer, ( uint32_t * ) ( ( char * ) this->mapping + slot.pixelOffset ), width, height, width );
+
+	this->writingSlot = &slot;
+	return true;
+
+}
+
+// Publishes the buffer being written as the latest frame
+void SharedFramebuffer::endFrame() {
+
+	if ( this->writingSlot == NULL ) return;
+
+	// Making the sequence even again releases every pixel written since beginFrame()
+	this->writingSlot->publishTime.store( sharedFramebufferNow(), std::memory_order_relaxed );
+	this->writingSlot->sequence.store( this->writingSlot->sequence.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+	this->header->latestFrameNumber.store( this->nextFrameNumber, std::memory_order_release );
+
+	this->writingSlot = NULL;
+	this->nextFrameNumber++;
+
+}
+
+// Gets the latest published frame without copying it, fails if there is none yet or it is being overwritten
+// The pixels can be used in place, but must be checked with isStillValid() afterwards as the renderer may reuse the buffer at any time
+bool SharedFramebuffer::acquireLatest( SharedFrame &frame ) const {
+
+	if ( this->header == NULL ) return false;
+
+	uint64_t latestFrameNumber = this->header->latestFrameNumber.load( std::memory_order_acquire );
+	if ( latestFrameNumber == 0 ) return false;
+
+	unsigned int slotIndex = ( unsigned int ) ( latestFrameNumber % this->header->bufferCount );
+	const SharedFramebufferSlot &slot = this->header->slots[ slotIndex ];
+
+	// An odd sequence means the renderer has already lapped the ring & is overwriting this buffer
+	uint32_t sequence = slot.sequence.load( std::memory_order_acquire );
+	if ( ( sequence & 1 ) != 0 ) return false;
+
+	frame.width = slot.width.load( std::memory_order_relaxed );
+	frame.height = slot.height.load( std::memory_order_relaxed );
+	frame.stride = slot.stride.load( std::memory_order_relaxed );
+	frame.format = slot.format.load( std::memory_order_relaxed );
+	frame.frameNumber = slot.frameNumber.load( std::memory_order_relaxed );
+	frame.publishTime = slot.publishTime.load( std::memory_order_relaxed );
+	frame.pixels = ( const uint32_t * ) ( ( const char * ) this->mapping + slot.pixelOffset );
+	frame.slotIndex = slotIndex;
+	frame.sequence = sequence;
+
+	// The description must not have changed while we read it
+	return this->isStillValid( frame );
+
+}
+
+// Checks that a frame was not overwritten while it was being used, if this fails anything read from its pixels may be torn
+bool SharedFramebuffer::isStillValid( const SharedFrame &frame ) const {
+
+	if ( this->header == NULL ) return false;
+
+	// Every read of the frame must happen before reading the sequence again
+	std::atomic_thread_fence( std::memory_order_acquire );
+	return this->header->slots[ frame.slotIndex ].sequence.load( std::memory_order_relaxed ) == frame.sequence;
+
+}
+
+// The number of the most recently published frame, zero if none have been published
+uint64_t SharedFramebuffer::getLatestFrameNumber() const {
+
+	if ( this->header == NULL ) return 0;
+	return this->header->latestFrameNumber.load( std::memory_order_acquire );
+
+}
+
+// The clock used for publish times, the steady clock is system-wide on both Windows (QueryPerformanceCounter) & Linux (CLOCK_MONOTONIC)
+uint64_t sharedFramebufferNow() {
+	return ( uint64_t ) std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Atomics shared between processes
+#include <atomic>
+
+// Strings
+#include <string>
+
+// The pixels the renderer draws into
+#include "Framebuffer.h"
+
+// Identifies the mapping as ours ("GEFB"), and the version of the layout below
+const uint32_t SHARED_FRAMEBUFFER_MAGIC = 0x42464547;
+const uint32_t SHARED_FRAMEBUFFER_VERSION = 1;
+
+// The only pixel format so far, same as Framebuffer
+const uint32_t SHARED_FRAMEBUFFER_FORMAT_BGRA8_PREMULTIPLIED = 1;
+
+// The most buffers in the ring
+const unsigned int SHARED_FRAMEBUFFER_MAXIMUM_BUFFERS = 8;
+
+// Describes one buffer in the ring, protected by a sequence lock:
+// The sequence is odd while the renderer is writing the buffer, and goes up by two for every frame written to it
+// Readers note the sequence before using a frame & check it is unchanged after, if it changed the renderer reused the buffer mid-read
+struct SharedFramebufferSlot {
+	std::atomic<uint32_t> sequence;
+	std::atomic<uint32_t> width;
+	std::atomic<uint32_t> height;
+	std::atomic<uint32_t> stride; // In pixels
+	std::atomic<uint32_t> format;
+	std::atomic<uint64_t> frameNumber;
+	std::atomic<uint64_t> publishTime; // Nanoseconds on the system-wide monotonic clock, for measuring latency
+	uint64_t pixelOffset; // From the start of the mapping, never changes
+};
+
+// The start of the mapping, followed by the pixels of each buffer
+struct SharedFramebufferHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t bufferCount;
+	uint32_t maximumWidth;
+	uint32_t maximumHeight;
+	uint64_t bufferSize; // In bytes
+	std::atomic<uint64_t> latestFrameNumber; // Zero until the first frame is published
+	SharedFramebufferSlot slots[ SHARED_FRAMEBUFFER_MAXIMUM_BUFFERS ];
+};
+
+// A frame being read straight out of shared memory, without copying
+struct SharedFrame {
+	const uint32_t *pixels;
+	unsigned int width;
+	unsigned int height;
+	unsigned int stride;
+	uint32_t format;
+	uint64_t frameNumber;
+	uint64_t publishTime;
+	unsigned int slotIndex;
+	uint32_t sequence;
+};
+
+// A ring of framebuffers in memory shared with other processes (POSIX shared memory on Linux, a paging file mapping on Windows)
+// The renderer draws directly into the next buffer & publishes it, readers use the latest published buffer in place
+class SharedFramebuffer {
+
+	// Only usable by this class
+	private:
+
+		// The mapping & the operating system's handle for it
+		void *mapping = NULL;
+		size_t mappingSize = 0;
+		void *mappingHandle = NULL; // HANDLE on Windows
+		int fileDescriptor = -1; // On Linux
+
+		// The name the mapping was created or opened with, only the creator removes it
+		std::string name;
+		bool isCreator = false;
+
+		// The header at the start of the mapping
+		SharedFramebufferHeader *header = NULL;
+
+		// The buffer being written by the renderer, and the number of the next frame
+		SharedFramebufferSlot *writingSlot = NULL;
+		uint64_t nextFrameNumber = 1;
+
+		// Maps the shared memory into this process
+		bool map( bool, size_t );
+
+	// Usable by anyone
+	public:
+
+		// Destructor
+		~SharedFramebuffer();
+
+		// Setup
+		bool create( const std::string &, unsigned int, unsigned int, unsigned int );
+		bool open( const std::string & );
+		void close();
+		bool isOpen() const;
+
+		// Used by the renderer
+		bool beginFrame( unsigned int, unsigned int, Framebuffer & );
+		void endFrame();
+
+		// Used by readers
+		bool acquireLatest( SharedFrame & ) const;
+		bool isStillValid( const SharedFrame & ) const;
+		uint64_t getLatestFrameNumber() const;
+
+};
+
+// The clock used for publish times, comparable between processes on the same machine
+uint64_t sharedFramebufferNow();
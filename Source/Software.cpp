@@ -0,0 +1,276 @@
+// My custom window class
+#include "MyWindow.h"
+
+// Console functions
+#include "Console.h"
+
+// Startup timeline
+#include "Timeline.h"
+
+// Identifying frames
+#include "Hash.h"
+
+// Copying cached frames
+#include <cstring>
+
+// How many buffers are in the shared ring, enough that a reader using one frame does not stop the next being drawn
+const unsigned int SHARED_FRAMEBUFFER_BUFFER_COUNT = 3;
+
+// How many buffers to remember the frames of, enough for the whole shared ring & the recorder's frames
+const unsigned int SOFTWARE_TARGET_HISTORY = 8;
+
+// Creates the shared memory and/or starts recording for software rendering, and the resources needed to draw the scene in software
+// Either name can be empty to not enable that, this does not touch the window or graphics device so it runs on a worker thread during startup
+void MyWindow::setupSoftwareRendering( const std::string &sharedFramebufferName, const std::string &recordingPath, size_t frameCacheBudget ) {
+
+	// Record how long this takes on the startup timeline
+	TimelineSpan timelineSpan( "Setup software rendering" );
+
+	if ( !sharedFramebufferName.empty() ) {
+
+		// Make the buffers big enough for the window to cover every monitor, so resizing never needs a new mapping
+		unsigned int maximumWidth = ( unsigned int ) GetSystemMetrics( SM_CXVIRTUALSCREEN );
+		unsigned int maximumHeight = ( unsigned int ) GetSystemMetrics( SM_CYVIRTUALSCREEN );
+
+		// Do not continue if the mapping could not be created, usually because another instance is already using the name
+		if ( !this->sharedFramebuffer.create( sharedFramebufferName, SHARED_FRAMEBUFFER_BUFFER_COUNT, maximumWidth, maximumHeight ) ) {
+			consoleError( "Failed to create the shared framebuffer '%s'!", sharedFramebufferName.c_str() );
+			ExitProcess( 1 );
+			return;
+		}
+
+		// Display a message to the console
+		consoleOutput( "Created shared framebuffer '%s' with %u buffers of up to %u by %u.", sharedFramebufferName.c_str(), SHARED_FRAMEBUFFER_BUFFER_COUNT, maximumWidth, maximumHeight );
+
+	}
+
+	if ( !recordingPath.empty() ) {
+
+		// A path ending in .y4m is a video, anything else is a directory of images
+		bool isVideo = recordingPath.size() > 4 && recordingPath.compare( recordingPath.size() - 4, 4, ".y4m" ) == 0;
+
+		// Do not continue if the file or directory could not be created
+		if ( !this->recorder.start( recordingPath, isVideo ? RecordingFormat::Y4M : RecordingFormat::QOI ) ) {
+			consoleError( "Failed to start recording to '%s'!", recordingPath.c_str() );
+			ExitProcess( 1 );
+			return;
+		}
+
+		// Display a message to the console
+		consoleOutput( "Recording frames to '%s'.", recordingPath.c_str() );
+
+	}
+
+	// Keep whole frames within this much memory
+	this->frameCache.setBudget( frameCacheBudget );
+
+	// Build the gradient table, then draw the whole scene as a single opaque layer
+	scenePrepare( this->sceneResources );
+	this->sceneLayer = this->compositor.addLayer( "Scene", [ this ]( Canvas &canvas ) {
+		sceneDraw( canvas, this->sceneResources );
+	}, true );
+
+}
+
+// Draws the scene in software into the next shared buffer (or the window's own framebuffer), publishes & records it, then draws it onto the render target
+// Must be called between BeginDraw() & EndDraw(), returns false if nothing was drawn so the caller can draw the scene with Direct2D instead
+bool MyWindow::drawSoftwareFrame() {
+
+	// Do not continue if software rendering is not enabled
+	bool isSharing = this->sharedFramebuffer.isOpen();
+	bool isRecording = this->recorder.isRecording();
+	if ( !isSharing && !isRecording ) return false;
+
+	// The frame is the size of the render target in pixels, not device-independent pixels
+	D2D1_SIZE_U pixelSize = this->renderTarget->GetPixelSize();
+
+	// The recorder's frames & our own are allocated again when the size changes (maybe at the same address), so only trust what buffers got since then
+	if ( !this->softwareTargets.empty() && ( this->softwareTargets.back().width != pixelSize.width || this->softwareTargets.back().height != pixelSize.height ) ) this->softwareTargets.clear();
+
+	// Point the canvas at the next buffer in the ring, this fails if the window has grown beyond every monitor
+	bool isRecordingInPlace = false;
+	if ( isSharing ) {
+		if ( !this->sharedFramebuffer.beginFrame( pixelSize.width, pixelSize.height, this->softwareFrame ) ) return false;
+
+	// Only recording, so draw straight into the recorder's next frame, which saves copying it
+	} else if ( this->recorder.beginFrame( pixelSize.width, pixelSize.height, this->softwareFrame ) ) {
+		isRecordingInPlace = true;
+
+	// The recorder dropped the frame, so draw into pixels of our own (kept between frames unless the size changes)
+	} else {
+		if ( this->ownFrame.storage.empty() || this->ownFrame.width != pixelSize.width || this->ownFrame.height != pixelSize.height ) framebufferAllocate( this->ownFrame, pixelSize.width, pixelSize.height );
+		framebufferWrap( this->softwareFrame, this->ownFrame.pixels, pixelSize.width, pixelSize.height, this->ownFrame.stride );
+	}
+
+	// Identify the frame by the scene's drawing calls & its size, before drawing anything
+	sceneRecord( this->sceneList, this->sceneResources, pixelSize.width, pixelSize.height );
+	uint64_t frameKey = hashValue( hashValue( this->sceneList.getHash(), pixelSize.width ), pixelSize.height );
+
+	// A frame other than the one the layers were last drawn for (such as after resizing back) may have been drawn before, so copy it instead of drawing it again
+	// The same frame is left to the compositor, as compositing only what changed is cheaper than copying every pixel
+	const Framebuffer *cachedFrame = NULL;
+	if ( frameKey != this->composedFrameKey ) cachedFrame = this->frameCache.find( this->sceneList.getHash(), pixelSize.width, pixelSize.height );
+
+	// Buffers the frame was already copied into on an earlier paint (the only other thing that writes them is the compositor) keep it, so they need nothing at all
+	if ( cachedFrame != NULL ) {
+		const SoftwareTarget *target = this->findSoftwareTarget();
+
+		if ( target == NULL || target->frameKey != frameKey ) {
+			for ( unsigned int row = 0; row < cachedFrame->height; row++ ) {
+				std::memcpy( this->softwareFrame.pixels + ( size_t ) row * this->softwareFrame.stride, cachedFrame->pixels + ( size_t ) row * cachedFrame->stride, cachedFrame->width * sizeof( uint32_t ) );
+			}
+
+			// The compositor no longer knows what is in the target
+			this->compositor.forgetTargets();
+			this->rememberSoftwareTarget( frameKey );
+		}
+
+	// Otherwise composite the frame (the scene is only drawn again if the size changed), and keep it if it is new
+	} else {
+		this->compositor.setLayerBounds( this->sceneLayer, { 0, 0, ( int ) pixelSize.width, ( int ) pixelSize.height } );
+		this->compositor.compose( this->softwareFrame );
+		this->rememberSoftwareTarget( frameKey );
+
+		if ( frameKey != this->composedFrameKey ) {
+			this->frameCache.store( this->sceneList.getHash(), this->softwareFrame );
+			this->composedFrameKey = frameKey;
+		}
+	}
+
+	// Publish it for other processes
+	if ( isSharing ) this->sharedFramebuffer.endFrame();
+
+	// Hand the frame to the recorder, a copy if it was drawn into shared memory, which drops it rather than waiting if it is falling behind
+	// The workers only read it, so it can still be copied into the bitmap below
+	if ( isRecordingInPlace ) this->recorder.endFrame();
+	else if ( isRecording && isSharing ) this->recorder.submit( this->softwareFrame );
+
+	// Discard the bitmap if it is not the same size as the frame anymore
+	if ( this->frameBitmap != NULL ) {
+		D2D1_SIZE_U bitmapSize = this->frameBitmap->GetPixelSize();
+
+		if ( bitmapSize.width != pixelSize.width || bitmapSize.height != pixelSize.height ) {
+			this->frameBitmap->Release();
+			this->frameBitmap = NULL;
+		}
+	}
+
+	// Create a bitmap with the same pixel format as the framebuffer (premultiplied BGRA)
+	// https://docs.microsoft.com/en-us/windows/win32/api/d2d1/nf-d2d1-id2d1rendertarget-createbitmap(d2d1_size_u_constvoid_uint32_constd2d1_bitmap_properties__id2d1bitmap)
+	if ( this->frameBitmap == NULL ) {
+		FLOAT dpiX, dpiY;
+		this->renderTarget->GetDpi( &dpiX, &dpiY );
+
+		HRESULT bitmapResult = this->renderTarget->CreateBitmap(
+			pixelSize, // The size of the frame
+			D2D1::BitmapProperties( D2D1::PixelFormat( DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED ), dpiX, dpiY ), // Same DPI as the render target, so it covers it exactly
+			&this->frameBitmap
+		);
+
+		// Draw with Direct2D instead if there was an issue creating the bitmap
+		if ( FAILED( bitmapResult ) || this->frameBitmap == NULL ) {
+			consoleError( "Failed to create the Direct2D bitmap for software rendering! (%l)", bitmapResult );
+			return false;
+		}
+	}
+
+	// Copy the frame into the bitmap, then draw it over the whole render target
+	this->frameBitmap->CopyFromMemory( NULL, this->softwareFrame.pixels, this->softwareFrame.stride * sizeof( uint32_t ) );
+
+	D2D1_SIZE_F renderTargetSize = this->renderTarget->GetSize();
+	this->renderTarget->DrawBitmap( this->frameBitmap, D2D1::RectF( 0.0f, 0.0f, renderTargetSize.width, renderTargetSize.height ), 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR );
+
+	return true;
+
+}
+
+// Finds the buffer this frame is being drawn into among the ones drawn into recently, or NULL if it has not been used recently
+MyWindow::SoftwareTarget *MyWindow::findSoftwareTarget() {
+
+	for ( SoftwareTarget &target : this->softwareTargets ) {
+		if ( target.pixels == this->softwareFrame.pixels && target.width == this->softwareFrame.width && target.height == this->softwareFrame.height && target.stride == this->softwareFrame.stride ) return &target;
+	}
+
+	return NULL;
+
+}
+
+// Remembers which frame the buffer this frame is being drawn into now has, forgetting the buffer that has not been used for longest
+void MyWindow::rememberSoftwareTarget( uint64_t frameKey ) {
+
+	SoftwareTarget *existing = this->findSoftwareTarget();
+	if ( existing != NULL ) this->softwareTargets.erase( this->softwareTargets.begin() + ( existing - this->softwareTargets.data() ) );
+
+	this->softwareTargets.push_back( { this->softwareFrame.pixels, this->softwareFrame.width, this->softwareFrame.height, this->softwareFrame.stride, frameKey } );
+	if ( this->softwareTargets.size() > SOFTWARE_TARGET_HISTORY ) this->softwareTargets.erase( this->softwareTargets.begin() );
+
+}
+
+// Waits for the recorder to write any frames still queued, then displays how well it kept up
+void MyWindow::stopRecording() {
+
+	this->recorder.stop();
+
+	// Do not continue if nothing was recorded
+	RecorderStatistics statistics = this->recorder.getStatistics();
+	if ( statistics.submittedCount == 0 ) return;
+
+	consoleOutput( "Recorded %llu of %llu frames (%llu dropped as the queue was full, %llu not the size of the video), %.1f MB.",
+		statistics.writtenCount,
+		statistics.submittedCount,
+		statistics.droppedCount,
+		statistics.mismatchedCount,
+		( double ) statistics.bytesWritten / ( 1024.0 * 1024.0 )
+	);
+
+	// Do not continue with the timings if nothing was written
+	if ( statistics.writtenCount == 0 ) return;
+
+	consoleOutput( "Recording took %.3f ms per frame on the render thread, %.3f ms to encode & %.3f ms to write on the workers.",
+		statistics.submitMilliseconds / statistics.submittedCount,
+		statistics.encodeMilliseconds / statistics.writtenCount,
+		statistics.writeMilliseconds / statistics.writtenCount
+	);
+
+	// Do not stay silent if frames went missing
+	if ( statistics.hasFailed ) consoleError( "Failed to write some recorded frames to disk!" );
+
+}
+
+// Displays how well the layer caches worked
+void MyWindow::reportCompositor() {
+
+	CompositorStatistics statistics = this->compositor.getStatistics();
+
+	// Do not continue if nothing was drawn in software
+	if ( statistics.frameCount == 0 ) return;
+
+	consoleOutput( "Composited %llu frames (%llu in full), %llu layer cache hits & %llu misses, %.1f MB of cached layers.",
+		statistics.frameCount,
+		statistics.fullFrameCount,
+		statistics.cacheHitCount,
+		statistics.cacheMissCount,
+		( double ) statistics.cacheBytes / ( 1024.0 * 1024.0 )
+	);
+
+}
+
+// Displays how often whole frames were copied from the cache rather than drawn
+void MyWindow::reportFrameCache() {
+
+	FrameCacheStatistics statistics = this->frameCache.getStatistics();
+
+	// Do not continue if the frame never changed
+	if ( statistics.lookupCount == 0 ) return;
+
+	consoleOutput( "Found %llu of %llu frames looked up in the frame cache (%.1f%%), %llu stored & %llu evicted, %.1f MB cached (%.1f MB at most).",
+		statistics.hitCount,
+		statistics.lookupCount,
+		100.0 * statistics.hitCount / statistics.lookupCount,
+		statistics.storedCount,
+		statistics.evictedCount,
+		( double ) statistics.bytes / ( 1024.0 * 1024.0 ),
+		( double ) statistics.peakBytes / ( 1024.0 * 1024.0 )
+	);
+
+}
@@ -1,49 +1,118 @@
 #include "Thread.h"
 
-//bool stopThread = false;
-//std::thread *theThread = NULL;
+// Queue of jobs waiting for a worker
+#include <deque>
+#include <vector>
 
-void threadCreate() {
+// Locking the queue
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
-	//int startingValue = 0;
+// Min & max
+#include <algorithm>
 
-	consoleOutput( "Creating thread..." );
+// The worker threads, and the jobs waiting for them
+std::vector<std::thread> threadWorkers;
+std::deque<std::function<void()>> threadJobs;
 
-	std::thread theThread;
-	theThread = std::thread( threadTask ); // , 3
-	theThread.join();
+// Protects the job queue, stopping flag & worker count, and wakes workers up when there is something to do
+std::mutex threadJobsMutex;
+std::condition_variable threadJobsAvailable;
+bool threadIsStopping = false;
 
-	/*std::thread myThread(threadTask);
-	theThread = &myThread;*/
+// The number of workers taking jobs, only changed with the queue locked (zero once stopping starts, so later jobs run straight away instead of being left in the queue)
+// Atomic so it can also be read without locking
+std::atomic<unsigned int> threadWorkerCount( 0 );
+
+// Zero on the main thread (or any thread that is not a worker), 1 upwards on the workers
+thread_local unsigned int threadWorkerIndex = 0;
+
+// Runs jobs from the queue until told to stop
+void threadWorker( unsigned int workerIndex ) {
+
+	threadWorkerIndex = workerIndex;
+
+	while ( true ) {
+		std::function<void()> job;
+
+		// Wait for a job, or for the workers to be stopped
+		{
+			std::unique_lock<std::mutex> lock( threadJobsMutex );
+			threadJobsAvailable.wait( lock, []() { return threadIsStopping || !threadJobs.empty(); } );
+
+			// Finish every queued job before stopping, so nothing waiting on a future is left hanging
+			if ( threadJobs.empty() ) return;
+
+			job = std::move( threadJobs.front() );
+			threadJobs.pop_front();
+		}
+
+		job();
+	}
 
 }
 
-void threadStop() {
+// Starts the worker threads, by default one for every processor except the one running the main thread
+void threadCreate( unsigned int workerCount ) {
+
+	// Do not start the workers twice
+	if ( !threadWorkers.empty() ) return;
 
-	/*consoleOutput("Stopping thread...");
-	stopThread = true;
+	if ( workerCount == 0 ) workerCount = std::max( std::thread::hardware_concurrency(), 2u ) - 1;
 
-	consoleOutput( "Waiting for thread to finish..." );
-	( *theThread ).join();*/
+	{
+		std::lock_guard<std::mutex> lock( threadJobsMutex );
+		threadIsStopping = false;
+		threadWorkerCount = workerCount;
+	}
+
+	for ( unsigned int index = 0; index < workerCount; index++ ) threadWorkers.emplace_back( threadWorker, index + 1 );
 
 }
 
-void threadTask() { //  int value 
+// Waits for every queued job to finish, then stops the worker threads
+void threadStop() {
+
+	{
+		std::lock_guard<std::mutex> lock( threadJobsMutex );
+		threadIsStopping = true;
+		threadWorkerCount = 0;
+	}
 
-	consoleOutput( "Hello from thread!" );
+	threadJobsAvailable.notify_all();
 
-	/*consoleOutput("Thread started.");
+	for ( std::thread &worker : threadWorkers ) worker.join();
+	threadWorkers.clear();
 
-	int counter = 0;
+}
 
-	while ( !stopThread ) {
+// Queues a job to run on a worker thread, or runs it straight away if there are no workers
+void threadEnqueue( std::function<void()> job ) {
 
-		counter++;
+	// Checked with the queue locked, so a job is never queued after the workers have finished the queue & stopped
+	{
+		std::unique_lock<std::mutex> lock( threadJobsMutex );
 
-		//consoleOutput( "Counter at: %d", counter );
+		if ( threadWorkerCount == 0 ) {
+			lock.unlock();
+			job();
+			return;
+		}
 
+		threadJobs.push_back( std::move( job ) );
 	}
 
-	consoleOutput( "Thread finished (%b).", stopThread );*/
+	threadJobsAvailable.notify_one();
 
-}
\ No newline at end of file
+}
+
+// The number of worker threads running
+unsigned int threadGetWorkerCount() {
+	return threadWorkerCount;
+}
+
+// Which worker is running the calling code, zero if it is not a worker
+unsigned int threadGetWorkerIndex() {
+	return threadWorkerIndex;
+}
@@ -3,9 +3,35 @@
 // Multi-threading
 #include <thread>
 
-// Console functions
-#include "Console.h"
+// Jobs & their results
+#include <functional>
+#include <future>
+#include <memory>
 
-void threadCreate();
+// Starting & stopping the worker threads
+void threadCreate( unsigned int = 0 );
 void threadStop();
-void threadTask();
+
+// Queues a job to run on a worker thread, or runs it straight away if there are no workers
+void threadEnqueue( std::function<void()> );
+
+// Information about the workers
+unsigned int threadGetWorkerCount();
+unsigned int threadGetWorkerIndex();
+
+// Queues a job to run on a worker thread, the returned future holds its result (or the exception it threw)
+template <typename Function>
+auto threadSubmit( Function &&function ) -> std::future<decltype( function() )> {
+
+	// Packaged tasks cannot be copied, but std::function requires copying, so share it instead
+	using Result = decltype( function() );
+	auto task = std::make_shared<std::packaged_task<Result()>>( std::forward<Function>( function ) );
+	std::future<Result> result = task->get_future();
+
+	threadEnqueue( [ task ]() {
+		( *task )();
+	} );
+
+	return result;
+
+}
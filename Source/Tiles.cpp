@@ -0,0 +1,49 @@
+#include "Tiles.h"
+
+// Job system
+#include "Thread.h"
+
+// Min
+#include <algorithm>
+
+// Splits the framebuffer into a number of bands & draws them all, returning once every band is done
+// This thread draws the first band itself rather than waiting idle, so a single band never touches the job system
+void TiledRenderer::render( Framebuffer &framebuffer, unsigned int bandCount, const std::function<void( Canvas & )> &draw ) {
+
+	// Every band must be at least one row tall
+	if ( bandCount == 0 ) bandCount = 1;
+	if ( bandCount > framebuffer.height ) bandCount = framebuffer.height > 0 ? framebuffer.height : 1;
+
+	// The canvases are pointed at their bands below, as growing the list of bands moves them
+	while ( this->canvases.size() < bandCount ) {
+		this->bands.emplace_back();
+		this->canvases.push_back( std::make_unique<Canvas>( this->bands.back() ) );
+	}
+
+	// Wrap each band of rows, and point its canvas at it
+	unsigned int bandHeight = ( framebuffer.height + bandCount - 1 ) / bandCount;
+	for ( unsigned int index = 0; index < bandCount; index++ ) {
+		unsigned int top = std::min( index * bandHeight, framebuffer.height );
+		unsigned int bottom = std::min( top + bandHeight, framebuffer.height );
+
+		framebufferWrap( this->bands[ index ], framebuffer.pixels + ( size_t ) top * framebuffer.stride, framebuffer.width, bottom - top, framebuffer.stride );
+		this->canvases[ index ]->setTarget( this->bands[ index ] );
+		this->canvases[ index ]->setTile( 0, top, framebuffer.width, framebuffer.height );
+	}
+
+	// Draw the other bands on the workers...
+	std::vector<std::future<void>> results;
+	for ( unsigned int index = 1; index < bandCount; index++ ) {
+		if ( this->bands[ index ].height == 0 ) continue;
+
+		Canvas *canvas = this->canvases[ index ].get();
+		results.push_back( threadSubmit( [ canvas, &draw ]() {
+			draw( *canvas );
+		} ) );
+	}
+
+	// ...while this thread draws the first, then waits for the rest
+	draw( *this->canvases[ 0 ] );
+	for ( std::future<void> &result : results ) result.get();
+
+}
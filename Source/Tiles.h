@@ -0,0 +1,30 @@
+#pragma once
+
+// Dynamic arrays
+#include <vector>
+
+// Canvases for each tile, and the drawing function
+#include <memory>
+#include <functional>
+
+// Software drawing
+#include "Canvas.h"
+
+// Draws a picture as horizontal bands in parallel on the job system, with a canvas for each band
+// Every band runs the whole drawing function, and the rasterizer clips away everything outside of it
+class TiledRenderer {
+
+	// Only usable by this class
+	private:
+
+		// Reused between frames, so the canvases keep their buffers
+		std::vector<Framebuffer> bands;
+		std::vector<std::unique_ptr<Canvas>> canvases;
+
+	// Usable by anyone
+	public:
+
+		// Drawing
+		void render( Framebuffer &, unsigned int, const std::function<void( Canvas & )> & );
+
+};
@@ -0,0 +1,123 @@
+#include "Timeline.h"
+
+// Which worker recorded each event
+#include "Thread.h"
+
+// Timing
+#include <chrono>
+
+// Events are recorded from several threads at once
+#include <mutex>
+#include <atomic>
+
+// Fixed-width integer types
+#include <cstdint>
+
+// Sorting
+#include <algorithm>
+
+// Formatting
+#include <cstdio>
+
+// When the timeline started (in steady clock ticks, so workers can read it while it is restarted), and everything recorded since
+std::atomic<int64_t> timelineStartTicks( ( int64_t ) std::chrono::steady_clock::now().time_since_epoch().count() );
+std::vector<TimelineEvent> timelineEvents;
+std::mutex timelineMutex;
+
+// Starts (or restarts) the timeline, should be the first thing the application does
+void timelineStart() {
+
+	std::lock_guard<std::mutex> lock( timelineMutex );
+	timelineStartTicks.store( ( int64_t ) std::chrono::steady_clock::now().time_since_epoch().count() );
+	timelineEvents.clear();
+
+}
+
+// The number of milliseconds since the timeline started
+double timelineNow() {
+
+	std::chrono::steady_clock::time_point startTime( std::chrono::steady_clock::duration( timelineStartTicks.load() ) );
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - startTime ).count();
+
+}
+
+// Records something that took place between two times, on the calling thread
+void timelineRecord( const std::string &name, double startTime, double endTime ) {
+
+	std::lock_guard<std::mutex> lock( timelineMutex );
+	timelineEvents.push_back( { name, threadGetWorkerIndex(), startTime, endTime } );
+
+}
+
+// Records something that happened right now
+void timelineMark( const std::string &name ) {
+
+	double now = timelineNow();
+	timelineRecord( name, now, now );
+
+}
+
+// A copy of every event, ordered by when they started
+std::vector<TimelineEvent> timelineGetEvents() {
+
+	std::vector<TimelineEvent> events;
+
+	{
+		std::lock_guard<std::mutex> lock( timelineMutex );
+		events = timelineEvents;
+	}
+
+	std::stable_sort( events.begin(), events.end(), []( const TimelineEvent &a, const TimelineEvent &b ) {
+		return a.startTime < b.startTime;
+	} );
+
+	return events;
+
+}
+
+// When the first event with a name ended, or a negative number if it has not happened
+double timelineFind( const std::string &name ) {
+
+	std::lock_guard<std::mutex> lock( timelineMutex );
+
+	for ( const TimelineEvent &event : timelineEvents ) {
+		if ( event.name == name ) return event.endTime;
+	}
+
+	return -1.0;
+
+}
+
+// A line of text for each event, suitable for the console
+std::vector<std::string> timelineReport() {
+
+	std::vector<std::string> lines;
+	char line[ 256 ] = { 0 };
+
+	for ( const TimelineEvent &event : timelineGetEvents() ) {
+		std::string thread = event.workerIndex == 0 ? "main" : "worker " + std::to_string( event.workerIndex );
+
+		if ( event.endTime > event.startTime ) {
+			std::snprintf( line, sizeof( line ), "%9.2f ms - %9.2f ms (%8.2f ms) [%s] %s", event.startTime, event.endTime, event.endTime - event.startTime, thread.c_str(), event.name.c_str() );
+		} else {
+			std::snprintf( line, sizeof( line ), "%9.2f ms                            [%s] %s", event.startTime, thread.c_str(), event.name.c_str() );
+		}
+
+		lines.push_back( line );
+	}
+
+	return lines;
+
+}
+
+// Starts timing
+TimelineSpan::TimelineSpan( const std::string &spanName ) :
+	name( spanName ),
+	startTime( timelineNow() ) {
+
+}
+
+// Stops timing & records the event
+TimelineSpan::~TimelineSpan() {
+	timelineRecord( this->name, this->startTime, timelineNow() );
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// Strings
+#include <string>
+
+// Dynamic arrays
+#include <vector>
+
+// Something that happened during startup, times are in milliseconds since the timeline started
+struct TimelineEvent {
+	std::string name;
+	unsigned int workerIndex; // Zero for the main thread
+	double startTime;
+	double endTime; // Same as the start time for instant marks
+};
+
+// Recording
+void timelineStart();
+double timelineNow();
+void timelineRecord( const std::string &, double, double );
+void timelineMark( const std::string & );
+
+// Reading back
+std::vector<TimelineEvent> timelineGetEvents();
+double timelineFind( const std::string & );
+std::vector<std::string> timelineReport();
+
+// Records the time between its creation & destruction as an event
+class TimelineSpan {
+
+	// Only usable by this class
+	private:
+		std::string name;
+		double startTime;
+
+	// Usable by anyone
+	public:
+		TimelineSpan( const std::string & );
+		~TimelineSpan();
+
+};
@@ -4,17 +4,30 @@
 // Visual Styles
 #include <CommCtrl.h>
 
+// Splitting the command line into arguments
+#include <shellapi.h>
+
 // My custom window class
 #include "MyWindow.h"
 
 // Console functions
 #include "Console.h"
 
-// Thread experiments
+// Job system
 #include "Thread.h"
 
+// Startup timeline
+#include "Timeline.h"
+
+// Picking the software renderer's kernels for the CPU
+#include "Kernels.h"
+
+// String to number conversion
+#include <cstdlib>
+
 // Prototypes for functions later on in this file
 void initializeCommonControls();
+std::string getCommandLineOption( const wchar_t * );
 
 /*
  1st parameter is a handle to the instance of the application/executable when loaded in memory.
@@ -28,11 +41,39 @@ void initializeCommonControls();
 */
 int WINAPI wWinMain( _In_ HINSTANCE applicationHandle, _In_opt_ HINSTANCE _, _In_ PWSTR commandLineParameters, _In_ int showWindowFlags ) {
 
+	// Start timing, so we know how long it takes to get the first frame on screen
+	timelineStart();
+
 	// Create a console window
 	consoleCreate( "Created console window." );
 
-	// Initialize the common control classes before creating UI
-	initializeCommonControls();
+	// Draw in software with the fastest kernels for the CPU, or the instruction set given with --kernels <name> (or the GRAPHICS_KERNELS environment variable)
+	std::string kernelsError;
+	if ( !kernelsSetup( getCommandLineOption( L"--kernels" ), kernelsError ) ) {
+		consoleError( "%s!", kernelsError.c_str() );
+		ExitProcess( 1 );
+	}
+
+	consoleOutput( "Using the %s kernels (the best this CPU can run are %s).", kernelsGetLevelName( kernelsGetLevel() ), kernelsGetLevelName( kernelsGetBestLevel() ) );
+
+#ifdef _DEBUG
+	// Check every version of the kernels this CPU can run gives the same pixels as the plain versions
+	for ( const std::string &failure : kernelsSelfTest() ) consoleError( "%s!", failure.c_str() );
+#endif
+
+	// Start the job system's worker threads
+	threadCreate();
+	consoleOutput( "Started %u worker threads.", threadGetWorkerCount() );
+
+	// Draw in software into shared memory with this name, if given with --shared-framebuffer <name>
+	std::string sharedFramebufferName = getCommandLineOption( L"--shared-framebuffer" );
+
+	// Draw in software & record every frame to this directory of images (or video if it ends in .y4m), if given with --record <path>
+	std::string recordingPath = getCommandLineOption( L"--record" );
+
+	// Keep frames drawn in software within this many megabytes, if given with --frame-cache-megabytes <count>
+	std::string frameCacheOption = getCommandLineOption( L"--frame-cache-megabytes" );
+	size_t frameCacheBudget = frameCacheOption.empty() ? FRAME_CACHE_DEFAULT_BUDGET : ( size_t ) std::strtoull( frameCacheOption.c_str(), NULL, 10 ) * 1024 * 1024;
 
 	// Options for my class
 	LPCWSTR windowClassName = L"My Window Class";
@@ -43,17 +84,39 @@ int WINAPI wWinMain( _In_ HINSTANCE applicationHandle, _In_opt_ HINSTANCE _, _In
 	// Create an instance of my custom window class using the options above
 	MyWindow myWindow( windowClassName, windowTitle, windowWidth, windowHeight );
 
-	// Setup & register the window class
-	myWindow.setupWindowClass( applicationHandle );
+	// Setup the Direct2D factories & device-independent resources (fonts, text layout) on a worker thread...
+	std::future<void> direct2DSetup = threadSubmit( [ &myWindow ]() {
+		myWindow.setupDirect2D();
+	} );
 
-	// Create & show the top-level window
-	myWindow.createMainWindow( applicationHandle, showWindowFlags );
+	// Setup the shared memory, recording & software rendering resources on another worker, if enabled
+	std::future<void> softwareRenderingSetup;
+	if ( !sharedFramebufferName.empty() || !recordingPath.empty() ) softwareRenderingSetup = threadSubmit( [ &myWindow, &sharedFramebufferName, &recordingPath, frameCacheBudget ]() {
+		myWindow.setupSoftwareRendering( sharedFramebufferName, recordingPath, frameCacheBudget );
+	} );
 
-	// Setup the Direct2D resources
-	myWindow.setupDirect2D();
+	// ...while this thread sets up the window, which must be done on the thread that will pull its messages
+	{
+		TimelineSpan timelineSpan( "Create window" );
 
-	// Create thread
-	threadCreate();
+		// Initialize the common control classes before creating UI
+		initializeCommonControls();
+
+		// Setup & register the window class
+		myWindow.setupWindowClass( applicationHandle );
+
+		// Create & show the top-level window
+		myWindow.createMainWindow( applicationHandle, showWindowFlags );
+	}
+
+	// Wait for the worker to finish, then create the render target for the window so it is ready for the first paint call (which pre-warms the brushes on the workers)
+	{
+		TimelineSpan timelineSpan( "Wait for Direct2D setup" );
+		direct2DSetup.get();
+		if ( softwareRenderingSetup.valid() ) softwareRenderingSetup.get();
+	}
+
+	myWindow.createRenderTarget();
 
 	// Start pulling window messages, this will block until a quit message is received
 	myWindow.pullWindowMessages();
@@ -61,8 +124,8 @@ int WINAPI wWinMain( _In_ HINSTANCE applicationHandle, _In_opt_ HINSTANCE _, _In
 	// Release all the Direct2D resources (this should have already been done, but do it again just in case)
 	myWindow.releaseDirect2D();
 
-	// Stop thread
-	//threadStop();
+	// Stop the worker threads
+	threadStop();
 
 	// Close the console window
 	consoleClose( "Closing console window..." );
@@ -93,3 +156,33 @@ void initializeCommonControls() {
 	consoleOutput( "Initialized the common control classes." );
 
 }
+
+// Gets the value following an option on the command line (such as --name value), or an empty string if the option is not there
+// https://docs.microsoft.com/en-us/windows/win32/api/shellapi/nf-shellapi-commandlinetoargvw
+std::string getCommandLineOption( const wchar_t *optionName ) {
+
+	// Split the command line the same way the C runtime does for argv
+	int argumentCount = 0;
+	LPWSTR *arguments = CommandLineToArgvW( GetCommandLineW(), &argumentCount );
+	if ( arguments == NULL ) return "";
+
+	// Find the option, then convert its value to UTF-8
+	std::string value;
+	for ( int index = 1; index + 1 < argumentCount; index++ ) {
+		if ( wcscmp( arguments[ index ], optionName ) != 0 ) continue;
+
+		int valueLength = WideCharToMultiByte( CP_UTF8, 0, arguments[ index + 1 ], -1, NULL, 0, NULL, NULL );
+		if ( valueLength > 1 ) {
+			value.resize( valueLength - 1 );
+			WideCharToMultiByte( CP_UTF8, 0, arguments[ index + 1 ], -1, value.data(), valueLength, NULL, NULL );
+		}
+
+		break;
+	}
+
+	// The arguments are allocated as one block
+	LocalFree( arguments );
+
+	return value;
+
+}